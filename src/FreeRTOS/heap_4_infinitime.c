@@ -47,6 +47,7 @@ task.h is included from an application file. */
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "heap_4_infinitime.h"
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
@@ -54,6 +55,19 @@ task.h is included from an application file. */
  #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
+#if( HEAP_PROFILING > 0 )
+ /* The index of the call site of an allocated block is stored in the bits heapSITE_SHIFT to heapSITE_SHIFT + 4 of
+ its size. */
+ #define heapSITE_SHIFT 24
+ #define heapSITE_MASK ( ( size_t ) 0x1f << heapSITE_SHIFT )
+ #define heapOTHER_SITES heapNB_CALL_SITES
+ #if( configTOTAL_HEAP_SIZE >= ( 1 << heapSITE_SHIFT ) )
+  #error The heap is too large to store the call sites in the size of the blocks
+ #endif
+#else
+ #define heapSITE_MASK ( ( size_t ) 0 )
+#endif
+
 /* Block sizes must not get too small. */
 #define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( xHeapStructSize << 1 ) )
 
@@ -93,6 +107,19 @@ static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert );
 */
 static void prvHeapInit( void );
 
+static void *prvMalloc( size_t xWantedSize, void *pvCaller );
+
+#if( HEAP_PROFILING > 0 )
+ static void prvRecordAllocation( BlockLink_t *pxBlock, void *pvCaller );
+ static void prvRecordFailure( size_t xWantedSize, void *pvCaller );
+ #if( HEAP_PROFILING > 1 )
+  static void prvRecordEvent( eHeapEventType eType, uintptr_t uxAddress, size_t xSize );
+ #endif
+ static void prvRecordFree( size_t xBlockSize, size_t xSite );
+ static size_t prvLargestFreeBlock( void );
+ static void prvCopyTaskName( char *pcName, size_t xLength );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -113,12 +140,47 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+#if( HEAP_PROFILING > 0 )
+ static uint32_t ulSuccessfulAllocations = 0;
+ static uint32_t ulSuccessfulFrees = 0;
+ static uint32_t ulFailedAllocations = 0;
+ static uint8_t ucHeapContext = 0;
+ /* The last entry accounts the call sites that don't fit in the table. */
+ static HeapCallSite_t xCallSites[ heapNB_CALL_SITES + 1 ];
+ static size_t xNbCallSites = 0;
+ static HeapFailure_t xLastFailure;
+#endif
+
+#if( HEAP_PROFILING > 1 )
+ /* xEvents[ xEventsHead ] is the oldest event when the buffer is full. */
+ static HeapEvent_t xEvents[ heapNB_EVENTS ];
+ static size_t xEventsHead = 0;
+ static size_t xNbEvents = 0;
+#endif
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
+{
+ return prvMalloc( xWantedSize, __builtin_return_address( 0 ) );
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocFrom( size_t xWantedSize, void *pvCaller )
+{
+ return prvMalloc( xWantedSize, pvCaller );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvMalloc( size_t xWantedSize, void *pvCaller )
 {
  BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
  void *pvReturn = NULL;
+ #if( HEAP_PROFILING > 0 )
+  size_t xRequestedSize = xWantedSize;
+ #else
+  ( void ) pvCaller;
+ #endif
 
  vTaskSuspendAll();
  {
@@ -233,6 +295,10 @@ void *pvPortMalloc( size_t xWantedSize )
          by the application and has no "next" block. */
          pxBlock->xBlockSize |= xBlockAllocatedBit;
          pxBlock->pxNextFreeBlock = NULL;
+
+         #if( HEAP_PROFILING > 0 )
+          prvRecordAllocation( pxBlock, pvCaller );
+         #endif
        }
        else
        {
@@ -249,6 +315,13 @@ void *pvPortMalloc( size_t xWantedSize )
      mtCOVERAGE_TEST_MARKER();
    }
 
+   #if( HEAP_PROFILING > 0 )
+    if( pvReturn == NULL )
+    {
+      prvRecordFailure( xRequestedSize, pvCaller );
+    }
+   #endif
+
    traceMALLOC( pvReturn, xWantedSize );
  }
  ( void ) xTaskResumeAll();
@@ -294,14 +367,21 @@ void vPortFree( void *pv )
    {
      if( pxLink->pxNextFreeBlock == NULL )
      {
+       #if( HEAP_PROFILING > 0 )
+        size_t xSite = ( pxLink->xBlockSize & heapSITE_MASK ) >> heapSITE_SHIFT;
+       #endif
+
        /* The block is being returned to the heap - it is no longer
        allocated. */
-       pxLink->xBlockSize &= ~xBlockAllocatedBit;
+       pxLink->xBlockSize &= ~( xBlockAllocatedBit | heapSITE_MASK );
 
        vTaskSuspendAll();
        {
          /* Add this block to the list of free blocks. */
          xFreeBytesRemaining += pxLink->xBlockSize;
+         #if( HEAP_PROFILING > 0 )
+          prvRecordFree( pxLink->xBlockSize, xSite );
+         #endif
          traceFREE( pv, pxLink->xBlockSize );
          prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
        }
@@ -462,7 +542,7 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
 
  if (pv == NULL) {
    // pv points to NULL. Allocate a new buffer.
-   return pvPortMalloc(xWantedSize);
+   return pvPortMallocFrom(xWantedSize, __builtin_return_address(0));
  }
 
  // The memory being freed will have an BlockLink_t structure immediately before it.
@@ -474,10 +554,10 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
  // Check allocate block
  if ((pxLink->xBlockSize & xBlockAllocatedBit) != 0) {
    // The block is being returned to the heap - it is no longer allocated.
-   block_size = (pxLink->xBlockSize & ~xBlockAllocatedBit) - xHeapStructSize;
+   block_size = (pxLink->xBlockSize & ~(xBlockAllocatedBit | heapSITE_MASK)) - xHeapStructSize;
 
    // Allocate a new buffer
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = pvPortMallocFrom(xWantedSize, __builtin_return_address(0));
 
    // Check creation and determine the data size to be copied to the new buffer
    if (pvReturn != NULL) {
@@ -495,8 +575,290 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
    }
  } else {
    // pv does not point to a valid memory buffer. Allocate a new one
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = pvPortMallocFrom(xWantedSize, __builtin_return_address(0));
  }
 
  return pvReturn;
-}
\ No newline at end of file
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetHeapContext( uint8_t ucContext )
+{
+ #if( HEAP_PROFILING > 0 )
+  ucHeapContext = ucContext;
+ #else
+  ( void ) ucContext;
+ #endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+ BlockLink_t *pxBlock;
+ size_t xBin;
+
+ memset( pxHeapStats, 0, sizeof( HeapStats_t ) );
+
+ vTaskSuspendAll();
+ {
+   if( pxEnd != NULL )
+   {
+     for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+     {
+       pxHeapStats->xNumberOfFreeBlocks++;
+       if( pxBlock->xBlockSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+       {
+         pxHeapStats->xSizeOfLargestFreeBlockInBytes = pxBlock->xBlockSize;
+       }
+
+       for( xBin = 0; xBin < heapNB_FREE_BLOCK_BINS - 1 && pxBlock->xBlockSize >= ( ( size_t ) 32 << xBin ); xBin++ )
+       {
+       }
+       pxHeapStats->usFreeBlockHistogram[ xBin ]++;
+     }
+   }
+
+   pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+   pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+   #if( HEAP_PROFILING > 0 )
+    pxHeapStats->ulNumberOfSuccessfulAllocations = ulSuccessfulAllocations;
+    pxHeapStats->ulNumberOfSuccessfulFrees = ulSuccessfulFrees;
+    pxHeapStats->ulNumberOfFailedAllocations = ulFailedAllocations;
+   #endif
+ }
+ ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetHeapCallSites( HeapCallSite_t *pxCallSites, size_t xMaxCallSites )
+{
+ size_t xCount = 0;
+
+ #if( HEAP_PROFILING > 0 )
+ {
+   /* Selection sort on a copy, the indices of the table are stored in the allocated blocks */
+   uint32_t ulSelected = 0;
+   size_t xSite, xBest;
+
+   vTaskSuspendAll();
+   {
+     while( xCount < xMaxCallSites )
+     {
+       xBest = heapNB_CALL_SITES + 1;
+       for( xSite = 0; xSite <= heapNB_CALL_SITES; xSite++ )
+       {
+         if( ( ( ulSelected & ( 1UL << xSite ) ) == 0 ) && ( xCallSites[ xSite ].ulAllocations > 0 ) &&
+             ( ( xBest > heapNB_CALL_SITES ) || ( xCallSites[ xSite ].xPeakLiveBytes > xCallSites[ xBest ].xPeakLiveBytes ) ) )
+         {
+           xBest = xSite;
+         }
+       }
+
+       if( xBest > heapNB_CALL_SITES )
+       {
+         break;
+       }
+       ulSelected |= 1UL << xBest;
+       pxCallSites[ xCount++ ] = xCallSites[ xBest ];
+     }
+   }
+   ( void ) xTaskResumeAll();
+ }
+ #else
+ {
+   ( void ) pxCallSites;
+   ( void ) xMaxCallSites;
+ }
+ #endif
+
+ return xCount;
+}
+/*-----------------------------------------------------------*/
+
+int xPortGetLastHeapFailure( HeapFailure_t *pxFailure )
+{
+ int xFailed = 0;
+
+ #if( HEAP_PROFILING > 0 )
+ {
+   vTaskSuspendAll();
+   {
+     xFailed = ( ulFailedAllocations > 0 );
+     *pxFailure = xLastFailure;
+   }
+   ( void ) xTaskResumeAll();
+ }
+ #else
+ {
+   ( void ) pxFailure;
+ }
+ #endif
+
+ return xFailed;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetHeapEvents( HeapEvent_t *pxEvents, size_t xFirst, size_t xMaxEvents )
+{
+ size_t xCount = 0;
+
+ #if( HEAP_PROFILING > 1 )
+ {
+   vTaskSuspendAll();
+   {
+     for( ; xCount < xMaxEvents && xFirst + xCount < xNbEvents; xCount++ )
+     {
+       pxEvents[ xCount ] = xEvents[ ( xEventsHead + 2 * heapNB_EVENTS - 1 - xFirst - xCount ) % heapNB_EVENTS ];
+     }
+   }
+   ( void ) xTaskResumeAll();
+ }
+ #else
+ {
+   ( void ) pxEvents;
+   ( void ) xFirst;
+   ( void ) xMaxEvents;
+ }
+ #endif
+
+ return xCount;
+}
+/*-----------------------------------------------------------*/
+
+#if( HEAP_PROFILING > 0 )
+
+/* The functions below are called with the scheduler suspended. */
+
+static void prvRecordAllocation( BlockLink_t *pxBlock, void *pvCaller )
+{
+ size_t xSize = pxBlock->xBlockSize & ~xBlockAllocatedBit;
+ size_t xSite;
+ HeapCallSite_t *pxSite;
+
+ for( xSite = 0; xSite < xNbCallSites && xCallSites[ xSite ].uxAddress != ( uintptr_t ) pvCaller; xSite++ )
+ {
+ }
+
+ if( xSite == xNbCallSites )
+ {
+   if( xNbCallSites < heapNB_CALL_SITES )
+   {
+     xCallSites[ xSite ].uxAddress = ( uintptr_t ) pvCaller;
+     xNbCallSites++;
+   }
+   else
+   {
+     xSite = heapOTHER_SITES;
+   }
+ }
+
+ pxSite = &xCallSites[ xSite ];
+ pxSite->ulAllocations++;
+ pxSite->xLiveBytes += xSize;
+ if( pxSite->xLiveBytes > pxSite->xPeakLiveBytes )
+ {
+   pxSite->xPeakLiveBytes = pxSite->xLiveBytes;
+ }
+
+ pxBlock->xBlockSize |= xSite << heapSITE_SHIFT;
+ ulSuccessfulAllocations++;
+
+ #if( HEAP_PROFILING > 1 )
+  prvRecordEvent( eHeapAllocation, ( uintptr_t ) pvCaller, xSize );
+ #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordFailure( size_t xWantedSize, void *pvCaller )
+{
+ ulFailedAllocations++;
+ xLastFailure.uxAddress = ( uintptr_t ) pvCaller;
+ xLastFailure.xWantedSize = xWantedSize;
+ xLastFailure.xFreeBytes = xFreeBytesRemaining;
+ xLastFailure.xLargestFreeBlock = prvLargestFreeBlock();
+ xLastFailure.ulTime = xTaskGetTickCount();
+ xLastFailure.ucContext = ucHeapContext;
+ prvCopyTaskName( xLastFailure.pcTaskName, sizeof( xLastFailure.pcTaskName ) - 1 );
+
+ #if( HEAP_PROFILING > 1 )
+  prvRecordEvent( eHeapFailedAllocation, ( uintptr_t ) pvCaller, xWantedSize );
+ #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordFree( size_t xBlockSize, size_t xSite )
+{
+ xCallSites[ xSite ].xLiveBytes -= xBlockSize;
+ ulSuccessfulFrees++;
+
+ #if( HEAP_PROFILING > 1 )
+  prvRecordEvent( eHeapFree, xCallSites[ xSite ].uxAddress, xBlockSize );
+ #endif
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvLargestFreeBlock( void )
+{
+ BlockLink_t *pxBlock;
+ size_t xLargest = 0;
+
+ for( pxBlock = xStart.pxNextFreeBlock; pxBlock != NULL && pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+ {
+   if( pxBlock->xBlockSize > xLargest )
+   {
+     xLargest = pxBlock->xBlockSize;
+   }
+ }
+ return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+/* Copies up to xLength characters of the name of the current task, and terminates pcName with a zero if there's
+room left. */
+static void prvCopyTaskName( char *pcName, size_t xLength )
+{
+ const char *pcTaskName = "";
+ size_t x;
+
+ if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+ {
+   pcTaskName = pcTaskGetName( NULL );
+ }
+
+ for( x = 0; x < xLength && pcTaskName[ x ] != '\0'; x++ )
+ {
+   pcName[ x ] = pcTaskName[ x ];
+ }
+ for( ; x <= xLength; x++ )
+ {
+   pcName[ x ] = '\0';
+ }
+}
+/*-----------------------------------------------------------*/
+
+#if( HEAP_PROFILING > 1 )
+
+static void prvRecordEvent( eHeapEventType eType, uintptr_t uxAddress, size_t xSize )
+{
+ HeapEvent_t *pxEvent = &xEvents[ xEventsHead ];
+ char pcName[ sizeof( pxEvent->pcTask ) + 1 ];
+
+ pxEvent->ulTime = xTaskGetTickCount();
+ pxEvent->uxAddress = uxAddress;
+ pxEvent->usSize = ( uint16_t ) xSize;
+ pxEvent->usFreeBytes = ( uint16_t ) xFreeBytesRemaining;
+ pxEvent->ucType = ( uint8_t ) eType;
+ pxEvent->ucContext = ucHeapContext;
+ prvCopyTaskName( pcName, sizeof( pxEvent->pcTask ) );
+ memcpy( pxEvent->pcTask, pcName, sizeof( pxEvent->pcTask ) );
+
+ xEventsHead = ( xEventsHead + 1 ) % heapNB_EVENTS;
+ if( xNbEvents < heapNB_EVENTS )
+ {
+   xNbEvents++;
+ }
+}
+
+#endif /* HEAP_PROFILING > 1 */
+
+#endif /* HEAP_PROFILING > 0 */
@@ -0,0 +1,91 @@
+#pragma once
+
+/*
+* Profiling of the allocations of heap_4_infinitime.c, enabled by HEAP_PROFILING:
+* 0: disabled
+* 1: statistics of the free blocks, allocations by call site, last failed allocation
+* 2: statistics, and the last allocations and frees in a ring buffer
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HEAP_PROFILING
+ #define HEAP_PROFILING 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The free blocks are counted by size: the bin i counts the blocks smaller than 32 << i bytes, the last bin counts
+the larger blocks. */
+#define heapNB_FREE_BLOCK_BINS 9
+#define heapNB_CALL_SITES 16
+#define heapNB_EVENTS 24
+
+typedef struct {
+ size_t xAvailableHeapSpaceInBytes;
+ size_t xSizeOfLargestFreeBlockInBytes;
+ size_t xNumberOfFreeBlocks;
+ size_t xMinimumEverFreeBytesRemaining;
+ uint32_t ulNumberOfSuccessfulAllocations;
+ uint32_t ulNumberOfSuccessfulFrees;
+ uint32_t ulNumberOfFailedAllocations;
+ uint16_t usFreeBlockHistogram[heapNB_FREE_BLOCK_BINS];
+} HeapStats_t;
+
+/* The call site of an allocation is the return address of malloc(), operator new or pvPortMalloc(): use addr2line
+to find the function. The allocations of the call sites that don't fit in the table are accounted to the address 0.
+The sizes include the header of the blocks. */
+typedef struct {
+ uintptr_t uxAddress;
+ uint32_t ulAllocations;
+ size_t xLiveBytes;
+ size_t xPeakLiveBytes;
+} HeapCallSite_t;
+
+/* ucContext is the value of vPortSetHeapContext() when the allocation failed (the displayed app). pcTaskName is zero
+terminated, empty before the scheduler starts. */
+typedef struct {
+ uintptr_t uxAddress;
+ size_t xWantedSize;
+ size_t xFreeBytes;
+ size_t xLargestFreeBlock;
+ uint32_t ulTime;
+ char pcTaskName[ 8 ];
+ uint8_t ucContext;
+} HeapFailure_t;
+
+typedef enum { eHeapAllocation, eHeapFree, eHeapFailedAllocation } eHeapEventType;
+
+/* For a free, uxAddress is the call site of the allocation of the block. pcTask is the beginning of the name of the
+task (empty before the scheduler starts), not terminated by a zero. */
+typedef struct {
+ uint32_t ulTime;
+ uintptr_t uxAddress;
+ uint16_t usSize;
+ uint16_t usFreeBytes;
+ uint8_t ucType;
+ uint8_t ucContext;
+ char pcTask[ 4 ];
+} HeapEvent_t;
+
+/* pvPortMalloc() for the wrappers of the allocation (malloc(), operator new): pvCaller is their call site. */
+void* pvPortMallocFrom(size_t xWantedSize, void* pvCaller);
+
+void vPortSetHeapContext(uint8_t ucContext);
+
+/* Walks the list of the free blocks, with the scheduler suspended. */
+void vPortGetHeapStats(HeapStats_t* pxHeapStats);
+/* Returns the number of call sites copied, by decreasing peak usage. */
+size_t xPortGetHeapCallSites(HeapCallSite_t* pxCallSites, size_t xMaxCallSites);
+/* Returns 0 if no allocation failed since the startup. */
+int xPortGetLastHeapFailure(HeapFailure_t* pxFailure);
+/* Most recent first, skipping the xFirst most recent events. Returns the number of events copied (always 0 if
+HEAP_PROFILING < 2). */
+size_t xPortGetHeapEvents(HeapEvent_t* pxEvents, size_t xFirst, size_t xMaxEvents);
+
+#ifdef __cplusplus
+}
+#endif
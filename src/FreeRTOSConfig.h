@@ -63,7 +63,7 @@
 #define configMAX_PRIORITIES                    (3)
 #define configMINIMAL_STACK_SIZE                (120)
 #define configTOTAL_HEAP_SIZE                   (1024 * 40)
-#define configMAX_TASK_NAME_LEN                 (4)
+#define configMAX_TASK_NAME_LEN                 (8)
 #define configUSE_16_BIT_TICKS                  0
 #define configIDLE_SHOULD_YIELD                 1
 #define configUSE_MUTEXES                       1
@@ -75,7 +75,7 @@
 #define configUSE_TIME_SLICING                  0
 #define configUSE_NEWLIB_REENTRANT              0
 #define configENABLE_BACKWARD_COMPATIBILITY     1
-#define configUSE_TASK_NOTIFICATIONS            0
+#define configUSE_TASK_NOTIFICATIONS            1
 
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK            0
@@ -84,10 +84,17 @@
 #define configUSE_MALLOC_FAILED_HOOK   1
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS        0
+#define configGENERATE_RUN_TIME_STATS        1
 #define configUSE_TRACE_FACILITY             1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
+/* The run time counter is RTC2 (32768 Hz) extended to 32 bits, and the time spent in the tickless
+sleep is accounted separately from the idle task, see components/profiling/ProfilingClock.h */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() ProfilingClockInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()         ProfilingClockRunTime()
+#define configPRE_SLEEP_PROCESSING(x)            ProfilingClockEnterSleep()
+#define configPOST_SLEEP_PROCESSING(x)           ProfilingClockExitSleep()
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES           0
 #define configMAX_CO_ROUTINE_PRIORITIES (2)
@@ -181,6 +188,19 @@ standard names - or at least those used in the unmodified vector table. */
     #error "This port requires __NVIC_PRIO_BITS to be defined"
   #endif
 
+  /* Run time statistics hooks, implemented in components/profiling/ProfilingClock.cpp */
+  #include <stdint.h>
+  #ifdef __cplusplus
+extern "C" {
+  #endif
+void ProfilingClockInit(void);
+uint32_t ProfilingClockRunTime(void);
+void ProfilingClockEnterSleep(void);
+void ProfilingClockExitSleep(void);
+  #ifdef __cplusplus
+}
+  #endif
+
   /* Access to current system core clock is required only if we are ticking the system by systimer */
   #if (configTICK_SOURCE == FREERTOS_USE_SYSTICK)
     #include <stdint.h>
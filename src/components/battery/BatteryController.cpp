@@ -10,12 +10,14 @@ using namespace Pinetime::Controllers;
 
 Battery* Battery::instance = nullptr;
 
-Battery::Battery() {
+Battery::Battery(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
   instance = this;
   nrf_gpio_cfg_input(PinMap::Charging, static_cast<nrf_gpio_pin_pull_t> GPIO_PIN_CNF_PULL_Disabled);
 }
 
 void Battery::ReadPowerState() {
+  bool wasCharging = IsCharging();
+  bool wasPowerPresent = isPowerPresent;
   isCharging = (nrf_gpio_pin_read(PinMap::Charging) == 0);
   isPowerPresent = (nrf_gpio_pin_read(PinMap::PowerPresent) == 0);
 
@@ -24,6 +26,10 @@ void Battery::ReadPowerState() {
   } else if (!isPowerPresent) {
     isFull = false;
   }
+
+  if (IsCharging() != wasCharging || isPowerPresent != wasPowerPresent) {
+    changeNotifier.Publish(Changes::Battery);
+  }
 }
 
 void Battery::MeasureVoltage() {
@@ -84,6 +90,7 @@ void Battery::SaadcEventHandler(nrfx_saadc_evt_t const* p_event) {
     if ((isPowerPresent && newPercent > percentRemaining) || (!isPowerPresent && newPercent < percentRemaining) || firstMeasurement) {
       firstMeasurement = false;
       percentRemaining = newPercent;
+      changeNotifier.Publish(Changes::Battery);
       systemTask->PushMessage(System::Messages::BatteryPercentageUpdated);
     }
 
@@ -2,13 +2,14 @@
 #include <cstdint>
 #include <drivers/include/nrfx_saadc.h>
 #include <systemtask/SystemTask.h>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Controllers {
 
     class Battery {
     public:
-      Battery();
+      explicit Battery(ChangeNotifier& changeNotifier);
 
       void ReadPowerState();
       void MeasureVoltage();
@@ -53,6 +54,7 @@ namespace Pinetime {
       bool isReading = false;
 
       Pinetime::System::SystemTask* systemTask = nullptr;
+      ChangeNotifier& changeNotifier;
     };
   }
 }
@@ -2,16 +2,21 @@
 
 using namespace Pinetime::Controllers;
 
+Ble::Ble(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
+}
+
 bool Ble::IsConnected() const {
   return isConnected;
 }
 
 void Ble::Connect() {
   isConnected = true;
+  changeNotifier.Publish(Changes::Ble);
 }
 
 void Ble::Disconnect() {
   isConnected = false;
+  changeNotifier.Publish(Changes::Ble);
 }
 
 bool Ble::IsRadioEnabled() const {
@@ -20,10 +25,12 @@ bool Ble::IsRadioEnabled() const {
 
 void Ble::EnableRadio() {
   isRadioEnabled = true;
+  changeNotifier.Publish(Changes::Ble);
 }
 
 void Ble::DisableRadio() {
   isRadioEnabled = false;
+  changeNotifier.Publish(Changes::Ble);
 }
 
 void Ble::StartFirmwareUpdate() {
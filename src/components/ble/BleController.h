@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -11,7 +12,7 @@ namespace Pinetime {
       enum class FirmwareUpdateStates { Idle, Running, Validated, Error };
       enum class AddressTypes { Public, Random, RPA_Public, RPA_Random };
 
-      Ble() = default;
+      explicit Ble(ChangeNotifier& changeNotifier);
       bool IsConnected() const;
       void Connect();
       void Disconnect();
@@ -75,6 +76,7 @@ namespace Pinetime {
       BleAddress address;
       AddressTypes addressType;
       uint32_t pairingKey = 0;
+      ChangeNotifier& changeNotifier;
     };
   }
 }
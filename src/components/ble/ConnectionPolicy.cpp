@@ -0,0 +1,157 @@
+#include "components/ble/ConnectionPolicy.h"
+#include <nrf_log.h>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_att.h>
+#include <host/ble_gatt.h>
+#include <host/ble_hs.h>
+#include <nimble/nimble_port.h>
+#undef max
+#undef min
+
+using namespace Pinetime::Controllers;
+
+constexpr ble_gap_upd_params ConnectionPolicy::transferParameters;
+constexpr ble_gap_upd_params ConnectionPolicy::idleParameters;
+
+namespace {
+  void ConnectionPolicyCallback(ble_npl_event* event) {
+    auto* connectionPolicy = static_cast<ConnectionPolicy*>(ble_npl_event_get_arg(event));
+    connectionPolicy->OnTimer();
+  }
+}
+
+void ConnectionPolicy::Init() {
+  ble_npl_callout_init(&callout, nimble_port_get_dflt_eventq(), ConnectionPolicyCallback, this);
+}
+
+void ConnectionPolicy::OnConnect(uint16_t connectionHandle) {
+  this->connectionHandle = connectionHandle;
+  status = {};
+  status.txPhy = BLE_GAP_LE_PHY_1M;
+  status.rxPhy = BLE_GAP_LE_PHY_1M;
+  status.mtu = ble_att_mtu(connectionHandle);
+  requestPending = false;
+  ReadParameters();
+
+  // The controller only starts the procedures if the central supports them
+  int rc = ble_gap_set_prefered_le_phy(connectionHandle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+  if (rc != 0) {
+    NRF_LOG_INFO("[ConnectionPolicy] Cannot request the 2M PHY : %d", rc);
+  }
+  rc = ble_gattc_exchange_mtu(connectionHandle, nullptr, nullptr);
+  if (rc != 0) {
+    NRF_LOG_INFO("[ConnectionPolicy] Cannot exchange the MTU : %d", rc);
+  }
+
+  ble_npl_callout_reset(&callout, ble_npl_time_ms_to_ticks32(idleDelayAfterConnectionMs));
+}
+
+void ConnectionPolicy::OnDisconnect() {
+  ble_npl_callout_stop(&callout);
+  connectionHandle = BLE_HS_CONN_HANDLE_NONE;
+  // The statistics of the last transfer stay available
+  status.mode = Modes::Default;
+  requestPending = false;
+}
+
+void ConnectionPolicy::OnConnectionUpdated(uint16_t connectionHandle, int result) {
+  if (connectionHandle != this->connectionHandle) {
+    return;
+  }
+  if (result != 0) {
+    status.failedUpdates++;
+  }
+  ReadParameters();
+  NRF_LOG_INFO("[ConnectionPolicy] Parameters (%d) : interval=%d latency=%d timeout=%d",
+               result,
+               status.interval,
+               status.latency,
+               status.supervisionTimeout);
+  if (requestPending) {
+    Request(status.mode);
+  }
+}
+
+void ConnectionPolicy::OnMtuChanged(uint16_t connectionHandle, uint16_t mtu) {
+  if (connectionHandle == this->connectionHandle) {
+    status.mtu = mtu;
+  }
+}
+
+void ConnectionPolicy::OnPhyUpdated(uint16_t connectionHandle, int result, uint8_t txPhy, uint8_t rxPhy) {
+  if (connectionHandle == this->connectionHandle && result == 0) {
+    status.txPhy = txPhy;
+    status.rxPhy = rxPhy;
+  }
+}
+
+void ConnectionPolicy::OnTransfer(uint16_t connectionHandle, size_t bytes) {
+  if (connectionHandle != this->connectionHandle) {
+    return;
+  }
+  ble_npl_time_t now = ble_npl_time_get();
+  if (status.mode != Modes::Transfer) {
+    transferStart = now;
+    status.transferBytes = 0;
+    Request(Modes::Transfer);
+    // The callout isn't reset for each packet: OnTimer() checks the time of the last one
+    ble_npl_callout_reset(&callout, ble_npl_time_ms_to_ticks32(transferHoldMs));
+  }
+  lastTransfer = now;
+  status.transferBytes += bytes;
+  status.transferDurationMs = ble_npl_time_ticks_to_ms32(lastTransfer - transferStart);
+  status.goodput = (status.transferDurationMs > 0) ? static_cast<uint32_t>((static_cast<uint64_t>(status.transferBytes) * 1000) /
+                                                                           status.transferDurationMs)
+                                                   : 0;
+}
+
+void ConnectionPolicy::OnTimer() {
+  if (connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+    return;
+  }
+  if (status.mode == Modes::Transfer) {
+    ble_npl_time_t hold = ble_npl_time_ms_to_ticks32(transferHoldMs);
+    ble_npl_time_t elapsed = ble_npl_time_get() - lastTransfer;
+    if (elapsed < hold) {
+      ble_npl_callout_reset(&callout, hold - elapsed);
+      return;
+    }
+    NRF_LOG_INFO("[ConnectionPolicy] Transfer : %d bytes in %d ms, %d B/s",
+                 status.transferBytes,
+                 status.transferDurationMs,
+                 status.goodput);
+  }
+  Request(Modes::Idle);
+}
+
+ConnectionPolicy::Status ConnectionPolicy::GetStatus() const {
+  return status;
+}
+
+void ConnectionPolicy::Request(Modes newMode) {
+  status.mode = newMode;
+  const ble_gap_upd_params& parameters = (newMode == Modes::Transfer) ? transferParameters : idleParameters;
+  ReadParameters();
+  if (status.interval >= parameters.itvl_min && status.interval <= parameters.itvl_max && status.latency == parameters.latency) {
+    requestPending = false;
+    return;
+  }
+
+  int rc = ble_gap_update_params(connectionHandle, &parameters);
+  // Only one update can be in progress, the request is sent again when it's completed
+  requestPending = (rc == BLE_HS_EALREADY);
+  if (rc != 0 && !requestPending) {
+    status.failedUpdates++;
+    NRF_LOG_INFO("[ConnectionPolicy] Cannot update the parameters : %d", rc);
+  }
+}
+
+void ConnectionPolicy::ReadParameters() {
+  ble_gap_conn_desc desc;
+  if (ble_gap_conn_find(connectionHandle, &desc) == 0) {
+    status.interval = desc.conn_itvl;
+    status.latency = desc.conn_latency;
+    status.supervisionTimeout = desc.supervision_timeout;
+  }
+}
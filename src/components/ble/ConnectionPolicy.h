@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace Controllers {
+
+    // Chooses the parameters of the connection: a short interval while data is transferred (FS, DFU), a long interval
+    // with slave latency when the link is idle, and the 2M PHY when the central supports it. The data length extension
+    // is negotiated by the controller (BLE_LL_CFG_FEAT_DATA_LEN_EXT).
+    // All the methods are called from the host task (GAP events, GATT accesses and callouts of the host), so the
+    // state isn't protected.
+    class ConnectionPolicy {
+    public:
+      enum class Modes : uint8_t { Default, Idle, Transfer };
+
+      struct Status {
+        Modes mode;
+        uint16_t interval; // 1.25 ms units
+        uint16_t latency;
+        uint16_t supervisionTimeout; // 10 ms units
+        uint16_t mtu;
+        uint8_t txPhy;
+        uint8_t rxPhy;
+        uint16_t failedUpdates;
+        // Payload of the current transfer, or of the last one
+        uint32_t transferBytes;
+        uint32_t transferDurationMs;
+        uint32_t goodput; // Bytes per second
+      };
+
+      void Init();
+
+      void OnConnect(uint16_t connectionHandle);
+      void OnDisconnect();
+      void OnConnectionUpdated(uint16_t connectionHandle, int result);
+      void OnMtuChanged(uint16_t connectionHandle, uint16_t mtu);
+      void OnPhyUpdated(uint16_t connectionHandle, int result, uint8_t txPhy, uint8_t rxPhy);
+
+      // Called by the services for each packet of a transfer, with the size of its payload
+      void OnTransfer(uint16_t connectionHandle, size_t bytes);
+
+      Status GetStatus() const;
+
+      void OnTimer();
+
+    private:
+      // The intervals follow the guidelines of Apple for accessories: min + 15 ms <= max, max * (latency + 1) <= 2 s
+      static constexpr ble_gap_upd_params transferParameters {.itvl_min = 12,
+                                                              .itvl_max = 24,
+                                                              .latency = 0,
+                                                              .supervision_timeout = 400,
+                                                              .min_ce_len = 0,
+                                                              .max_ce_len = 0};
+      static constexpr ble_gap_upd_params idleParameters {.itvl_min = 240,
+                                                          .itvl_max = 288,
+                                                          .latency = 4,
+                                                          .supervision_timeout = 600,
+                                                          .min_ce_len = 0,
+                                                          .max_ce_len = 0};
+      // Leaves the time to the companion app to discover the services and synchronize after the connection
+      static constexpr uint32_t idleDelayAfterConnectionMs = 10000;
+      // The FS clients send a command per chunk: the transfer ends after this delay without packet
+      static constexpr uint32_t transferHoldMs = 2000;
+
+      void Request(Modes newMode);
+      void ReadParameters();
+
+      uint16_t connectionHandle = BLE_HS_CONN_HANDLE_NONE;
+      ble_npl_callout callout {};
+      Status status {};
+      // Mode to request again once the update in progress is completed
+      bool requestPending = false;
+      ble_npl_time_t transferStart = 0;
+      ble_npl_time_t lastTransfer = 0;
+    };
+  }
+}
@@ -1,6 +1,9 @@
 #include "components/ble/DfuService.h"
 #include <cstring>
+#include <new>
+#include <type_traits>
 #include "components/ble/BleController.h"
+#include "components/ble/ConnectionPolicy.h"
 #include "drivers/SpiNorFlash.h"
 #include "systemtask/SystemTask.h"
 #include <nrf_log.h>
@@ -29,9 +32,11 @@ void TimeoutTimerCallback(TimerHandle_t xTimer) {
 
 DfuService::DfuService(Pinetime::System::SystemTask& systemTask,
                        Pinetime::Controllers::Ble& bleController,
-                       Pinetime::Drivers::SpiNorFlash& spiNorFlash)
+                       Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                       ConnectionPolicy& connectionPolicy)
   : systemTask {systemTask},
     bleController {bleController},
+    connectionPolicy {connectionPolicy},
     dfuImage {spiNorFlash},
     characteristicDefinition {{
                                 .uuid = &packetCharacteristicUuid.u,
@@ -129,7 +134,17 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
         vTaskDelay(50); // 50ms
       }
 
-      dfuImage.Erase();
+      // The writer erases the slot while the image is received
+      auto result = dfuImage.Init(applicationSize);
+      if (result != DfuImage::InitResults::Success) {
+        NRF_LOG_INFO("[DFU] -> Cannot receive an application of %d bytes", applicationSize);
+        auto error = (result == DfuImage::InitResults::InvalidSize) ? ErrorCodes::DataSizeExceedsLimits : ErrorCodes::OperationFailed;
+        uint8_t data[] {16, 1, static_cast<uint8_t>(error)};
+        notificationManager.Send(connectionHandle, controlPointCharacteristicHandle, data, 3);
+        bleController.State(Pinetime::Controllers::Ble::FirmwareUpdateStates::Error);
+        Reset();
+        return 0;
+      }
 
       uint8_t data[] {16, 1, 1};
       notificationManager.Send(connectionHandle, controlPointCharacteristicHandle, data, 3);
@@ -161,9 +176,21 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
 
     case States::Data: {
       nbPacketReceived++;
-      dfuImage.Append(om->om_data, om->om_len);
-      bytesReceived += om->om_len;
+      // The packets are up to the MTU, and may be split in a chain of mbufs
+      for (os_mbuf* m = om; m != nullptr; m = SLIST_NEXT(m, om_next)) {
+        if (!dfuImage.Append(m->om_data, m->om_len)) {
+          uint8_t data[3] {static_cast<uint8_t>(Opcodes::Response),
+                           static_cast<uint8_t>(Opcodes::ReceiveFirmwareImage),
+                           static_cast<uint8_t>(ErrorCodes::OperationFailed)};
+          notificationManager.Send(connectionHandle, controlPointCharacteristicHandle, data, 3);
+          bleController.State(Pinetime::Controllers::Ble::FirmwareUpdateStates::Error);
+          Reset();
+          return 0;
+        }
+      }
+      bytesReceived += OS_MBUF_PKTLEN(om);
       bleController.FirmwareUpdateCurrentBytes(bytesReceived);
+      connectionPolicy.OnTransfer(connectionHandle, OS_MBUF_PKTLEN(om));
 
       if ((nbPacketReceived % nbPacketsToNotify) == 0 && bytesReceived != applicationSize) {
         uint8_t data[5] {static_cast<uint8_t>(Opcodes::PacketReceiptNotification),
@@ -246,8 +273,6 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
         NRF_LOG_INFO("[DFU] -> Receive firmware image requested, but we are not in Start Init");
         return 0;
       }
-      // TODO the chunk size is dependent of the implementation of the host application...
-      dfuImage.Init(20, applicationSize, expectedCrc);
       NRF_LOG_INFO("[DFU] -> Starting receive firmware");
       state = States::Data;
       return 0;
@@ -259,7 +284,7 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
 
       NRF_LOG_INFO("[DFU] -> Validate firmware image requested -- %d", connectionHandle);
 
-      if (dfuImage.Validate()) {
+      if (dfuImage.Validate(expectedCrc)) {
         state = States::Validated;
         bleController.State(Pinetime::Controllers::Ble::FirmwareUpdateStates::Validated);
         NRF_LOG_INFO("Image OK");
@@ -309,6 +334,7 @@ void DfuService::Reset() {
   bootloaderSize = 0;
   applicationSize = 0;
   expectedCrc = 0;
+  dfuImage.Abort();
   notificationManager.Reset();
   bleController.StopFirmwareUpdate();
   systemTask.PushMessage(Pinetime::System::Messages::BleFirmwareUpdateFinished);
@@ -350,36 +376,224 @@ void DfuService::NotificationManager::Reset() {
   xTimerStop(timer, 0);
 }
 
-void DfuService::DfuImage::Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc) {
-  if (chunkSize != 20)
-    return;
-  this->chunkSize = chunkSize;
+DfuService::DfuImage::DfuImage(Pinetime::Drivers::SpiNorFlash& spiNorFlash) : spiNorFlash {spiNorFlash} {
+  freePages = xQueueCreate(nbPages, sizeof(uint8_t));
+  // The pages, and the stop request
+  fullPages = xQueueCreate(nbPages + 1, sizeof(uint8_t));
+  writerDone = xSemaphoreCreateBinary();
+}
+
+DfuService::DfuImage::InitResults DfuService::DfuImage::Init(size_t totalSize) {
+  Abort();
+  if (running) {
+    NRF_LOG_INFO("[DFU] The previous writer is still running");
+    return InitResults::WriterUnavailable;
+  }
+  if (totalSize == 0 || totalSize > maxSize) {
+    return InitResults::InvalidSize;
+  }
+
+  xQueueReset(freePages);
+  xQueueReset(fullPages);
+  xSemaphoreTake(writerDone, 0);
+  for (uint8_t i = 0; i < nbPages; i++) {
+    xQueueSend(freePages, &i, 0);
+  }
   this->totalSize = totalSize;
-  this->expectedCrc = expectedCrc;
-  this->ready = true;
-  totalWriteIndex = 0;
-  bufferWriteIndex = 0;
+  receivedSize = 0;
+  currentPage = noPage;
+  imageSize = 0;
+  erasedEnd = 0;
+  programmedEnd = 0;
+  crc = 0xffff;
+  aborted = false;
+
+  if (xTaskCreate(Process, "dfu", writerStackSize, this, 0, nullptr) != pdPASS) {
+    NRF_LOG_INFO("[DFU] Cannot create the writer task");
+    return InitResults::WriterUnavailable;
+  }
+  running = true;
+  ready = true;
+  return InitResults::Success;
 }
 
-void DfuService::DfuImage::Append(uint8_t* data, size_t size) {
-  if (!ready)
+bool DfuService::DfuImage::Append(const uint8_t* data, size_t size) {
+  if (!ready) {
+    return false;
+  }
+  if (size > totalSize - receivedSize) {
+    size = totalSize - receivedSize;
+  }
+
+  while (size > 0) {
+    if (currentPage == noPage) {
+      if (xQueueReceive(freePages, &currentPage, pageTimeout) != pdPASS) {
+        NRF_LOG_INFO("[DFU] No free page");
+        currentPage = noPage;
+        ready = false;
+        return false;
+      }
+      pages[currentPage].offset = receivedSize;
+      pages[currentPage].size = 0;
+    }
+
+    Page& page = pages[currentPage];
+    size_t copySize = (size > pageSize - page.size) ? (pageSize - page.size) : size;
+    std::memcpy(page.data.data() + page.size, data, copySize);
+    page.size += copySize;
+    receivedSize += copySize;
+    data += copySize;
+    size -= copySize;
+
+    if (page.size == pageSize || receivedSize == totalSize) {
+      xQueueSend(fullPages, &currentPage, 0);
+      currentPage = noPage;
+    }
+  }
+  return true;
+}
+
+bool DfuService::DfuImage::Validate(uint16_t expectedCrc) {
+  if (!running || xSemaphoreTake(writerDone, validateTimeout) != pdPASS) {
+    return false;
+  }
+  running = false;
+  return programmedEnd == imageSize && crc == expectedCrc;
+}
+
+bool DfuService::DfuImage::IsComplete() const {
+  return ready && receivedSize == totalSize;
+}
+
+void DfuService::DfuImage::Abort() {
+  ready = false;
+  if (!running) {
     return;
-  ASSERT(size <= 20);
+  }
+  uint8_t index = stopPage;
+  xQueueSendToFront(fullPages, &index, 0);
+  aborted = true;
+  if (xSemaphoreTake(writerDone, abortTimeout) == pdPASS) {
+    running = false;
+  }
+}
 
-  std::memcpy(tempBuffer + bufferWriteIndex, data, size);
-  bufferWriteIndex += size;
+void DfuService::DfuImage::Process(void* instance) {
+  auto* dfuImage = static_cast<DfuImage*>(instance);
+  dfuImage->Work();
+}
 
-  if (bufferWriteIndex == bufferSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
-    bufferWriteIndex = 0;
+void DfuService::DfuImage::Work() {
+  Decompression* decompression = nullptr;
+
+  while (true) {
+    // Erases the next sector of the image each time no page is waiting: the erase is done during the transfer, ahead
+    // of the pages, and a page waits at most the erase of one sector
+    TickType_t wait = (erasedEnd < EraseAheadEnd()) ? 0 : portMAX_DELAY;
+    uint8_t index;
+    if (xQueueReceive(fullPages, &index, wait) != pdPASS) {
+      EraseUntil(erasedEnd + sectorSize);
+      continue;
+    }
+    if (index == stopPage) {
+      break;
+    }
+
+    const Page& page = pages[index];
+    const uint8_t* data = page.data.data();
+    size_t size = page.size;
+    if (page.offset == 0) {
+      uint32_t decodedSize;
+      if (Pinetime::Tools::LzDecoder::ReadHeader(data, size, decodedSize)) {
+        NRF_LOG_INFO("[DFU] Compressed image : %d bytes", decodedSize);
+        void* memory = pvPortMalloc(sizeof(Decompression));
+        if (memory == nullptr) {
+          NRF_LOG_INFO("[DFU] Not enough memory to decode the image");
+          break;
+        }
+        decompression = new (memory) Decompression;
+        imageSize = decodedSize;
+        data += Pinetime::Tools::LzDecoder::headerSize;
+        size -= Pinetime::Tools::LzDecoder::headerSize;
+        decompression->decoder.Reset();
+      } else {
+        imageSize = totalSize;
+      }
+      if (imageSize == 0 || imageSize > maxSize) {
+        NRF_LOG_INFO("[DFU] Invalid image size : %d", imageSize);
+        break;
+      }
+    }
+
+    bool valid = true;
+    if (decompression != nullptr) {
+      valid = Decode(decompression->decoder, data, size, decompression->output.data(), decompression->outputSize);
+    } else {
+      Program(page.offset, data, size);
+    }
+    bool lastPage = (page.offset + page.size == totalSize);
+    xQueueSend(freePages, &index, 0);
+
+    if (programmedEnd == imageSize) {
+      if (imageSize < maxSize && !aborted) {
+        WriteMagicNumber();
+      }
+      break;
+    }
+    if (!valid || lastPage) {
+      NRF_LOG_INFO("[DFU] Invalid compressed image");
+      break;
+    }
+  }
+
+  static_assert(std::is_trivially_destructible_v<Decompression>, "The decompression state is freed without destroying it");
+  vPortFree(decompression);
+  xSemaphoreGive(writerDone);
+  vTaskDelete(nullptr);
+}
+
+bool DfuService::DfuImage::Decode(Pinetime::Tools::LzDecoder& decoder,
+                                  const uint8_t* data,
+                                  size_t size,
+                                  uint8_t* output,
+                                  size_t& outputSize) {
+  while (size > 0 && programmedEnd < imageSize) {
+    size_t remaining = imageSize - programmedEnd - outputSize;
+    size_t maxOutput = (pageSize - outputSize > remaining) ? remaining : (pageSize - outputSize);
+    size_t consumed;
+    outputSize += decoder.Decode(data, size, consumed, output + outputSize, maxOutput);
+    if (decoder.HasError()) {
+      return false;
+    }
+    data += consumed;
+    size -= consumed;
+
+    if (outputSize == pageSize || programmedEnd + outputSize == imageSize) {
+      Program(programmedEnd, output, outputSize);
+      outputSize = 0;
+    }
   }
+  return true;
+}
 
-  if (bufferWriteIndex > 0 && totalWriteIndex + bufferWriteIndex == totalSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
-    if (totalSize < maxSize)
-      WriteMagicNumber();
+void DfuService::DfuImage::Program(uint32_t offset, const uint8_t* data, size_t size) {
+  EraseUntil(offset + size);
+  spiNorFlash.Write(writeOffset + offset, data, size);
+
+  // The CRC is computed from the content of the flash, to check the writes too
+  uint8_t buffer[64];
+  for (size_t index = 0; index < size; index += sizeof(buffer)) {
+    size_t readSize = (size - index > sizeof(buffer)) ? sizeof(buffer) : (size - index);
+    spiNorFlash.Read(writeOffset + offset + index, buffer, readSize);
+    crc = ComputeCrc(buffer, readSize, &crc);
+  }
+  programmedEnd = offset + size;
+}
+
+void DfuService::DfuImage::EraseUntil(uint32_t end) {
+  while (erasedEnd < end && erasedEnd < maxSize && !aborted) {
+    spiNorFlash.SectorErase(writeOffset + erasedEnd);
+    erasedEnd += sectorSize;
   }
 }
 
@@ -392,35 +606,12 @@ void DfuService::DfuImage::WriteMagicNumber() {
     0x8079b62c,
   };
 
+  // The sectors between the image and the last one are left as they are, the bootloader only copies the image
   uint32_t offset = writeOffset + (maxSize - (4 * sizeof(uint32_t)));
-  spiNorFlash.Write(offset, reinterpret_cast<const uint8_t*>(magic), 4 * sizeof(uint32_t));
-}
-
-void DfuService::DfuImage::Erase() {
-  for (size_t erased = 0; erased < maxSize; erased += 0x1000) {
-    spiNorFlash.SectorErase(writeOffset + erased);
+  if (erasedEnd < maxSize) {
+    spiNorFlash.SectorErase(writeOffset + maxSize - sectorSize);
   }
-}
-
-bool DfuService::DfuImage::Validate() {
-  uint32_t chunkSize = 200;
-  size_t currentOffset = 0;
-  uint16_t crc = 0;
-
-  bool first = true;
-  while (currentOffset < totalSize) {
-    uint32_t readSize = (totalSize - currentOffset) > chunkSize ? chunkSize : (totalSize - currentOffset);
-
-    spiNorFlash.Read(writeOffset + currentOffset, tempBuffer, readSize);
-    if (first) {
-      crc = ComputeCrc(tempBuffer, readSize, NULL);
-      first = false;
-    } else
-      crc = ComputeCrc(tempBuffer, readSize, &crc);
-    currentOffset += readSize;
-  }
-
-  return (crc == expectedCrc);
+  spiNorFlash.Write(offset, reinterpret_cast<const uint8_t*>(magic), 4 * sizeof(uint32_t));
 }
 
 uint16_t DfuService::DfuImage::ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc) {
@@ -436,9 +627,3 @@ uint16_t DfuService::DfuImage::ComputeCrc(uint8_t const* p_data, uint32_t size,
 
   return crc;
 }
-
-bool DfuService::DfuImage::IsComplete() {
-  if (!ready)
-    return false;
-  return totalWriteIndex == totalSize;
-}
@@ -2,6 +2,11 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
+#include "components/lz/LzDecoder.h"
 
 #define min // workaround: nimble's min/max macros conflict with libstdc++
 #define max
@@ -20,12 +25,14 @@ namespace Pinetime {
 
   namespace Controllers {
     class Ble;
+    class ConnectionPolicy;
 
     class DfuService {
     public:
       DfuService(Pinetime::System::SystemTask& systemTask,
                  Pinetime::Controllers::Ble& bleController,
-                 Pinetime::Drivers::SpiNorFlash& spiNorFlash);
+                 Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                 ConnectionPolicy& connectionPolicy);
       void Init();
       int OnServiceData(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void OnTimeout();
@@ -49,37 +56,102 @@ namespace Pinetime {
         void Reset();
       };
 
+      // The image is received in the host task and programmed by a writer task. The packets (up to the MTU) are
+      // copied into two buffers of a flash page: the host task fills a page while the writer programs the other one.
+      // While it waits for the next page, the writer erases the next sector of the image, so the erase overlaps with
+      // the transfer instead of blocking the host task at the start. After the image, only the sector of the magic
+      // number is erased: the rest of the slot is erased by the next update, ahead of its own pages. The writer
+      // computes the CRC incrementally by reading back each page it programs.
+      // The image can be compressed by tools/dfu_compress.py: the writer decodes it before programming it, and the CRC
+      // is the CRC of the decoded image.
       class DfuImage {
       public:
-        DfuImage(Pinetime::Drivers::SpiNorFlash& spiNorFlash) : spiNorFlash {spiNorFlash} {
-        }
+        enum class InitResults : uint8_t { Success, InvalidSize, WriterUnavailable };
+
+        DfuImage(Pinetime::Drivers::SpiNorFlash& spiNorFlash);
 
-        void Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc);
-        void Erase();
-        void Append(uint8_t* data, size_t size);
-        bool Validate();
-        bool IsComplete();
+        // Starts the writer, which erases the first sectors while the init packet is received
+        InitResults Init(size_t totalSize);
+        // Returns false if the writer doesn't free a page in time
+        bool Append(const uint8_t* data, size_t size);
+        // Waits until the writer has programmed the whole image
+        bool Validate(uint16_t expectedCrc);
+        bool IsComplete() const;
+        // Stops the writer
+        void Abort();
 
       private:
+        static constexpr size_t maxSize = 475136;
+        static constexpr size_t pageSize = 256;
+        static constexpr size_t sectorSize = 0x1000;
+        static constexpr uint8_t nbPages = 2;
+        static constexpr uint8_t noPage = 0xff;
+        static constexpr uint8_t stopPage = 0xfe;
+        static constexpr size_t writeOffset = 0x40000;
+        static_assert(maxSize % sectorSize == 0, "The magic number must be in the last sector of the slot");
+        // Longest time the host task waits for a free page: the erase of a sector takes up to 300 ms
+        static constexpr TickType_t pageTimeout = pdMS_TO_TICKS(2000);
+        // Time to program the last pages and to erase the sector of the magic number
+        static constexpr TickType_t validateTimeout = pdMS_TO_TICKS(5000);
+        // The writer stops after the flash operation in progress
+        static constexpr TickType_t abortTimeout = pdMS_TO_TICKS(1000);
+        // The writer only exists during the update. The decoder and its output are only allocated for a compressed
+        // image (see Decompression), so that an uncompressed update doesn't pay for the window of the decoder.
+        static constexpr uint16_t writerStackSize = 256;
+
+        struct Page {
+          uint32_t offset;
+          uint16_t size;
+          std::array<uint8_t, pageSize> data;
+        };
+
+        // Allocated by the writer when the first page has the header of a compressed image
+        struct Decompression {
+          Pinetime::Tools::LzDecoder decoder;
+          std::array<uint8_t, pageSize> output;
+          size_t outputSize = 0;
+        };
+
+        static void Process(void* instance);
+        void Work();
+        // Decodes the data, and programs the output when it contains a page or the end of the image
+        bool Decode(Pinetime::Tools::LzDecoder& decoder, const uint8_t* data, size_t size, uint8_t* output, size_t& outputSize);
+        void Program(uint32_t offset, const uint8_t* data, size_t size);
+        void EraseUntil(uint32_t end);
+        // End of the area to erase ahead of the pages: the size of the image, once it's known
+        uint32_t EraseAheadEnd() const {
+          return (imageSize != 0) ? imageSize : totalSize;
+        }
+        void WriteMagicNumber();
+        static uint16_t ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc);
+
         Pinetime::Drivers::SpiNorFlash& spiNorFlash;
-        static constexpr size_t bufferSize = 200;
+        std::array<Page, nbPages> pages;
+        // Indices of the pages, and stopPage to stop the writer
+        QueueHandle_t freePages;
+        QueueHandle_t fullPages;
+        // Given by the writer when it exits
+        SemaphoreHandle_t writerDone;
+        bool running = false;
+        std::atomic<bool> aborted {false};
+
+        // Host task
         bool ready = false;
-        size_t chunkSize = 0;
         size_t totalSize = 0;
-        size_t maxSize = 475136;
-        size_t bufferWriteIndex = 0;
-        size_t totalWriteIndex = 0;
-        static constexpr size_t writeOffset = 0x40000;
-        uint8_t tempBuffer[bufferSize];
-        uint16_t expectedCrc = 0;
-
-        void WriteMagicNumber();
-        uint16_t ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc);
+        size_t receivedSize = 0;
+        uint8_t currentPage = noPage;
+
+        // Writer task
+        uint32_t imageSize = 0;
+        uint32_t erasedEnd = 0;
+        uint32_t programmedEnd = 0;
+        uint16_t crc = 0xffff;
       };
 
     private:
       Pinetime::System::SystemTask& systemTask;
       Pinetime::Controllers::Ble& bleController;
+      ConnectionPolicy& connectionPolicy;
       DfuImage dfuImage;
       NotificationManager notificationManager;
 
@@ -0,0 +1,306 @@
+#include "components/ble/DiagnosticsService.h"
+#include <algorithm>
+#include <array>
+#include <nrf_log.h>
+#include <task.h>
+#include "components/ble/ConnectionPolicy.h"
+#include "components/profiling/FrameProfiler.h"
+#include "components/profiling/ProfilingClock.h"
+#include "drivers/TwiMaster.h"
+#include "systemtask/SystemMonitor.h"
+#include "FreeRTOS/heap_4_infinitime.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // 0006yyxx-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t CharUuid(uint8_t x, uint8_t y) {
+    return ble_uuid128_t {.u = {.type = BLE_UUID_TYPE_128},
+                          .value = {0xd0, 0x42, 0x19, 0x3a, 0x3b, 0x43, 0x23, 0x8e, 0xfe, 0x48, 0xfc, 0x78, x, y, 0x06, 0x00}};
+  }
+
+  // 00060000-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t BaseUuid() {
+    return CharUuid(0x00, 0x00);
+  }
+
+  constexpr ble_uuid128_t diagnosticsServiceUuid {BaseUuid()};
+  constexpr ble_uuid128_t frameStatisticsCharUuid {CharUuid(0x01, 0x00)};
+  constexpr ble_uuid128_t cpuLoadCharUuid {CharUuid(0x02, 0x00)};
+  constexpr ble_uuid128_t heapStatisticsCharUuid {CharUuid(0x03, 0x00)};
+  constexpr ble_uuid128_t heapEventsCharUuid {CharUuid(0x04, 0x00)};
+  constexpr ble_uuid128_t connectionCharUuid {CharUuid(0x05, 0x00)};
+  constexpr ble_uuid128_t twiStatisticsCharUuid {CharUuid(0x06, 0x00)};
+
+  int DiagnosticsServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
+    auto* diagnosticsService = static_cast<DiagnosticsService*>(arg);
+    return diagnosticsService->OnDiagnosticsRequested(attr_handle, ctxt);
+  }
+
+  template <typename T>
+  uint8_t* Put(uint8_t* buffer, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+      *buffer++ = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return buffer;
+  }
+}
+
+DiagnosticsService::DiagnosticsService(FrameProfiler& frameProfiler,
+                                       const System::SystemMonitor& systemMonitor,
+                                       const ConnectionPolicy& connectionPolicy,
+                                       const Drivers::TwiMaster& twiMaster)
+  : frameProfiler {frameProfiler},
+    systemMonitor {systemMonitor},
+    connectionPolicy {connectionPolicy},
+    twiMaster {twiMaster},
+    characteristicDefinition {{.uuid = &frameStatisticsCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &frameStatisticsHandle},
+                              {.uuid = &cpuLoadCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &cpuLoadHandle},
+                              {.uuid = &heapStatisticsCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &heapStatisticsHandle},
+                              {.uuid = &heapEventsCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &heapEventsHandle},
+                              {.uuid = &connectionCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &connectionHandle},
+                              {.uuid = &twiStatisticsCharUuid.u,
+                               .access_cb = DiagnosticsServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &twiStatisticsHandle},
+                              {0}},
+    serviceDefinition {
+      {.type = BLE_GATT_SVC_TYPE_PRIMARY, .uuid = &diagnosticsServiceUuid.u, .characteristics = characteristicDefinition},
+      {0},
+    } {
+}
+
+void DiagnosticsService::Init() {
+  int res = 0;
+  res = ble_gatts_count_cfg(serviceDefinition);
+  ASSERT(res == 0);
+
+  res = ble_gatts_add_svcs(serviceDefinition);
+  ASSERT(res == 0);
+}
+
+int DiagnosticsService::OnDiagnosticsRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
+  if (attributeHandle == frameStatisticsHandle) {
+    return ReadFrameStatistics(context);
+  }
+  if (attributeHandle == cpuLoadHandle) {
+    return ReadCpuLoad(context);
+  }
+  if (attributeHandle == heapStatisticsHandle) {
+    return ReadHeapStatistics(context);
+  }
+  if (attributeHandle == heapEventsHandle) {
+    return ReadHeapEvents(context);
+  }
+  if (attributeHandle == connectionHandle) {
+    return ReadConnection(context);
+  }
+  if (attributeHandle == twiStatisticsHandle) {
+    return ReadTwiStatistics(context);
+  }
+  return 0;
+}
+
+int DiagnosticsService::ReadFrameStatistics(ble_gatt_access_ctxt* context) {
+  std::array<FrameProfiler::Summary, FrameProfiler::nbScreens> summaries;
+  size_t nbSummaries = frameProfiler.GetSummaries(summaries);
+
+  static constexpr size_t entrySize = 35;
+  uint8_t buffer[1 + entrySize * FrameProfiler::nbScreens];
+  uint8_t* ptr = buffer;
+  *ptr++ = static_cast<uint8_t>(nbSummaries);
+  for (size_t i = 0; i < nbSummaries; i++) {
+    const auto& summary = summaries[i];
+    ptr = Put(ptr, summary.screen);
+    ptr = Put(ptr, summary.frames);
+    ptr = Put(ptr, summary.frameRate);
+    ptr = Put(ptr, summary.averageRenderUs);
+    ptr = Put(ptr, summary.maxRenderUs);
+    ptr = Put(ptr, summary.averageFlushUs);
+    ptr = Put(ptr, summary.maxFlushUs);
+    ptr = Put(ptr, summary.averageBytes);
+    ptr = Put(ptr, summary.averageAreas);
+    ptr = Put(ptr, summary.averageCommands);
+    ptr = Put(ptr, summary.fullRefreshes);
+  }
+
+  int res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int DiagnosticsService::ReadCpuLoad(ble_gatt_access_ctxt* context) {
+  using SystemMonitor = System::SystemMonitor;
+  std::array<SystemMonitor::Task, SystemMonitor::maxTasks> tasks;
+  std::array<SystemMonitor::Sample, SystemMonitor::historySize> samples;
+  size_t nbSamples = systemMonitor.GetHistory(samples);
+  size_t nbTasks = systemMonitor.GetTasks(tasks);
+
+  // The entries are appended one by one to keep the stack usage of the host task low
+  static constexpr size_t nameSize = sizeof(SystemMonitor::Task::name);
+  uint8_t buffer[4 + 2 * SystemMonitor::maxTasks];
+  buffer[0] = static_cast<uint8_t>(nbTasks);
+  buffer[1] = static_cast<uint8_t>(nbSamples);
+  int res = os_mbuf_append(context->om, buffer, 2);
+  for (size_t i = 0; i < nbTasks && res == 0; i++) {
+    std::copy(tasks[i].name, tasks[i].name + nameSize, buffer);
+    uint8_t* ptr = Put(buffer + nameSize, tasks[i].stackHighWaterMark);
+    res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  }
+  for (size_t i = 0; i < nbSamples && res == 0; i++) {
+    uint8_t* ptr = Put(buffer, samples[i].duration);
+    ptr = Put(ptr, samples[i].sleep);
+    for (size_t task = 0; task < nbTasks; task++) {
+      ptr = Put(ptr, samples[i].loads[task]);
+    }
+    res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  }
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int DiagnosticsService::ReadHeapStatistics(ble_gatt_access_ctxt* context) {
+  HeapStats_t stats;
+  vPortGetHeapStats(&stats);
+  HeapFailure_t failure {};
+  xPortGetLastHeapFailure(&failure);
+
+  uint8_t buffer[28 + 2 * heapNB_FREE_BLOCK_BINS];
+  uint8_t* ptr = Put(buffer, static_cast<uint32_t>(stats.xAvailableHeapSpaceInBytes));
+  ptr = Put(ptr, static_cast<uint32_t>(stats.xMinimumEverFreeBytesRemaining));
+  ptr = Put(ptr, static_cast<uint32_t>(stats.xSizeOfLargestFreeBlockInBytes));
+  ptr = Put(ptr, static_cast<uint32_t>(stats.xNumberOfFreeBlocks));
+  ptr = Put(ptr, stats.ulNumberOfSuccessfulAllocations);
+  ptr = Put(ptr, stats.ulNumberOfSuccessfulFrees);
+  ptr = Put(ptr, stats.ulNumberOfFailedAllocations);
+  for (auto count : stats.usFreeBlockHistogram) {
+    ptr = Put(ptr, count);
+  }
+  int res = os_mbuf_append(context->om, buffer, ptr - buffer);
+
+  ptr = Put(buffer, static_cast<uint32_t>(failure.uxAddress));
+  ptr = Put(ptr, static_cast<uint32_t>(failure.xWantedSize));
+  ptr = Put(ptr, static_cast<uint32_t>(failure.xFreeBytes));
+  ptr = Put(ptr, static_cast<uint32_t>(failure.xLargestFreeBlock));
+  ptr = Put(ptr, failure.ulTime);
+  ptr = std::copy(failure.pcTaskName, failure.pcTaskName + sizeof(failure.pcTaskName), ptr);
+  *ptr++ = failure.ucContext;
+  if (res == 0) {
+    res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  }
+
+  std::array<HeapCallSite_t, heapNB_CALL_SITES + 1> callSites;
+  size_t nbCallSites = xPortGetHeapCallSites(callSites.data(), callSites.size());
+  *buffer = static_cast<uint8_t>(nbCallSites);
+  if (res == 0) {
+    res = os_mbuf_append(context->om, buffer, 1);
+  }
+  for (size_t i = 0; i < nbCallSites && res == 0; i++) {
+    ptr = Put(buffer, static_cast<uint32_t>(callSites[i].uxAddress));
+    ptr = Put(ptr, callSites[i].ulAllocations);
+    ptr = Put(ptr, static_cast<uint32_t>(callSites[i].xLiveBytes));
+    ptr = Put(ptr, static_cast<uint32_t>(callSites[i].xPeakLiveBytes));
+    res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  }
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int DiagnosticsService::ReadHeapEvents(ble_gatt_access_ctxt* context) {
+  // The events are copied a few at a time to keep the stack usage of the host task low: an allocation made by another
+  // task in the meantime shifts them, the times allow to detect the duplicates
+  static constexpr size_t eventsPerCopy = 4;
+  static constexpr size_t eventSize = 18;
+  HeapEvent_t events[eventsPerCopy];
+  uint8_t buffer[eventSize * eventsPerCopy];
+
+  int res = 0;
+  for (size_t first = 0; res == 0;) {
+    size_t count = xPortGetHeapEvents(events, first, eventsPerCopy);
+    if (count == 0) {
+      break;
+    }
+    uint8_t* ptr = buffer;
+    for (size_t i = 0; i < count; i++) {
+      const auto& event = events[i];
+      ptr = Put(ptr, event.ulTime);
+      ptr = Put(ptr, static_cast<uint32_t>(event.uxAddress));
+      ptr = Put(ptr, event.usSize);
+      ptr = Put(ptr, event.usFreeBytes);
+      *ptr++ = event.ucType;
+      *ptr++ = event.ucContext;
+      ptr = std::copy(event.pcTask, event.pcTask + sizeof(event.pcTask), ptr);
+    }
+    res = os_mbuf_append(context->om, buffer, ptr - buffer);
+    first += count;
+  }
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int DiagnosticsService::ReadConnection(ble_gatt_access_ctxt* context) {
+  ConnectionPolicy::Status status = connectionPolicy.GetStatus();
+  uint8_t buffer[25];
+  uint8_t* ptr = buffer;
+  *ptr++ = static_cast<uint8_t>(status.mode);
+  ptr = Put(ptr, status.interval);
+  ptr = Put(ptr, status.latency);
+  ptr = Put(ptr, status.supervisionTimeout);
+  ptr = Put(ptr, status.mtu);
+  *ptr++ = status.txPhy;
+  *ptr++ = status.rxPhy;
+  ptr = Put(ptr, status.failedUpdates);
+  ptr = Put(ptr, status.transferBytes);
+  ptr = Put(ptr, status.transferDurationMs);
+  ptr = Put(ptr, status.goodput);
+  int res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int DiagnosticsService::ReadTwiStatistics(ble_gatt_access_ctxt* context) {
+  // Copied at once: the interrupt updates the statistics of a transaction all together
+  std::array<Drivers::TwiMaster::DeviceStatistics, Drivers::TwiMaster::maxDevices> statistics;
+  taskENTER_CRITICAL();
+  statistics = twiMaster.Statistics();
+  taskEXIT_CRITICAL();
+
+  static constexpr size_t entrySize = 29;
+  uint8_t buffer[1 + entrySize * Drivers::TwiMaster::maxDevices];
+  uint8_t* ptr = buffer + 1;
+  uint8_t nbDevices = 0;
+  for (const auto& device : statistics) {
+    if (device.deviceAddress == 0) {
+      break;
+    }
+    nbDevices++;
+    uint32_t averageLatency = (device.transactions > 0) ? device.totalLatency / device.transactions : 0;
+    *ptr++ = device.deviceAddress;
+    ptr = Put(ptr, device.transactions);
+    ptr = Put(ptr, device.bytes);
+    ptr = Put(ptr, device.errors);
+    ptr = Put(ptr, device.retries);
+    ptr = Put(ptr, device.freezeRecoveries);
+    ptr = Put(ptr, ProfilingClock::TicksToUs(averageLatency));
+    ptr = Put(ptr, ProfilingClock::TicksToUs(device.maxLatency));
+  }
+  buffer[0] = nbDevices;
+  int res = os_mbuf_append(context->om, buffer, ptr - buffer);
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
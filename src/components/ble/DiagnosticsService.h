@@ -0,0 +1,56 @@
+#pragma once
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace System {
+    class SystemMonitor;
+  }
+
+  namespace Drivers {
+    class TwiMaster;
+  }
+
+  namespace Controllers {
+    class FrameProfiler;
+    class ConnectionPolicy;
+
+    // Exports the profiling data of the firmware, see doc/DiagnosticsService.md
+    class DiagnosticsService {
+    public:
+      DiagnosticsService(FrameProfiler& frameProfiler,
+                         const System::SystemMonitor& systemMonitor,
+                         const ConnectionPolicy& connectionPolicy,
+                         const Drivers::TwiMaster& twiMaster);
+      void Init();
+
+      int OnDiagnosticsRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
+
+    private:
+      int ReadFrameStatistics(ble_gatt_access_ctxt* context);
+      int ReadCpuLoad(ble_gatt_access_ctxt* context);
+      int ReadHeapStatistics(ble_gatt_access_ctxt* context);
+      int ReadHeapEvents(ble_gatt_access_ctxt* context);
+      int ReadConnection(ble_gatt_access_ctxt* context);
+      int ReadTwiStatistics(ble_gatt_access_ctxt* context);
+
+      FrameProfiler& frameProfiler;
+      const System::SystemMonitor& systemMonitor;
+      const ConnectionPolicy& connectionPolicy;
+      const Drivers::TwiMaster& twiMaster;
+
+      struct ble_gatt_chr_def characteristicDefinition[7];
+      struct ble_gatt_svc_def serviceDefinition[2];
+
+      uint16_t frameStatisticsHandle;
+      uint16_t cpuLoadHandle;
+      uint16_t heapStatisticsHandle;
+      uint16_t heapEventsHandle;
+      uint16_t connectionHandle;
+      uint16_t twiStatisticsHandle;
+    };
+  }
+}
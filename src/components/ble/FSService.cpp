@@ -1,7 +1,10 @@
 #include <nrf_log.h>
 #include "FSService.h"
 #include "components/ble/BleController.h"
+#include "components/ble/ConnectionPolicy.h"
 #include "systemtask/SystemTask.h"
+#include <algorithm>
+#include <nimble/nimble_port.h>
 
 using namespace Pinetime::Controllers;
 
@@ -9,14 +12,22 @@ constexpr ble_uuid16_t FSService::fsServiceUuid;
 constexpr ble_uuid128_t FSService::fsVersionUuid;
 constexpr ble_uuid128_t FSService::fsTransferUuid;
 
+namespace {
+  void FSServiceStreamCallback(ble_npl_event* event) {
+    auto* fsService = static_cast<FSService*>(ble_npl_event_get_arg(event));
+    fsService->OnStreamEvent();
+  }
+}
+
 int FSServiceCallback(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
   auto* fsService = static_cast<FSService*>(arg);
   return fsService->OnFSServiceRequested(conn_handle, attr_handle, ctxt);
 }
 
-FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Controllers::FS& fs)
+FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Controllers::FS& fs, ConnectionPolicy& connectionPolicy)
   : systemTask {systemTask},
     fs {fs},
+    connectionPolicy {connectionPolicy},
     characteristicDefinition {{.uuid = &fsVersionUuid.u,
                                .access_cb = FSServiceCallback,
                                .arg = this,
@@ -46,6 +57,9 @@ void FSService::Init() {
 
   res = ble_gatts_add_svcs(serviceDefinition);
   ASSERT(res == 0);
+
+  // The stream is resumed from the event queue of the host, like the commands
+  ble_npl_callout_init(&streamCallout, nimble_port_get_dflt_eventq(), FSServiceStreamCallback, this);
 }
 
 int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
@@ -63,7 +77,8 @@ int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attribut
 int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   auto command = static_cast<commands>(om->om_data[0]);
   NRF_LOG_INFO("[FS_S] -> FSCommandHandler Command %d", command);
-  // Just always make sure we are awake...
+  // Just always make sure we are awake... The command holds its own transfer, a stream holds another one until it's
+  // closed
   systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
   vTaskDelay(10);
   while (systemTask.IsSleeping()) {
@@ -78,6 +93,7 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       auto* header = (ReadHeader*) om->om_data;
       uint16_t plen = header->pathlen;
       if (plen > maxpathlen) { //> counts for null term
+        systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
         return -1;
       }
       memcpy(filepath, header->pathstr, plen);
@@ -106,6 +122,7 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       }
 
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      connectionPolicy.OnTransfer(connectionHandle, resp.chunklen);
       break;
     }
     case commands::READ_PACING: {
@@ -138,6 +155,25 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       }
       fs.FileClose(&f);
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      connectionPolicy.OnTransfer(connectionHandle, resp.chunklen);
+      break;
+    }
+    case commands::READ_STREAM: {
+      NRF_LOG_INFO("[FS_S] -> ReadStream");
+      auto* header = (ReadStreamHeader*) om->om_data;
+      if (header->pathlen >= maxpathlen) {
+        systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+        return -1;
+      }
+      StartStream(connectionHandle, header);
+      break;
+    }
+    case commands::READ_STREAM_CREDIT: {
+      auto* header = (ReadStreamCredit*) om->om_data;
+      if (state == FSState::READ_STREAM) {
+        streamCredits += header->credits;
+        SendStreamChunks();
+      }
       break;
     }
     case commands::WRITE: {
@@ -145,6 +181,7 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       auto* header = (WriteHeader*) om->om_data;
       uint16_t plen = header->pathlen;
       if (plen > maxpathlen) { //> counts for null term
+        systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
         return -1;             // TODO make this actually return a BLE notif
       }
       memcpy(filepath, header->pathstr, plen);
@@ -179,6 +216,7 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
         }
         fs.FileClose(&f);
       }
+      connectionPolicy.OnTransfer(connectionHandle, header->dataSize);
       if (res < 0) {
         resp.status = (int8_t) res;
       }
@@ -306,6 +344,132 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   return 0;
 }
 
+void FSService::Reset() {
+  if (state == FSState::READ_STREAM) {
+    NRF_LOG_INFO("[FS_S] Stream aborted at %d/%d", streamOffset, streamSize);
+    CloseStream();
+  }
+}
+
+void FSService::OnStreamEvent() {
+  if (state == FSState::READ_STREAM) {
+    SendStreamChunks();
+  }
+}
+
+void FSService::StartStream(uint16_t connectionHandle, ReadStreamHeader* header) {
+  // A new stream replaces the one in progress
+  if (state == FSState::READ_STREAM) {
+    CloseStream();
+  }
+  memcpy(filepath, header->pathstr, header->pathlen);
+  filepath[header->pathlen] = 0;
+
+  lfs_info info = {};
+  int res = fs.Stat(filepath, &info);
+  if (res >= 0 && info.type == LFS_TYPE_DIR) {
+    res = LFS_ERR_ISDIR;
+  }
+  if (res >= 0) {
+    res = fs.FileOpen(&streamFile, filepath, LFS_O_RDONLY);
+  }
+  streamConnectionHandle = connectionHandle;
+  streamStartOffset = std::min<uint32_t>(header->offset, (res >= 0) ? info.size : 0);
+  streamOffset = streamStartOffset;
+  streamSize = (res >= 0) ? info.size : 0;
+  streamCredits = header->credits;
+  streamStartTime = xTaskGetTickCount();
+  if (res < 0) {
+    EndStream(static_cast<int8_t>(res));
+    return;
+  }
+
+  // The system stays awake until the stream is closed
+  state = FSState::READ_STREAM;
+  systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
+  fs.FileSeek(&streamFile, streamOffset);
+  SendStreamChunks();
+}
+
+// Each notification is filled up to the MTU from streamBuffer. ble_gattc_notify_custom() only queues the notification:
+// the next chunk is read from the flash while the controller transmits the previous ones.
+void FSService::SendStreamChunks() {
+  uint16_t mtu = ble_att_mtu(streamConnectionHandle);
+  if (mtu == 0) {
+    CloseStream();
+    return;
+  }
+  auto* response = reinterpret_cast<ReadResponse*>(streamBuffer);
+  uint32_t maxChunkSize = std::min<uint32_t>(mtu - 3, maxStreamNotificationSize) - sizeof(ReadResponse);
+
+  for (size_t chunk = 0; chunk < streamChunksPerBurst; chunk++) {
+    if (streamOffset >= streamSize) {
+      EndStream(0x01);
+      return;
+    }
+    if (streamCredits == 0) {
+      return;
+    }
+    if (os_msys_num_free() <= streamMsysReserve) {
+      ble_npl_callout_reset(&streamCallout, ble_npl_time_ms_to_ticks32(streamRetryDelayMs));
+      return;
+    }
+
+    int read = fs.FileRead(&streamFile, response->chunk, std::min(maxChunkSize, streamSize - streamOffset));
+    if (read <= 0) {
+      EndStream(static_cast<int8_t>((read < 0) ? read : LFS_ERR_IO));
+      return;
+    }
+    response->command = commands::READ_STREAM_DATA;
+    response->status = 0x01;
+    response->padding = 0;
+    response->chunkoff = streamOffset;
+    response->totallen = streamSize;
+    response->chunklen = read;
+    auto* om = ble_hs_mbuf_from_flat(streamBuffer, sizeof(ReadResponse) + read);
+    if (om == nullptr || ble_gattc_notify_custom(streamConnectionHandle, transferCharacteristicHandle, om) != 0) {
+      // The chunk is read again at the next attempt
+      fs.FileSeek(&streamFile, streamOffset);
+      ble_npl_callout_reset(&streamCallout, ble_npl_time_ms_to_ticks32(streamRetryDelayMs));
+      return;
+    }
+    streamOffset += read;
+    streamCredits--;
+    connectionPolicy.OnTransfer(streamConnectionHandle, read);
+  }
+
+  // The other events of the host (the credits from the client, the other services) are processed before the next burst
+  ble_npl_callout_reset(&streamCallout, 0);
+}
+
+void FSService::EndStream(int8_t status) {
+  TickType_t elapsed = std::max<TickType_t>(xTaskGetTickCount() - streamStartTime, 1);
+  ReadStreamEnd end {};
+  end.command = commands::READ_STREAM_END;
+  end.status = status;
+  end.totallen = streamOffset - streamStartOffset;
+  end.duration = static_cast<uint32_t>((static_cast<uint64_t>(elapsed) * 1000) / configTICK_RATE_HZ);
+  end.throughput = static_cast<uint32_t>((static_cast<uint64_t>(end.totallen) * configTICK_RATE_HZ) / elapsed);
+  NRF_LOG_INFO("[FS_S] Stream end (%d) : %d bytes in %d ms, %d B/s", status, end.totallen, end.duration, end.throughput);
+
+  auto* om = ble_hs_mbuf_from_flat(&end, sizeof(ReadStreamEnd));
+  ble_gattc_notify_custom(streamConnectionHandle, transferCharacteristicHandle, om);
+  if (state == FSState::READ_STREAM) {
+    CloseStream();
+  }
+}
+
+// Releases the transfer held by the stream: only the stream in progress can be closed
+void FSService::CloseStream() {
+  if (state != FSState::READ_STREAM) {
+    return;
+  }
+  ble_npl_callout_stop(&streamCallout);
+  fs.FileClose(&streamFile);
+  state = FSState::IDLE;
+  systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+}
+
 // Loads resp with file data given a valid filepath header and resp
 void FSService::prepareReadDataResp(ReadHeader* header, ReadResponse* resp) {
   // uint16_t plen = header->pathlen;
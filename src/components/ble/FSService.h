@@ -5,6 +5,7 @@
 #undef max
 #undef min
 
+#include <FreeRTOS.h>
 #include "components/fs/FS.h"
 
 namespace Pinetime {
@@ -14,23 +15,35 @@ namespace Pinetime {
 
   namespace Controllers {
     class Ble;
+    class ConnectionPolicy;
 
     class FSService {
     public:
-      FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Controllers::FS& fs);
+      FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Controllers::FS& fs, ConnectionPolicy& connectionPolicy);
       void Init();
 
       int OnFSServiceRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void NotifyFSRaw(uint16_t connectionHandle);
+      // Aborts the stream in progress when the connection is closed
+      void Reset();
+      void OnStreamEvent();
 
     private:
       Pinetime::System::SystemTask& systemTask;
       Pinetime::Controllers::FS& fs;
+      ConnectionPolicy& connectionPolicy;
       static constexpr uint16_t FSServiceId {0xFEBB};
       static constexpr uint16_t fsVersionId {0x0100};
       static constexpr uint16_t fsTransferId {0x0200};
-      uint16_t fsVersion = {0x0004};
+      uint16_t fsVersion = {0x0005};
       static constexpr uint16_t maxpathlen = 256;
+      // Largest notification with the preferred MTU, and the number of chunks sent before the other events of the host
+      // are processed. The stream waits while fewer than streamMsysReserve buffers are free, so that the host can still
+      // receive the credits from the client.
+      static constexpr size_t maxStreamNotificationSize = MYNEWT_VAL(BLE_ATT_PREFERRED_MTU) - 3;
+      static constexpr size_t streamChunksPerBurst = 8;
+      static constexpr int streamMsysReserve = 4;
+      static constexpr uint32_t streamRetryDelayMs = 5;
       static constexpr ble_uuid16_t fsServiceUuid {
         .u {.type = BLE_UUID_TYPE_16},
         .value = {0xFEBB}}; // {0x72, 0x65, 0x66, 0x73, 0x6e, 0x61, 0x72, 0x54, 0x65, 0x6c, 0x69, 0x46, 0xBB, 0xFE, 0xAF, 0xAD}};
@@ -53,6 +66,10 @@ namespace Pinetime {
         READ = 0x10,
         READ_DATA = 0x11,
         READ_PACING = 0x12,
+        READ_STREAM = 0x13,
+        READ_STREAM_DATA = 0x14,
+        READ_STREAM_CREDIT = 0x15,
+        READ_STREAM_END = 0x16,
         WRITE = 0x20,
         WRITE_PACING = 0x21,
         WRITE_DATA = 0x22,
@@ -69,8 +86,9 @@ namespace Pinetime {
         IDLE = 0x00,
         READ = 0x01,
         WRITE = 0x02,
+        READ_STREAM = 0x03,
       };
-      FSState state;
+      FSState state = FSState::IDLE;
       char filepath[maxpathlen]; // TODO ..ugh fixed filepath len
       int fileSize;
 
@@ -101,6 +119,31 @@ namespace Pinetime {
         uint32_t chunksize;
       };
 
+      using ReadStreamHeader = struct __attribute__((packed)) {
+        commands command;
+        uint8_t padding;
+        uint16_t pathlen;
+        uint32_t offset;
+        uint32_t credits;
+        char pathstr[];
+      };
+
+      using ReadStreamCredit = struct __attribute__((packed)) {
+        commands command;
+        uint8_t padding;
+        uint16_t padding2;
+        uint32_t credits;
+      };
+
+      using ReadStreamEnd = struct __attribute__((packed)) {
+        commands command;
+        uint8_t status;
+        uint16_t padding;
+        uint32_t totallen;
+        uint32_t duration;
+        uint32_t throughput;
+      };
+
       using WriteHeader = struct __attribute__((packed)) {
         commands command;
         uint8_t padding;
@@ -192,6 +235,22 @@ namespace Pinetime {
 
       int FSCommandHandler(uint16_t connectionHandle, os_mbuf* om);
       void prepareReadDataResp(ReadHeader* header, ReadResponse* resp);
+
+      void StartStream(uint16_t connectionHandle, ReadStreamHeader* header);
+      void SendStreamChunks();
+      void EndStream(int8_t status);
+      void CloseStream();
+
+      // Streamed read: the file stays open, and a notification is sent for each credit granted by the client
+      lfs_file_t streamFile;
+      uint16_t streamConnectionHandle = BLE_HS_CONN_HANDLE_NONE;
+      uint32_t streamStartOffset = 0;
+      uint32_t streamOffset = 0;
+      uint32_t streamSize = 0;
+      uint32_t streamCredits = 0;
+      TickType_t streamStartTime = 0;
+      ble_npl_callout streamCallout {};
+      uint8_t streamBuffer[maxStreamNotificationSize];
     };
   }
 }
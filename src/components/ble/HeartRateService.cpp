@@ -1,6 +1,8 @@
 #include "components/ble/HeartRateService.h"
 #include "components/heartrate/HeartRateController.h"
 #include "components/ble/NimbleController.h"
+#include "systemtask/SystemTask.h"
+#include <algorithm>
 #include <nrf_log.h>
 
 using namespace Pinetime::Controllers;
@@ -9,21 +11,34 @@ constexpr ble_uuid16_t HeartRateService::heartRateServiceUuid;
 constexpr ble_uuid16_t HeartRateService::heartRateMeasurementUuid;
 
 namespace {
-  int HeartRateServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
+  // 00070001-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t historyCharUuid {
+    .u = {.type = BLE_UUID_TYPE_128},
+    .value = {0xd0, 0x42, 0x19, 0x3a, 0x3b, 0x43, 0x23, 0x8e, 0xfe, 0x48, 0xfc, 0x78, 0x01, 0x00, 0x07, 0x00}};
+
+  int HeartRateServiceCallback(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
     auto* heartRateService = static_cast<HeartRateService*>(arg);
-    return heartRateService->OnHeartRateRequested(attr_handle, ctxt);
+    return heartRateService->OnHeartRateRequested(conn_handle, attr_handle, ctxt);
   }
 }
 
 // TODO Refactoring - remove dependency to SystemTask
-HeartRateService::HeartRateService(NimbleController& nimble, Controllers::HeartRateController& heartRateController)
-  : nimble {nimble},
+HeartRateService::HeartRateService(System::SystemTask& systemTask,
+                                   NimbleController& nimble,
+                                   Controllers::HeartRateController& heartRateController)
+  : systemTask {systemTask},
+    nimble {nimble},
     heartRateController {heartRateController},
     characteristicDefinition {{.uuid = &heartRateMeasurementUuid.u,
                                .access_cb = HeartRateServiceCallback,
                                .arg = this,
                                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
                                .val_handle = &heartRateMeasurementHandle},
+                              {.uuid = &historyCharUuid.u,
+                               .access_cb = HeartRateServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+                               .val_handle = &historyHandle},
                               {0}},
     serviceDefinition {
       {/* Device Information Service */
@@ -45,7 +60,10 @@ void HeartRateService::Init() {
   ASSERT(res == 0);
 }
 
-int HeartRateService::OnHeartRateRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
+int HeartRateService::OnHeartRateRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
+  if (attributeHandle == historyHandle) {
+    return OnHistoryRequested(connectionHandle, context);
+  }
   if (attributeHandle == heartRateMeasurementHandle) {
     NRF_LOG_INFO("HEARTRATE : handle = %d", heartRateMeasurementHandle);
     uint8_t buffer[2] = {0, heartRateController.HeartRate()}; // [0] = flags, [1] = hr value
@@ -56,6 +74,86 @@ int HeartRateService::OnHeartRateRequested(uint16_t attributeHandle, ble_gatt_ac
   return 0;
 }
 
+// A write sets the timestamp of the oldest record to send, each read sends the next records (nothing at the end)
+int HeartRateService::OnHistoryRequested(uint16_t connectionHandle, ble_gatt_access_ctxt* context) {
+  if (context->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+    uint8_t since[sizeof(uint32_t)];
+    if (OS_MBUF_PKTLEN(context->om) != sizeof(since)) {
+      return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+    os_mbuf_copydata(context->om, 0, sizeof(since), since);
+    historyCursor = {};
+    historyCursor.since = since[0] | (since[1] << 8) | (since[2] << 16) | (static_cast<uint32_t>(since[3]) << 24);
+    historyBuffered = 0;
+    historyBufferIndex = 0;
+    return 0;
+  }
+
+  // The response must fit in a single ATT packet: a long read would call this callback again for each part, and the
+  // buffer would move each time.
+  if (historyBufferIndex == historyBuffered && !FillHistoryBuffer()) {
+    StopHistoryTransfer();
+    return 0;
+  }
+  size_t recordsPerMtu = static_cast<size_t>(ble_att_mtu(connectionHandle) - 1) / HeartRateHistory::recordSize;
+  size_t count = std::min(recordsPerMtu, historyBuffered - historyBufferIndex);
+  int res = os_mbuf_append(context->om,
+                           historyBuffer + historyBufferIndex * HeartRateHistory::recordSize,
+                           count * HeartRateHistory::recordSize);
+  historyBufferIndex += count;
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+bool HeartRateService::FillHistoryBuffer() {
+  // The SPI flash sleeps with the system: it's kept awake from the first read to the end of the history, so that
+  // the following reads don't have to wait
+  if (!historyTransfer) {
+    StartHistoryTransfer();
+    vTaskDelay(10);
+  }
+  while (systemTask.IsSleeping()) {
+    vTaskDelay(100);
+  }
+
+  HeartRateHistory::Record records[historyRecordsPerChunk];
+  historyBuffered = 0;
+  historyBufferIndex = 0;
+  while (historyBuffered < historyBufferSize) {
+    size_t count = heartRateController.History().Read(historyCursor,
+                                                      records,
+                                                      std::min(historyRecordsPerChunk, historyBufferSize - historyBuffered));
+    if (count == 0) {
+      break;
+    }
+    for (size_t i = 0; i < count; i++) {
+      HeartRateHistory::Encode(records[i], historyBuffer + (historyBuffered + i) * HeartRateHistory::recordSize);
+    }
+    historyBuffered += count;
+  }
+  return historyBuffered > 0;
+}
+
+void HeartRateService::StartHistoryTransfer() {
+  if (!historyTransfer) {
+    historyTransfer = true;
+    systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
+  }
+}
+
+void HeartRateService::StopHistoryTransfer() {
+  if (historyTransfer) {
+    historyTransfer = false;
+    systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+  }
+}
+
+void HeartRateService::Reset() {
+  // A transfer interrupted by a disconnection must not keep the system awake
+  StopHistoryTransfer();
+  historyBuffered = 0;
+  historyBufferIndex = 0;
+}
+
 void HeartRateService::OnNewHeartRateValue(uint8_t heartRateValue) {
   if (!heartRateMeasurementNotificationEnable)
     return;
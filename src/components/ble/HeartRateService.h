@@ -5,23 +5,38 @@
 #undef max
 #undef min
 #include <atomic>
+#include "components/heartrate/HeartRateHistory.h"
 
 namespace Pinetime {
+  namespace System {
+    class SystemTask;
+  }
+
   namespace Controllers {
     class HeartRateController;
     class NimbleController;
 
+    // Standard heart rate service, extended with the history of the measurements (see doc/HeartRateHistory.md)
     class HeartRateService {
     public:
-      HeartRateService(NimbleController& nimble, Controllers::HeartRateController& heartRateController);
+      HeartRateService(System::SystemTask& systemTask, NimbleController& nimble, Controllers::HeartRateController& heartRateController);
       void Init();
-      int OnHeartRateRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
+      int OnHeartRateRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void OnNewHeartRateValue(uint8_t hearRateValue);
 
       void SubscribeNotification(uint16_t attributeHandle);
       void UnsubscribeNotification(uint16_t attributeHandle);
+      // Called on disconnection
+      void Reset();
 
     private:
+      int OnHistoryRequested(uint16_t connectionHandle, ble_gatt_access_ctxt* context);
+      // Reads the next records from the flash, returns false at the end of the history
+      bool FillHistoryBuffer();
+      void StartHistoryTransfer();
+      void StopHistoryTransfer();
+
+      System::SystemTask& systemTask;
       NimbleController& nimble;
       Controllers::HeartRateController& heartRateController;
       static constexpr uint16_t heartRateServiceId {0x180D};
@@ -31,11 +46,23 @@ namespace Pinetime {
 
       static constexpr ble_uuid16_t heartRateMeasurementUuid {.u {.type = BLE_UUID_TYPE_16}, .value = heartRateMeasurementId};
 
-      struct ble_gatt_chr_def characteristicDefinition[2];
+      // Records read from the flash at once and sent by the following reads of the history characteristic, and
+      // records decoded at once into the buffer
+      static constexpr size_t historyBufferSize = 40;
+      static constexpr size_t historyRecordsPerChunk = 8;
+
+      struct ble_gatt_chr_def characteristicDefinition[3];
       struct ble_gatt_svc_def serviceDefinition[2];
 
       uint16_t heartRateMeasurementHandle;
+      uint16_t historyHandle;
       std::atomic_bool heartRateMeasurementNotificationEnable {false};
+      HeartRateHistory::Cursor historyCursor;
+      uint8_t historyBuffer[historyBufferSize * HeartRateHistory::recordSize];
+      size_t historyBuffered = 0;
+      size_t historyBufferIndex = 0;
+      // The SPI flash is kept awake during a transfer
+      bool historyTransfer = false;
     };
   }
 }
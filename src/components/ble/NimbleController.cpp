@@ -30,25 +30,30 @@ NimbleController::NimbleController(Pinetime::System::SystemTask& systemTask,
                                    Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                                    HeartRateController& heartRateController,
                                    MotionController& motionController,
-                                   FS& fs)
+                                   FS& fs,
+                                   FrameProfiler& frameProfiler,
+                                   const Pinetime::System::SystemMonitor& systemMonitor,
+                                   const Pinetime::Drivers::TwiMaster& twiMaster,
+                                   ChangeNotifier& changeNotifier)
   : systemTask {systemTask},
     bleController {bleController},
     dateTimeController {dateTimeController},
     spiNorFlash {spiNorFlash},
     fs {fs},
-    dfuService {systemTask, bleController, spiNorFlash},
+    dfuService {systemTask, bleController, spiNorFlash, connectionPolicy},
 
     currentTimeClient {dateTimeController},
     anService {systemTask, notificationManager},
     alertNotificationClient {systemTask, notificationManager},
     currentTimeService {dateTimeController},
     musicService {*this},
-    weatherService {dateTimeController},
+    weatherService {dateTimeController, changeNotifier},
     batteryInformationService {batteryController},
     immediateAlertService {systemTask, notificationManager},
-    heartRateService {*this, heartRateController},
+    heartRateService {systemTask, *this, heartRateController},
     motionService {*this, motionController},
-    fsService {systemTask, fs},
+    fsService {systemTask, fs, connectionPolicy},
+    diagnosticsService {frameProfiler, systemMonitor, connectionPolicy, twiMaster},
     serviceDiscovery({&currentTimeClient, &alertNotificationClient}) {
 }
 
@@ -84,6 +89,7 @@ void NimbleController::Init() {
 
   ble_svc_gap_init();
   ble_svc_gatt_init();
+  connectionPolicy.Init();
 
   deviceInformationService.Init();
   currentTimeClient.Init();
@@ -98,6 +104,7 @@ void NimbleController::Init() {
   heartRateService.Init();
   motionService.Init();
   fsService.Init();
+  diagnosticsService.Init();
 
   int rc;
   rc = ble_hs_util_ensure_addr(0);
@@ -203,6 +210,7 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
         StartAdvertising();
       } else {
         connectionHandle = event->connect.conn_handle;
+        connectionPolicy.OnConnect(connectionHandle);
         bleController.Connect();
         systemTask.PushMessage(Pinetime::System::Messages::BleConnected);
         // Service discovery is deferred via systemtask
@@ -220,6 +228,9 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
 
       currentTimeClient.Reset();
       alertNotificationClient.Reset();
+      fsService.Reset();
+      heartRateService.Reset();
+      connectionPolicy.OnDisconnect();
       connectionHandle = BLE_HS_CONN_HANDLE_NONE;
       if (bleController.IsConnected()) {
         bleController.Disconnect();
@@ -232,6 +243,7 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
       /* The central has updated the connection parameters. */
       NRF_LOG_INFO("Update event : BLE_GAP_EVENT_CONN_UPDATE");
       NRF_LOG_INFO("update status=%0X ", event->conn_update.status);
+      connectionPolicy.OnConnectionUpdated(event->conn_update.conn_handle, event->conn_update.status);
       break;
 
     case BLE_GAP_EVENT_CONN_UPDATE_REQ:
@@ -333,6 +345,18 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
 
     case BLE_GAP_EVENT_MTU:
       NRF_LOG_INFO("MTU Update event; conn_handle=%d cid=%d mtu=%d", event->mtu.conn_handle, event->mtu.channel_id, event->mtu.value);
+      connectionPolicy.OnMtuChanged(event->mtu.conn_handle, event->mtu.value);
+      break;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+      NRF_LOG_INFO("PHY Update event; status=%d tx=%d rx=%d",
+                   event->phy_updated.status,
+                   event->phy_updated.tx_phy,
+                   event->phy_updated.rx_phy);
+      connectionPolicy.OnPhyUpdated(event->phy_updated.conn_handle,
+                                    event->phy_updated.status,
+                                    event->phy_updated.tx_phy,
+                                    event->phy_updated.rx_phy);
       break;
 
     case BLE_GAP_EVENT_REPEAT_PAIRING: {
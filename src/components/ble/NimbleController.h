@@ -10,10 +10,12 @@
 #include "components/ble/AlertNotificationClient.h"
 #include "components/ble/AlertNotificationService.h"
 #include "components/ble/BatteryInformationService.h"
+#include "components/ble/ConnectionPolicy.h"
 #include "components/ble/CurrentTimeClient.h"
 #include "components/ble/CurrentTimeService.h"
 #include "components/ble/DeviceInformationService.h"
 #include "components/ble/DfuService.h"
+#include "components/ble/DiagnosticsService.h"
 #include "components/ble/FSService.h"
 #include "components/ble/HeartRateService.h"
 #include "components/ble/ImmediateAlertService.h"
@@ -27,16 +29,20 @@
 namespace Pinetime {
   namespace Drivers {
     class SpiNorFlash;
+    class TwiMaster;
   }
 
   namespace System {
     class SystemTask;
+    class SystemMonitor;
   }
 
   namespace Controllers {
     class Ble;
     class DateTime;
     class NotificationManager;
+    class FrameProfiler;
+    class ChangeNotifier;
 
     class NimbleController {
 
@@ -49,7 +55,11 @@ namespace Pinetime {
                        Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                        HeartRateController& heartRateController,
                        MotionController& motionController,
-                       FS& fs);
+                       FS& fs,
+                       FrameProfiler& frameProfiler,
+                       const System::SystemMonitor& systemMonitor,
+                       const Pinetime::Drivers::TwiMaster& twiMaster,
+                       ChangeNotifier& changeNotifier);
       void Init();
       void StartAdvertising();
       int OnGAPEvent(ble_gap_event* event);
@@ -91,6 +101,7 @@ namespace Pinetime {
       DateTime& dateTimeController;
       Pinetime::Drivers::SpiNorFlash& spiNorFlash;
       FS& fs;
+      ConnectionPolicy connectionPolicy;
       DfuService dfuService;
 
       DeviceInformationService deviceInformationService;
@@ -106,6 +117,7 @@ namespace Pinetime {
       HeartRateService heartRateService;
       MotionService motionService;
       FSService fsService;
+      DiagnosticsService diagnosticsService;
       ServiceDiscovery serviceDiscovery;
 
       uint8_t addrType;
@@ -2,122 +2,356 @@
 #include <cstring>
 #include <algorithm>
 #include <cassert>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+#include "nrf_assert.h"
 
 using namespace Pinetime::Controllers;
 
 constexpr uint8_t NotificationManager::MessageSize;
 
+NotificationManager::NotificationManager(ChangeNotifier& changeNotifier, FS& fs) : fs {fs}, changeNotifier {changeNotifier} {
+  mutex = xSemaphoreCreateMutex();
+  ASSERT(mutex != nullptr);
+}
+
+void NotificationManager::Init() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  LoadIndex(previousFile, true);
+  LoadIndex(currentFile, false);
+  xSemaphoreGive(mutex);
+  NRF_LOG_INFO("[NotificationManager] %d notifications, %d in the current file", nbLive, currentRecords);
+}
+
+// littlefs commits the writes to a file when it's closed, so the log never ends with a partial record
+void NotificationManager::LoadIndex(const char* path, bool previous) {
+  lfs_file_t file;
+  if (fs.FileOpen(&file, path, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return;
+  }
+  uint8_t header[notificationHeaderSize];
+  uint32_t offset = 0;
+  while (fs.FileRead(&file, header, headerSize) == static_cast<int>(headerSize)) {
+    auto type = static_cast<RecordTypes>(header[0]);
+    Notification::Id id = header[2] | (header[3] << 8);
+    if (type == RecordTypes::Tombstone) {
+      size_t position = Find(id);
+      if (position < indexCount) {
+        index[position].flags |= flagDismissed;
+        nbLive--;
+      }
+      offset += headerSize;
+      continue;
+    }
+    if (type != RecordTypes::Notification || fs.FileRead(&file, header + headerSize, 1) != 1) {
+      NRF_LOG_INFO("[NotificationManager] Invalid record in %s at %d", path, offset);
+      break;
+    }
+
+    // A log written by a firmware that didn't rotate its files may hold more notifications than the index: the oldest
+    // ones are left out
+    if (indexCount == maxLoggedEntries) {
+      RemoveEntry(0);
+    }
+    AddEntry({static_cast<uint16_t>(offset), id, static_cast<uint8_t>(header[1] & 0x0f), previous ? flagPrevious : uint8_t {0}});
+    nextId = id + 1;
+    if (!previous) {
+      currentRecords++;
+    }
+    offset += notificationHeaderSize + header[4];
+    fs.FileSeek(&file, offset);
+  }
+  if (!previous) {
+    currentSize = offset;
+  }
+  fs.FileClose(&file);
+}
+
 void NotificationManager::Push(NotificationManager::Notification&& notif) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
   notif.id = GetNextId();
   notif.valid = true;
-  newNotification = true;
-  if (beginIdx > 0) {
-    --beginIdx;
-  } else {
-    beginIdx = notifications.size() - 1;
+  notif.size = std::clamp<uint8_t>(notif.size, 1, MessageSize + 1);
+  notif.message[notif.size - 1] = '\0';
+  if (pendingCount == pending.size()) {
+    NRF_LOG_INFO("[NotificationManager] Notification %d dropped before being saved", pending[0].id);
+    RemoveOldestPending();
   }
-  notifications[beginIdx] = std::move(notif);
-  if (size < notifications.size()) {
-    size++;
+  pending[pendingCount] = std::move(notif);
+  const auto& notification = pending[pendingCount];
+  AddEntry({static_cast<uint16_t>(pendingCount), notification.id, static_cast<uint8_t>(notification.category), flagPending});
+  pendingCount++;
+  xSemaphoreGive(mutex);
+
+  newNotification = true;
+  changeNotifier.Publish(Changes::Notifications);
+}
+
+void NotificationManager::Flush() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  while (pendingCount > 0) {
+    // Rotate() moves the entries of the index
+    if (currentRecords >= maxRecordsPerFile && !Rotate()) {
+      // The notifications stay pending, the rotation is tried again on the next Flush()
+      break;
+    }
+    size_t position = std::find_if(index.begin(), index.begin() + indexCount, [](const Entry& entry) {
+                        return (entry.flags & flagPending) != 0 && entry.offset == 0;
+                      }) -
+                      index.begin();
+    if ((index[position].flags & flagDismissed) != 0) {
+      // Dismissed before being saved
+      RemoveOldestPending();
+      continue;
+    }
+
+    const Notification& notification = pending[0];
+    uint8_t buffer[notificationHeaderSize + MessageSize + 1];
+    buffer[0] = static_cast<uint8_t>(RecordTypes::Notification);
+    buffer[1] = static_cast<uint8_t>(notification.category);
+    buffer[2] = notification.id & 0xff;
+    buffer[3] = notification.id >> 8;
+    buffer[4] = notification.size;
+    std::memcpy(buffer + notificationHeaderSize, notification.message.data(), notification.size);
+    if (!Append(buffer, notificationHeaderSize + notification.size)) {
+      break;
+    }
+
+    // The position of the entry didn't change, the notification stays in the index
+    index[position].offset = static_cast<uint16_t>(currentSize);
+    index[position].flags &= ~flagPending;
+    currentSize += notificationHeaderSize + notification.size;
+    currentRecords++;
+    std::move(pending.begin() + 1, pending.begin() + pendingCount, pending.begin());
+    pendingCount--;
+    for (size_t i = 0; i < indexCount; i++) {
+      if ((index[i].flags & flagPending) != 0) {
+        index[i].offset--;
+      }
+    }
   }
+  xSemaphoreGive(mutex);
 }
 
-NotificationManager::Notification::Id NotificationManager::GetNextId() {
-  return nextId++;
+bool NotificationManager::Append(const uint8_t* data, size_t size) {
+  lfs_file_t file;
+  if (fs.FileOpen(&file, currentFile, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND) != LFS_ERR_OK) {
+    NRF_LOG_INFO("[NotificationManager] Cannot open %s", currentFile);
+    return false;
+  }
+  int written = fs.FileWrite(&file, data, size);
+  fs.FileClose(&file);
+  if (written != static_cast<int>(size)) {
+    NRF_LOG_INFO("[NotificationManager] Cannot write %s : %d", currentFile, written);
+    return false;
+  }
+  return true;
 }
 
-NotificationManager::Notification NotificationManager::GetLastNotification() const {
-  if (this->IsEmpty()) {
-    return {};
+// The current file replaces the previous one: the notifications of the previous file, the oldest ones, are dropped
+bool NotificationManager::Rotate() {
+  int result = fs.Rename(currentFile, previousFile);
+  if (result != LFS_ERR_OK) {
+    NRF_LOG_INFO("[NotificationManager] Cannot rename %s : %d", currentFile, result);
+    return DropCurrentFile();
   }
-  return this->At(0);
+  size_t dropped = 0;
+  while (dropped < indexCount && (index[dropped].flags & flagPrevious) != 0) {
+    if ((index[dropped].flags & flagDismissed) == 0) {
+      nbLive--;
+    }
+    dropped++;
+  }
+  std::move(index.begin() + dropped, index.begin() + indexCount, index.begin());
+  indexCount -= dropped;
+  for (size_t i = 0; i < indexCount; i++) {
+    if ((index[i].flags & flagPending) == 0) {
+      index[i].flags |= flagPrevious;
+    }
+  }
+  currentRecords = 0;
+  currentSize = 0;
+  return true;
 }
 
-const NotificationManager::Notification& NotificationManager::At(NotificationManager::Notification::Idx idx) const {
-  if (idx >= notifications.size()) {
-    assert(false);
-    return notifications.at(beginIdx); // this should not happen
+// The current file must not grow past maxRecordsPerFile: when it can't be rotated, its notifications are dropped instead
+// of the ones of the previous file
+bool NotificationManager::DropCurrentFile() {
+  int result = fs.FileDelete(currentFile);
+  if (result != LFS_ERR_OK) {
+    NRF_LOG_INFO("[NotificationManager] Cannot delete %s : %d", currentFile, result);
+    return false;
+  }
+  for (size_t i = 0; i < indexCount;) {
+    if ((index[i].flags & (flagPrevious | flagPending)) == 0) {
+      RemoveEntry(i);
+    } else {
+      i++;
+    }
   }
-  size_t read_idx = (beginIdx + idx) % notifications.size();
-  return notifications.at(read_idx);
+  currentRecords = 0;
+  currentSize = 0;
+  return true;
+}
+
+void NotificationManager::AddEntry(const Entry& entry) {
+  ASSERT(indexCount < index.size());
+  index[indexCount++] = entry;
+  nbLive++;
 }
 
-NotificationManager::Notification& NotificationManager::At(NotificationManager::Notification::Idx idx) {
-  if (idx >= notifications.size()) {
-    assert(false);
-    return notifications.at(beginIdx); // this should not happen
+void NotificationManager::RemoveEntry(size_t position) {
+  if ((index[position].flags & flagDismissed) == 0) {
+    nbLive--;
   }
-  size_t read_idx = (beginIdx + idx) % notifications.size();
-  return notifications.at(read_idx);
+  std::move(index.begin() + position + 1, index.begin() + indexCount, index.begin() + position);
+  indexCount--;
 }
 
-NotificationManager::Notification::Idx NotificationManager::IndexOf(NotificationManager::Notification::Id id) const {
-  for (NotificationManager::Notification::Idx idx = 0; idx < this->size; idx++) {
-    const NotificationManager::Notification& notification = this->At(idx);
-    if (notification.id == id) {
-      return idx;
+void NotificationManager::RemoveOldestPending() {
+  for (size_t i = 0; i < indexCount;) {
+    if ((index[i].flags & flagPending) == 0) {
+      i++;
+    } else if (index[i].offset == 0) {
+      RemoveEntry(i);
+    } else {
+      index[i++].offset--;
     }
   }
-  return size;
+  std::move(pending.begin() + 1, pending.begin() + pendingCount, pending.begin());
+  pendingCount--;
 }
 
-NotificationManager::Notification NotificationManager::Get(NotificationManager::Notification::Id id) const {
-  NotificationManager::Notification::Idx idx = this->IndexOf(id);
-  if (idx == this->size) {
-    return {};
-  }
-  return this->At(idx);
+NotificationManager::Notification::Id NotificationManager::GetNextId() {
+  return nextId++;
 }
 
-NotificationManager::Notification NotificationManager::GetNext(NotificationManager::Notification::Id id) const {
-  NotificationManager::Notification::Idx idx = this->IndexOf(id);
-  if (idx == this->size) {
-    return {};
+size_t NotificationManager::Find(NotificationManager::Notification::Id id) const {
+  for (size_t position = 0; position < indexCount; position++) {
+    if (index[position].id == id && (index[position].flags & flagDismissed) == 0) {
+      return position;
+    }
   }
-  if (idx == 0 || idx > notifications.size()) {
-    return {};
+  return indexCount;
+}
+
+NotificationManager::Handle NotificationManager::HandleAt(size_t position) const {
+  return {index[position].id, static_cast<Categories>(index[position].category), true};
+}
+
+NotificationManager::Handle NotificationManager::GetLastNotification() const {
+  Handle handle;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (size_t position = indexCount; position > 0; position--) {
+    if ((index[position - 1].flags & flagDismissed) == 0) {
+      handle = HandleAt(position - 1);
+      break;
+    }
   }
-  return this->At(idx - 1);
+  xSemaphoreGive(mutex);
+  return handle;
 }
 
-NotificationManager::Notification NotificationManager::GetPrevious(NotificationManager::Notification::Id id) const {
-  NotificationManager::Notification::Idx idx = this->IndexOf(id);
-  if (idx == this->size) {
-    return {};
+NotificationManager::Notification::Idx NotificationManager::IndexOf(NotificationManager::Notification::Id id) const {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  size_t idx = nbLive;
+  size_t position = Find(id);
+  if (position < indexCount) {
+    idx = std::count_if(index.begin() + position + 1, index.begin() + indexCount, [](const Entry& entry) {
+      return (entry.flags & flagDismissed) == 0;
+    });
   }
-  if (static_cast<size_t>(idx + 1) >= notifications.size()) {
-    return {};
+  xSemaphoreGive(mutex);
+  return static_cast<Notification::Idx>(idx);
+}
+
+NotificationManager::Handle NotificationManager::Get(NotificationManager::Notification::Id id) const {
+  Handle handle;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  size_t position = Find(id);
+  if (position < indexCount) {
+    handle = HandleAt(position);
   }
-  return this->At(idx + 1);
+  xSemaphoreGive(mutex);
+  return handle;
 }
 
-void NotificationManager::DismissIdx(NotificationManager::Notification::Idx idx) {
-  if (this->IsEmpty()) {
-    return;
+NotificationManager::Handle NotificationManager::GetNext(NotificationManager::Notification::Id id) const {
+  Handle handle;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (size_t position = Find(id) + 1; position < indexCount; position++) {
+    if ((index[position].flags & flagDismissed) == 0) {
+      handle = HandleAt(position);
+      break;
+    }
   }
-  if (idx >= size) {
-    assert(false);
-    return; // this should not happen
+  xSemaphoreGive(mutex);
+  return handle;
+}
+
+NotificationManager::Handle NotificationManager::GetPrevious(NotificationManager::Notification::Id id) const {
+  Handle handle;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (size_t position = Find(id); position > 0 && position <= indexCount; position--) {
+    if ((index[position - 1].flags & flagDismissed) == 0) {
+      handle = HandleAt(position - 1);
+      break;
+    }
   }
-  if (idx == 0) { // just remove the first element, don't need to change the other elements
-    notifications.at(beginIdx).valid = false;
-    beginIdx = (beginIdx + 1) % notifications.size();
-  } else {
-    // overwrite the specified entry by moving all later messages one index to the front
-    for (size_t i = idx; i < size - 1; ++i) {
-      this->At(i) = this->At(i + 1);
+  xSemaphoreGive(mutex);
+  return handle;
+}
+
+bool NotificationManager::Load(NotificationManager::Notification::Id id, NotificationManager::Notification& notification) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  notification.valid = false;
+  notification.size = 1;
+  notification.message[0] = '\0';
+  size_t position = Find(id);
+  if (position < indexCount) {
+    const Entry& entry = index[position];
+    if ((entry.flags & flagPending) != 0) {
+      notification = pending[entry.offset];
+    } else {
+      const char* path = ((entry.flags & flagPrevious) != 0) ? previousFile : currentFile;
+      lfs_file_t file;
+      uint8_t header[notificationHeaderSize];
+      if (fs.FileOpen(&file, path, LFS_O_RDONLY) == LFS_ERR_OK) {
+        fs.FileSeek(&file, entry.offset);
+        if (fs.FileRead(&file, header, notificationHeaderSize) == static_cast<int>(notificationHeaderSize) && header[4] > 0 &&
+            fs.FileRead(&file, reinterpret_cast<uint8_t*>(notification.message.data()), header[4]) == header[4]) {
+          notification.size = header[4];
+          notification.message[notification.size - 1] = '\0';
+          notification.category = static_cast<Categories>(entry.category);
+          notification.id = entry.id;
+          notification.valid = true;
+        }
+        fs.FileClose(&file);
+      }
     }
-    this->At(size - 1).valid = false;
   }
-  --size;
+  xSemaphoreGive(mutex);
+  return notification.valid;
 }
 
 void NotificationManager::Dismiss(NotificationManager::Notification::Id id) {
-  NotificationManager::Notification::Idx idx = this->IndexOf(id);
-  if (idx == this->size) {
-    return;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  size_t position = Find(id);
+  if (position < indexCount) {
+    index[position].flags |= flagDismissed;
+    nbLive--;
+    // A pending notification is dropped by Flush()
+    if ((index[position].flags & flagPending) == 0) {
+      uint8_t tombstone[headerSize] = {static_cast<uint8_t>(RecordTypes::Tombstone),
+                                       0,
+                                       static_cast<uint8_t>(id & 0xff),
+                                       static_cast<uint8_t>(id >> 8)};
+      if (Append(tombstone, sizeof(tombstone))) {
+        currentSize += sizeof(tombstone);
+      }
+    }
   }
-  this->DismissIdx(idx);
+  xSemaphoreGive(mutex);
 }
 
 bool NotificationManager::AreNewNotificationsAvailable() const {
@@ -125,11 +359,15 @@ bool NotificationManager::AreNewNotificationsAvailable() const {
 }
 
 bool NotificationManager::ClearNewNotificationFlag() {
-  return newNotification.exchange(false);
+  bool wasNew = newNotification.exchange(false);
+  if (wasNew) {
+    changeNotifier.Publish(Changes::Notifications);
+  }
+  return wasNew;
 }
 
 size_t NotificationManager::NbNotifications() const {
-  return size;
+  return nbLive;
 }
 
 const char* NotificationManager::Notification::Message() const {
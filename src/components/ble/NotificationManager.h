@@ -1,15 +1,27 @@
 #pragma once
 
+#include <FreeRTOS.h>
+#include <semphr.h>
 #include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Controllers {
+    class FS;
+
+    // Notifications received over BLE, stored in an append-only log on the file system. Only a small index (id,
+    // category, position in the log) is kept in RAM, with the notification not written to the log yet. The messages
+    // are read from the log on demand, into a buffer of the caller. The log is made of two files of at most
+    // maxRecordsPerFile notifications: when the current file is full, it replaces the previous one, which drops the
+    // oldest notifications. A dismissed notification stays in the log and is marked as dismissed by a tombstone record.
+    // The SPI flash is powered down while the system sleeps, so Push() only queues the notifications in RAM and
+    // SystemTask writes them with Flush() once the flash is awake.
     class NotificationManager {
     public:
-      enum class Categories {
+      enum class Categories : uint8_t {
         Unknown,
         SimpleAlert,
         Email,
@@ -22,10 +34,10 @@ namespace Pinetime {
         HighProriotyAlert,
         InstantMessage
       };
-      static constexpr uint8_t MessageSize {100};
+      static constexpr uint8_t MessageSize {240};
 
       struct Notification {
-        using Id = uint8_t;
+        using Id = uint16_t;
         using Idx = uint8_t;
 
         std::array<char, MessageSize + 1> message;
@@ -38,15 +50,41 @@ namespace Pinetime {
         const char* Title() const;
       };
 
+      // Reference to a notification of the index: Load() reads its message
+      struct Handle {
+        Notification::Id id = 0;
+        Categories category = Categories::Unknown;
+        bool valid = false;
+      };
+
+      // About 25 KB per file with the longest messages
+      static constexpr size_t maxRecordsPerFile = 100;
+
+      NotificationManager(ChangeNotifier& changeNotifier, FS& fs);
+
+      // Rebuilds the index from the log
+      void Init();
+
       void Push(Notification&& notif);
-      Notification GetLastNotification() const;
-      Notification Get(Notification::Id id) const;
-      Notification GetNext(Notification::Id id) const;
-      Notification GetPrevious(Notification::Id id) const;
+      // The SPI flash must be awake
+      void Flush();
+
+      // The notifications are ordered from the newest (index 0) to the oldest. GetNext() returns the newer
+      // notification, GetPrevious() the older one.
+      Handle GetLastNotification() const;
+      Handle Get(Notification::Id id) const;
+      Handle GetNext(Notification::Id id) const;
+      Handle GetPrevious(Notification::Id id) const;
       // Return the index of the notification with the specified id, if not found return NbNotifications()
       Notification::Idx IndexOf(Notification::Id id) const;
+
+      // Reads the notification into the buffer of the caller. Returns false, and the notification is invalid, if it
+      // doesn't exist anymore.
+      bool Load(Notification::Id id, Notification& notification);
+
       bool ClearNewNotificationFlag();
       bool AreNewNotificationsAvailable() const;
+      // Writes the tombstone to the log: the SPI flash must be awake (the display is on)
       void Dismiss(Notification::Id id);
 
       static constexpr size_t MaximumMessageSize() {
@@ -54,24 +92,67 @@ namespace Pinetime {
       };
 
       bool IsEmpty() const {
-        return size == 0;
+        return NbNotifications() == 0;
       }
 
       size_t NbNotifications() const;
 
     private:
-      Notification::Id nextId {0};
+      enum class RecordTypes : uint8_t { Notification = 1, Tombstone = 2 };
+
+      // On flash, little endian: type (1 byte), category (1 byte), id (2 bytes), then for a notification the size of
+      // the message (1 byte) and the message
+      static constexpr size_t headerSize = 4;
+      static constexpr size_t notificationHeaderSize = headerSize + 1;
+
+      struct __attribute__((packed)) Entry {
+        uint16_t offset; // In the file of the notification
+        Notification::Id id;
+        uint8_t category : 4; // Categories
+        uint8_t flags : 4;
+      };
+      static_assert(sizeof(Entry) == 5, "The index must stay small");
+      static_assert(static_cast<uint8_t>(Categories::InstantMessage) < 16, "The category must fit in 4 bits");
+
+      static constexpr uint8_t flagPrevious = 0x01; // In the previous file instead of the current one
+      static constexpr uint8_t flagPending = 0x02;  // Not written yet, offset is the position in pending
+      static constexpr uint8_t flagDismissed = 0x04;
+
+      static constexpr const char* previousFile = "/notifications.old.dat";
+      static constexpr const char* currentFile = "/notifications.dat";
+      // The notifications are written to the log when SystemTask handles them: this many can arrive in a burst before
+      // that, the oldest one is dropped after that
+      static constexpr size_t maxPendingNotifications = 5;
+      static constexpr size_t maxLoggedEntries = 2 * maxRecordsPerFile;
+      static constexpr size_t maxEntries = maxLoggedEntries + maxPendingNotifications;
+
       Notification::Id GetNextId();
-      const Notification& At(Notification::Idx idx) const;
-      Notification& At(Notification::Idx idx);
-      void DismissIdx(Notification::Idx idx);
+      void LoadIndex(const char* path, bool previous);
+      void AddEntry(const Entry& entry);
+      void RemoveEntry(size_t position);
+      void RemoveOldestPending();
+      // Return false if the current file is still full
+      bool Rotate();
+      bool DropCurrentFile();
+      bool Append(const uint8_t* data, size_t size);
+      // Position in the index (oldest first) of the live notification, or indexCount
+      size_t Find(Notification::Id id) const;
+      Handle HandleAt(size_t position) const;
+
+      FS& fs;
+      SemaphoreHandle_t mutex = nullptr;
+      Notification::Id nextId {0};
+      std::array<Entry, maxEntries> index;
+      size_t indexCount = 0;
+      size_t nbLive = 0;
+      size_t currentRecords = 0;
+      uint32_t currentSize = 0;
 
-      static constexpr uint8_t TotalNbNotifications = 5;
-      std::array<Notification, TotalNbNotifications> notifications;
-      size_t beginIdx = TotalNbNotifications - 1; // index of the newest notification
-      size_t size = 0;                            // number of valid notifications in buffer
+      std::array<Notification, maxPendingNotifications> pending;
+      size_t pendingCount = 0;
 
       std::atomic<bool> newNotification {false};
+      ChangeNotifier& changeNotifier;
     };
   }
 }
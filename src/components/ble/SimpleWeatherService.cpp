@@ -80,7 +80,8 @@ int WeatherCallback(uint16_t /*connHandle*/, uint16_t /*attrHandle*/, struct ble
   return static_cast<Pinetime::Controllers::SimpleWeatherService*>(arg)->OnCommand(ctxt);
 }
 
-SimpleWeatherService::SimpleWeatherService(DateTime& dateTimeController) : dateTimeController(dateTimeController) {
+SimpleWeatherService::SimpleWeatherService(DateTime& dateTimeController, ChangeNotifier& changeNotifier)
+  : dateTimeController(dateTimeController), changeNotifier(changeNotifier) {
 }
 
 void SimpleWeatherService::Init() {
@@ -103,6 +104,7 @@ int SimpleWeatherService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
                      currentWeather->maxTemperature,
                      currentWeather->iconId,
                      currentWeather->location.data());
+        changeNotifier.Publish(Changes::Weather);
       }
       break;
     case MessageType::Forecast:
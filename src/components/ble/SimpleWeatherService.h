@@ -33,6 +33,7 @@
 #undef min
 
 #include "components/datetime/DateTimeController.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #define COORDS_N 49.6
 #define COORDS_E 11.01
 #define TZ_UTC_OFFSET 2
@@ -47,7 +48,7 @@ namespace Pinetime {
 
     class SimpleWeatherService {
     public:
-      explicit SimpleWeatherService(DateTime& dateTimeController);
+      SimpleWeatherService(DateTime& dateTimeController, ChangeNotifier& changeNotifier);
 
       void Init();
 
@@ -160,6 +161,7 @@ namespace Pinetime {
       uint16_t eventHandle {};
 
       Pinetime::Controllers::DateTime& dateTimeController;
+      Pinetime::Controllers::ChangeNotifier& changeNotifier;
 
       std::optional<CurrentWeather> currentWeather;
       std::optional<Forecast> forecast;
@@ -0,0 +1,41 @@
+#include "components/changenotifier/ChangeNotifier.h"
+
+using namespace Pinetime::Controllers;
+
+void ChangeNotifier::Publish(Changes change) {
+  sequenceNumbers[static_cast<uint8_t>(change)]++;
+  if ((subscriptions & MaskOf(change)) == 0 || listener == nullptr) {
+    return;
+  }
+  if (!notificationPending.exchange(true)) {
+    listener();
+  }
+}
+
+void ChangeNotifier::SetListener(std::function<void()> listener) {
+  this->listener = std::move(listener);
+}
+
+void ChangeNotifier::Subscribe(Mask changes) {
+  subscriptions = changes;
+}
+
+void ChangeNotifier::Acknowledge() {
+  notificationPending = false;
+}
+
+ChangeNotifier::Mask ChangeNotifier::ChangedSince(Sequences& sequences, Mask changes) const {
+  Mask changed = 0;
+  for (size_t i = 0; i < nbChanges; i++) {
+    auto change = static_cast<Changes>(i);
+    if ((changes & MaskOf(change)) == 0) {
+      continue;
+    }
+    uint32_t sequence = sequenceNumbers[i];
+    if (sequence != sequences[i]) {
+      sequences[i] = sequence;
+      changed |= MaskOf(change);
+    }
+  }
+  return changed;
+}
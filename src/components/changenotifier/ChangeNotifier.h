@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace Pinetime {
+  namespace Controllers {
+    enum class Changes : uint8_t {
+      // The time was set (BLE, settings) or the time zone changed. The passing of time isn't published.
+      Time,
+      Battery,
+      Ble,
+      Notifications,
+      HeartRate,
+      Steps,
+      Weather,
+    };
+
+    // Change-notification bus between the controllers and the display.
+    // The controllers publish a change when the data they expose changes. The subscriber (the display task) is
+    // notified only when one of the changes it subscribed to is published, instead of polling all the controllers.
+    // Each change has a sequence number, incremented at each publication, so that the subscriber can find out which
+    // changes were published since it last looked, even if several publications were coalesced into a single notification.
+    class ChangeNotifier {
+    public:
+      using Mask = uint16_t;
+      static constexpr size_t nbChanges = static_cast<size_t>(Changes::Weather) + 1;
+      using Sequences = std::array<uint32_t, nbChanges>;
+
+      static constexpr Mask MaskOf(Changes change) {
+        return static_cast<Mask>(1U << static_cast<uint8_t>(change));
+      }
+
+      template <typename... Others>
+      static constexpr Mask MaskOf(Changes change, Others... others) {
+        return MaskOf(change) | MaskOf(others...);
+      }
+
+      // Can be called from any task and from interrupts
+      void Publish(Changes change);
+
+      // The listener is called in the context of the publisher when a subscribed change is published.
+      // It's not called again until Acknowledge() is called.
+      void SetListener(std::function<void()> listener);
+      void Subscribe(Mask changes);
+      void Acknowledge();
+
+      // Returns the changes of the mask published since the sequence numbers were updated, and updates them
+      Mask ChangedSince(Sequences& sequences, Mask changes) const;
+
+    private:
+      std::array<std::atomic<uint32_t>, nbChanges> sequenceNumbers {};
+      std::atomic<Mask> subscriptions {0};
+      std::atomic<bool> notificationPending {false};
+      std::function<void()> listener;
+    };
+  }
+}
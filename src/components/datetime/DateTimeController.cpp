@@ -1,4 +1,5 @@
 #include "components/datetime/DateTimeController.h"
+#include <algorithm>
 #include <libraries/log/nrf_log.h>
 #include <systemtask/SystemTask.h>
 #include <hal/nrf_rtc.h>
@@ -12,12 +13,52 @@ namespace {
   char const* DaysStringShortLow[] = {"--", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
   char const* MonthsString[] = {"--", "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
   char const* MonthsStringLow[] = {"--", "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  void SecondTimerCallback(TimerHandle_t xTimer) {
+    auto* dateTime = static_cast<DateTime*>(pvTimerGetTimerID(xTimer));
+    dateTime->OnSecondTimer();
+  }
+
+  // The time zone (TZ) isn't set, so localtime() is the UTC calendar of the local time. It's computed here instead,
+  // as localtime() returns a buffer shared by all the tasks.
+  void BreakDown(std::time_t time, std::tm& tm) {
+    auto days = static_cast<int32_t>(time / 86400);
+    auto secondOfDay = static_cast<int32_t>(time % 86400);
+    if (secondOfDay < 0) {
+      secondOfDay += 86400;
+      days--;
+    }
+    tm.tm_hour = secondOfDay / 3600;
+    tm.tm_min = (secondOfDay / 60) % 60;
+    tm.tm_sec = secondOfDay % 60;
+    // 1970-01-01 was a Thursday
+    tm.tm_wday = (days % 7 + 11) % 7;
+
+    // Civil date from the number of days, in eras of 400 years starting on March 1st
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int32_t dayOfEra = days - era * 146097;
+    int32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int32_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+    int32_t year = yearOfEra + era * 400 + (monthFromMarch >= 10 ? 1 : 0);
+    bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    tm.tm_mday = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+    tm.tm_mon = (monthFromMarch < 10) ? monthFromMarch + 2 : monthFromMarch - 10;
+    tm.tm_year = year - 1900;
+    tm.tm_yday = (monthFromMarch < 10) ? dayOfYear + 59 + (leapYear ? 1 : 0) : dayOfYear - 306;
+    tm.tm_isdst = 0;
+  }
 }
 
-DateTime::DateTime(Controllers::Settings& settingsController) : settingsController {settingsController} {
+DateTime::DateTime(Controllers::Settings& settingsController, Controllers::ChangeNotifier& changeNotifier)
+  : settingsController {settingsController}, changeNotifier {changeNotifier} {
   mutex = xSemaphoreCreateMutex();
   ASSERT(mutex != nullptr);
   xSemaphoreGive(mutex);
+  // Auto-reloaded: if the period can't be changed (the timer command queue is full), it keeps running with the previous one
+  secondTimer = xTimerCreate("DateTime", 1, pdTRUE, this, SecondTimerCallback);
+  ASSERT(secondTimer != nullptr);
 }
 
 void DateTime::SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t) {
@@ -25,6 +66,11 @@ void DateTime::SetCurrentTime(std::chrono::time_point<std::chrono::system_clock,
   this->currentDateTime = t;
   UpdateTime(previousSystickCounter, true); // Update internal state without updating the time
   xSemaphoreGive(mutex);
+  if (sleeping) {
+    // The next half hour has moved
+    RestartSecondTimer();
+  }
+  changeNotifier.Publish(Changes::Time);
 }
 
 void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
@@ -46,6 +92,10 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
   currentDateTime = std::chrono::system_clock::from_time_t(std::mktime(&tm));
   UpdateTime(previousSystickCounter, true);
   xSemaphoreGive(mutex);
+  if (sleeping) {
+    RestartSecondTimer();
+  }
+  changeNotifier.Publish(Changes::Time);
 
   systemTask->PushMessage(System::Messages::OnNewTime);
 }
@@ -53,13 +103,96 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
 void DateTime::SetTimeZone(int8_t timezone, int8_t dst) {
   tzOffset = timezone;
   dstOffset = dst;
+  changeNotifier.Publish(Changes::Time);
+}
+
+DateTime::Snapshot DateTime::LatestSnapshot() const {
+  Snapshot snapshot;
+  uint32_t sequence;
+  do {
+    sequence = snapshotSequence.load(std::memory_order_acquire);
+    snapshot = snapshots[sequence & 1];
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while (snapshotSequence.load(std::memory_order_relaxed) != sequence);
+  return snapshot;
+}
+
+DateTime::Snapshot DateTime::CurrentSnapshot() const {
+  Snapshot snapshot = LatestSnapshot();
+  uint32_t systickCounter = nrf_rtc_counter_get(portNRF_RTC_REG);
+  uint32_t elapsed = ((systickCounter - snapshot.systickCounter) & static_cast<uint32_t>(portNRF_RTC_MAXTICKS)) / configTICK_RATE_HZ;
+  if (elapsed == 0) {
+    return snapshot;
+  }
+
+  // The timer task (lowest priority) hasn't published the current second yet
+  snapshot.systickCounter = (snapshot.systickCounter + elapsed * configTICK_RATE_HZ) & static_cast<uint32_t>(portNRF_RTC_MAXTICKS);
+  snapshot.dateTime += std::chrono::seconds(elapsed);
+  snapshot.uptime += std::chrono::seconds(elapsed);
+  if (snapshot.localTime.tm_sec + elapsed < 60) {
+    snapshot.localTime.tm_sec += elapsed;
+  } else {
+    BreakDown(std::chrono::system_clock::to_time_t(snapshot.dateTime), snapshot.localTime);
+  }
+  return snapshot;
+}
+
+TickType_t DateTime::TicksToNextSecond() const {
+  Snapshot snapshot = CurrentSnapshot();
+  // systickCounter is the tick of the current second
+  uint32_t elapsed = (nrf_rtc_counter_get(portNRF_RTC_REG) - snapshot.systickCounter) & static_cast<uint32_t>(portNRF_RTC_MAXTICKS);
+  return configTICK_RATE_HZ - std::min<uint32_t>(elapsed, configTICK_RATE_HZ - 1);
+}
+
+TickType_t DateTime::TicksToNextMinute() const {
+  TickType_t ticks = TicksToNextSecond();
+  return ticks + (59 - Seconds()) * configTICK_RATE_HZ;
 }
 
-std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> DateTime::CurrentDateTime() {
+// Publishes the snapshot of each second and sends the notifications of the new hour/day, at the beginning of the second.
+// While the system sleeps, nothing needs the snapshot of each second (the readers extrapolate it from the last one):
+// the timer only wakes up at the next half hour, for the notifications.
+void DateTime::OnSecondTimer() {
   xSemaphoreTake(mutex, portMAX_DELAY);
-  UpdateTime(nrf_rtc_counter_get(portNRF_RTC_REG), false);
+  uint32_t systickCounter = nrf_rtc_counter_get(portNRF_RTC_REG);
+  UpdateTime(systickCounter, false);
+  uint32_t elapsed = (systickCounter - previousSystickCounter) & static_cast<uint32_t>(portNRF_RTC_MAXTICKS);
+  uint32_t seconds = 1;
+  if (sleeping) {
+    seconds = (30 - localTime.tm_min % 30) * 60 - localTime.tm_sec;
+  }
   xSemaphoreGive(mutex);
-  return currentDateTime;
+  TickType_t period = seconds * configTICK_RATE_HZ - std::min<uint32_t>(elapsed, configTICK_RATE_HZ - 1);
+  if (xTimerChangePeriod(secondTimer, period, 0) != pdPASS) {
+    NRF_LOG_INFO("[DateTime] Timer command queue full, the period is unchanged");
+  }
+}
+
+void DateTime::OnSystemSleep(bool sleeping) {
+  this->sleeping = sleeping;
+  if (!sleeping) {
+    RestartSecondTimer();
+  }
+}
+
+// The timer runs on the next tick, and re-arms itself for the next second or half hour
+void DateTime::RestartSecondTimer() {
+  if (xTimerChangePeriod(secondTimer, 1, 0) != pdPASS) {
+    NRF_LOG_INFO("[DateTime] Timer command queue full, the period is unchanged");
+  }
+}
+
+void DateTime::PublishSnapshot() {
+  Snapshot snapshot {localTime, currentDateTime, uptime, previousSystickCounter};
+  uint32_t sequence = snapshotSequence.load(std::memory_order_relaxed);
+  // The readers use the second copy while the first one is written, then the first one while the second is written
+  snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  snapshots[0] = snapshot;
+  std::atomic_thread_fence(std::memory_order_release);
+  snapshotSequence.store(sequence + 2, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  snapshots[1] = snapshot;
 }
 
 void DateTime::UpdateTime(uint32_t systickCounter, bool forceUpdate) {
@@ -88,11 +221,11 @@ void DateTime::UpdateTime(uint32_t systickCounter, bool forceUpdate) {
   currentDateTime += std::chrono::seconds(correctedDelta);
   uptime += std::chrono::seconds(correctedDelta);
 
-  std::time_t currentTime = std::chrono::system_clock::to_time_t(currentDateTime);
-  localTime = *std::localtime(&currentTime);
+  BreakDown(std::chrono::system_clock::to_time_t(currentDateTime), localTime);
+  PublishSnapshot();
 
-  auto minute = Minutes();
-  auto hour = Hours();
+  auto minute = localTime.tm_min;
+  auto hour = localTime.tm_hour;
 
   if (minute == 0 && !isHourAlreadyNotified) {
     isHourAlreadyNotified = true;
@@ -140,13 +273,15 @@ const char* DateTime::DayOfWeekShortToStringLow(Days day) {
 
 void DateTime::Register(Pinetime::System::SystemTask* systemTask) {
   this->systemTask = systemTask;
+  OnSecondTimer();
 }
 
 using ClockType = Pinetime::Controllers::Settings::ClockType;
 
 std::string DateTime::FormattedTime() {
-  auto hour = Hours();
-  auto minute = Minutes();
+  auto snapshot = CurrentSnapshot();
+  auto hour = snapshot.localTime.tm_hour;
+  auto minute = snapshot.localTime.tm_min;
   // Return time as a string in 12- or 24-hour format
   char buff[9];
   if (settingsController.GetClockType() == ClockType::H12) {
@@ -174,10 +309,11 @@ int congress_mode_get_current_day(int diff_from_start) {
 
 std::string DateTime::FormattedDate() {
   char buff[16];
-  auto day = Day();
+  auto snapshot = CurrentSnapshot();
+  auto day = snapshot.localTime.tm_mday;
   auto cm = settingsController.GetCongressMode();
   if (cm.enabled) {
-    auto diff_from_start = std::chrono::duration_cast<std::chrono::hours>(CurrentDateTime() - cm.day_0).count();
+    auto diff_from_start = std::chrono::duration_cast<std::chrono::hours>(snapshot.dateTime - cm.day_0).count();
     // if (diff_from_start < 0) diff_from_start--;
     if (congress_mode_get_current_day(diff_from_start) > cm.length) {
       snprintf(buff, sizeof(buff), "Day +%i (%02d.)", congress_mode_get_current_day(diff_from_start) - cm.length, short(day));
@@ -186,9 +322,15 @@ std::string DateTime::FormattedDate() {
     }
     return std::string(buff);
   }
-  auto month = Month();
-  auto year = Year();
+  auto month = snapshot.localTime.tm_mon + 1;
+  auto year = 1900 + snapshot.localTime.tm_year;
   // weekday for mayze
-  snprintf(buff, sizeof(buff), "%04d-%02d-%02d %s", short(year), short(month), short(day), DayOfWeekShortToString());
+  snprintf(buff,
+           sizeof(buff),
+           "%04d-%02d-%02d %s",
+           short(year),
+           short(month),
+           short(day),
+           DaysStringShort[static_cast<uint8_t>(DayOfWeek(snapshot.localTime))]);
   return std::string(buff);
 }
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <chrono>
 #include <ctime>
 #include <string>
 #include "components/settings/Settings.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include <FreeRTOS.h>
 #include <semphr.h>
+#include <timers.h>
 
 namespace Pinetime {
   namespace System {
@@ -16,7 +20,7 @@ namespace Pinetime {
   namespace Controllers {
     class DateTime {
     public:
-      DateTime(Controllers::Settings& settingsController);
+      DateTime(Controllers::Settings& settingsController, Controllers::ChangeNotifier& changeNotifier);
       enum class Days : uint8_t { Unknown, Monday, Tuesday, Wednesday, Thursday, Friday, Saturday, Sunday };
       enum class Months : uint8_t {
         Unknown,
@@ -47,19 +51,33 @@ namespace Pinetime {
        */
       void SetTimeZone(int8_t timezone, int8_t dst);
 
+      // Date and time of the current second, consistent with each other
+      struct Snapshot {
+        std::tm localTime;
+        std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> dateTime;
+        std::chrono::seconds uptime;
+        // Value of the RTC counter (FreeRTOS ticks) at the beginning of the second
+        uint32_t systickCounter;
+      };
+
+      // Lock-free, can be called from any task. The snapshot is published at the beginning of each second by a timer;
+      // if the timer hasn't run yet, the last snapshot is moved forward to the current second.
+      Snapshot CurrentSnapshot() const;
+
+      // Each of these reads the current snapshot: use CurrentSnapshot() to get several fields of the same second
       uint16_t Year() const {
-        return 1900 + localTime.tm_year;
+        return 1900 + CurrentSnapshot().localTime.tm_year;
       }
 
       Months Month() const {
-        return static_cast<Months>(localTime.tm_mon + 1);
+        return static_cast<Months>(CurrentSnapshot().localTime.tm_mon + 1);
       }
 
       uint8_t Day() const {
-        return localTime.tm_mday;
+        return CurrentSnapshot().localTime.tm_mday;
       }
 
-      Days DayOfWeek() const {
+      static Days DayOfWeek(const std::tm& localTime) {
         int daysSinceSunday = localTime.tm_wday;
         if (daysSinceSunday == 0) {
           return Days::Sunday;
@@ -67,20 +85,24 @@ namespace Pinetime {
         return static_cast<Days>(daysSinceSunday);
       }
 
+      Days DayOfWeek() const {
+        return DayOfWeek(CurrentSnapshot().localTime);
+      }
+
       int DayOfYear() const {
-        return localTime.tm_yday + 1;
+        return CurrentSnapshot().localTime.tm_yday + 1;
       }
 
       uint8_t Hours() const {
-        return localTime.tm_hour;
+        return CurrentSnapshot().localTime.tm_hour;
       }
 
       uint8_t Minutes() const {
-        return localTime.tm_min;
+        return CurrentSnapshot().localTime.tm_min;
       }
 
       uint8_t Seconds() const {
-        return localTime.tm_sec;
+        return CurrentSnapshot().localTime.tm_sec;
       }
 
       /*
@@ -124,23 +146,36 @@ namespace Pinetime {
       static const char* MonthShortToStringLow(Months month);
       static const char* DayOfWeekShortToStringLow(Days day);
 
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> CurrentDateTime();
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> CurrentDateTime() const {
+        return CurrentSnapshot().dateTime;
+      }
 
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> UTCDateTime() {
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> UTCDateTime() const {
         return CurrentDateTime() - std::chrono::seconds((tzOffset + dstOffset) * 15 * 60);
       }
 
       std::chrono::seconds Uptime() const {
-        return uptime;
+        return CurrentSnapshot().uptime;
       }
 
+      // Number of ticks before CurrentDateTime() reaches the next second/minute
+      TickType_t TicksToNextSecond() const;
+      TickType_t TicksToNextMinute() const;
+
       void Register(System::SystemTask* systemTask);
       void SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t);
       std::string FormattedTime();
       std::string FormattedDate();
 
+      void OnSecondTimer();
+      // The snapshot is only published once per half hour while the system sleeps
+      void OnSystemSleep(bool sleeping);
+
     private:
       void UpdateTime(uint32_t systickCounter, bool forceUpdate);
+      void PublishSnapshot();
+      void RestartSecondTimer();
+      Snapshot LatestSnapshot() const;
 
       std::tm localTime;
       int8_t tzOffset = 0;
@@ -152,11 +187,20 @@ namespace Pinetime {
       std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> currentDateTime;
       std::chrono::seconds uptime {0};
 
+      // Sequence lock with two copies of the snapshot: the readers use the copy that isn't being written, selected by
+      // the lowest bit of the sequence, and retry if the sequence changed during the copy. A reader never waits for
+      // the writer, even if it preempted it in the middle of an update.
+      std::array<Snapshot, 2> snapshots {};
+      std::atomic<uint32_t> snapshotSequence {0};
+      TimerHandle_t secondTimer = nullptr;
+      std::atomic_bool sleeping {false};
+
       bool isMidnightAlreadyNotified = false;
       bool isHourAlreadyNotified = true;
       bool isHalfHourAlreadyNotified = true;
       System::SystemTask* systemTask = nullptr;
       Controllers::Settings& settingsController;
+      Controllers::ChangeNotifier& changeNotifier;
     };
   }
 }
@@ -1,5 +1,8 @@
 #include "components/fs/FS.h"
+#include "components/fs/ResourceCache.h"
+#include <algorithm>
 #include <cstring>
+#include <libraries/log/nrf_log.h>
 #include <littlefs/lfs.h>
 #include <lvgl/lvgl.h>
 
@@ -13,22 +16,38 @@ FS::FS(Pinetime::Drivers::SpiNorFlash& driver)
       .prog = SectorProg,
       .erase = SectorErase,
       .sync = SectorSync,
+      .lock = LfsLock,
+      .unlock = LfsUnlock,
 
-      .read_size = 16,
-      .prog_size = 8,
+      .read_size = profile.readSize,
+      .prog_size = profile.progSize,
       .block_size = blockSize,
       .block_count = size / blockSize,
       .block_cycles = 1000u,
 
-      .cache_size = 16,
-      .lookahead_size = 16,
+      .cache_size = profile.cacheSize,
+      .lookahead_size = profile.lookaheadSize,
 
       .name_max = 50,
       .attr_max = 50,
     } {
+  mutex = xSemaphoreCreateRecursiveMutex();
+  ASSERT(mutex != nullptr);
+}
+
+void FS::Lock() {
+  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+}
+
+void FS::Unlock() {
+  xSemaphoreGiveRecursive(mutex);
 }
 
 void FS::Init() {
+  NRF_LOG_INFO("[FS] Profile %s: %d bytes + %d bytes per open file",
+               profile.name,
+               static_cast<int>(profile.RamUsage(0)),
+               static_cast<int>(profile.cacheSize));
 
   // try mount
   int err = lfs_mount(&lfs, &lfsConfig);
@@ -54,7 +73,13 @@ void FS::VerifyResource() {
 }
 
 int FS::FileOpen(lfs_file_t* file_p, const char* fileName, const int flags) {
-  return lfs_file_open(&lfs, file_p, fileName, flags);
+  Lock();
+  if ((flags & LFS_O_WRONLY) != 0) {
+    OnModified(fileName);
+  }
+  int res = lfs_file_open(&lfs, file_p, fileName, flags);
+  Unlock();
+  return res;
 }
 
 int FS::FileClose(lfs_file_t* file_p) {
@@ -73,8 +98,16 @@ int FS::FileSeek(lfs_file_t* file_p, uint32_t pos) {
   return lfs_file_seek(&lfs, file_p, pos, LFS_SEEK_SET);
 }
 
+int FS::FileSize(lfs_file_t* file_p) {
+  return lfs_file_size(&lfs, file_p);
+}
+
 int FS::FileDelete(const char* fileName) {
-  return lfs_remove(&lfs, fileName);
+  Lock();
+  OnModified(fileName);
+  int res = lfs_remove(&lfs, fileName);
+  Unlock();
+  return res;
 }
 
 int FS::DirOpen(const char* path, lfs_dir_t* lfs_dir) {
@@ -98,13 +131,116 @@ int FS::DirCreate(const char* path) {
 }
 
 int FS::Rename(const char* oldPath, const char* newPath) {
-  return lfs_rename(&lfs, oldPath, newPath);
+  Lock();
+  OnModified(oldPath);
+  OnModified(newPath);
+  int res = lfs_rename(&lfs, oldPath, newPath);
+  Unlock();
+  return res;
 }
 
 int FS::Stat(const char* path, lfs_info* info) {
   return lfs_stat(&lfs, path, info);
 }
 
+bool FS::OpenResourcePack() {
+  if (resourcePackOpen) {
+    return true;
+  }
+  // Don't look for a missing pack on each lookup
+  if (resourcePackChecked) {
+    return false;
+  }
+  resourcePackChecked = true;
+  if (lfs_file_open(&lfs, &resourcePack, resourcePackPath, LFS_O_RDONLY) < 0) {
+    return false;
+  }
+  ResourcePackHeader header;
+  if (lfs_file_read(&lfs, &resourcePack, &header, sizeof(header)) != sizeof(header) || std::memcmp(header.magic, "ITRP", 4) != 0 ||
+      header.version != 1) {
+    NRF_LOG_INFO("[FS] Invalid resource pack");
+    lfs_file_close(&lfs, &resourcePack);
+    return false;
+  }
+  nbPackedResources = header.count;
+  resourcePackOpen = true;
+  return true;
+}
+
+void FS::OnModified(const char* modifiedPath) {
+  if (std::strcmp(modifiedPath, resourcePackPath) != 0) {
+    if (resourceCache != nullptr) {
+      resourceCache->Invalidate(ResourceCache::Id(modifiedPath));
+    }
+    return;
+  }
+  // The pack is reopened on the next lookup once it has been replaced
+  if (resourcePackOpen) {
+    lfs_file_close(&lfs, &resourcePack);
+    resourcePackOpen = false;
+  }
+  resourcePackChecked = false;
+  resourcePackGeneration++;
+  if (resourceCache != nullptr) {
+    resourceCache->Clear();
+  }
+}
+
+bool FS::FindResource(const char* path, Resource& resource) {
+  // The pack is shared by all the readers, and the NimBLE task can replace it
+  Lock();
+  bool found = false;
+  if (OpenResourcePack()) {
+    // Binary search in the index, one entry is read per step
+    uint16_t low = 0;
+    uint16_t high = nbPackedResources;
+    ResourcePackEntry entry;
+    while (low < high) {
+      uint16_t middle = low + (high - low) / 2;
+      lfs_file_seek(&lfs, &resourcePack, sizeof(ResourcePackHeader) + middle * sizeof(ResourcePackEntry), LFS_SEEK_SET);
+      if (lfs_file_read(&lfs, &resourcePack, &entry, sizeof(entry)) != sizeof(entry)) {
+        break;
+      }
+      int cmp = std::strncmp(path, entry.path, sizeof(entry.path));
+      if (cmp == 0) {
+        resource.offset = entry.offset;
+        resource.length = entry.length;
+        resource.generation = resourcePackGeneration;
+        found = true;
+        break;
+      }
+      if (cmp < 0) {
+        high = middle;
+      } else {
+        low = middle + 1;
+      }
+    }
+  }
+  Unlock();
+  return found;
+}
+
+int FS::ResourceRead(const Resource& resource, uint32_t offset, uint8_t* buffer, uint32_t size) {
+  Lock();
+  int res = 0;
+  if (resourcePackOpen && ResourceValid(resource) && offset < resource.length) {
+    size = std::min(size, resource.length - offset);
+    lfs_file_seek(&lfs, &resourcePack, resource.offset + offset, LFS_SEEK_SET);
+    res = lfs_file_read(&lfs, &resourcePack, buffer, size);
+  }
+  Unlock();
+  return res;
+}
+
+bool FS::ResourceExists(const char* path) {
+  Resource resource;
+  if (FindResource(path, resource)) {
+    return true;
+  }
+  lfs_info info;
+  return Stat(path, &info) == LFS_ERR_OK;
+}
+
 lfs_ssize_t FS::GetFSSize() {
   return lfs_fs_size(&lfs);
 }
@@ -114,6 +250,16 @@ lfs_ssize_t FS::GetFSSize() {
     ----------- Interface between littlefs and SpiNorFlash -----------
 
 */
+int FS::LfsLock(const struct lfs_config* c) {
+  static_cast<Pinetime::Controllers::FS*>(c->context)->Lock();
+  return 0;
+}
+
+int FS::LfsUnlock(const struct lfs_config* c) {
+  static_cast<Pinetime::Controllers::FS*>(c->context)->Unlock();
+  return 0;
+}
+
 int FS::SectorSync(const struct lfs_config* /*c*/) {
   return 0;
 }
@@ -1,22 +1,88 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <FreeRTOS.h>
+#include <semphr.h>
 #include "drivers/SpiNorFlash.h"
 #include <littlefs/lfs.h>
 
 namespace Pinetime {
   namespace Controllers {
+    class ResourceCache;
+
     class FS {
     public:
+      // littlefs reads the flash through caches of cacheSize bytes: one for reads, one for programs and
+      // one per open file. The lookahead bitmap tracks 8 blocks per byte during block allocation.
+      // resourceCacheSize is the size of the block cache of the resources read by LVGL (see ResourceCache).
+      struct Profile {
+        const char* name;
+        lfs_size_t readSize;
+        lfs_size_t progSize;
+        lfs_size_t cacheSize;
+        lfs_size_t lookaheadSize;
+        size_t resourceCacheSize;
+
+        constexpr size_t RamUsage(size_t nbOpenFiles) const {
+          return (2 + nbOpenFiles) * cacheSize + lookaheadSize + resourceCacheSize;
+        }
+      };
+
+      // progSize is the same in all profiles as it defines the padding of the metadata commits on flash
+      static constexpr Profile compactProfile {"Compact", 16, 8, 16, 16, 0};
+      static constexpr Profile balancedProfile {"Balanced", 16, 8, 256, 32, 1024};
+      // The lookahead bitmap covers the whole volume (843 blocks)
+      static constexpr Profile fastProfile {"Fast", 16, 8, 1024, 112, 4096};
+
+#if defined(FS_PROFILE_COMPACT)
+      static constexpr Profile profile = compactProfile;
+#elif defined(FS_PROFILE_FAST)
+      static constexpr Profile profile = fastProfile;
+#else
+      static constexpr Profile profile = balancedProfile;
+#endif
+
+      // Resources packed by generate-package.py in a single file: a header, an index of the resources sorted by
+      // path, then the content of each resource aligned on 4 KiB. All values are little endian.
+      struct ResourcePackHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t count;
+        uint32_t reserved[2];
+      };
+
+      struct ResourcePackEntry {
+        char path[40];
+        uint32_t offset;
+        uint32_t length;
+      };
+
+      struct Resource {
+        uint32_t offset;
+        uint32_t length;
+        // Generation of the pack the resource was found in: the offsets are meaningless once the pack is rewritten
+        uint32_t generation;
+      };
+
+      static constexpr const char* resourcePackPath = "/resources.pack";
+
       FS(Pinetime::Drivers::SpiNorFlash&);
 
       void Init();
 
+      // The file system is used by several tasks. littlefs takes the lock around each operation (LFS_THREADSAFE), a
+      // caller that needs several operations to be atomic (a seek then a read on a shared file) holds it around them.
+      // The lock is recursive.
+      void Lock();
+      void Unlock();
+
       int FileOpen(lfs_file_t* file_p, const char* fileName, const int flags);
       int FileClose(lfs_file_t* file_p);
       int FileRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size);
       int FileWrite(lfs_file_t* file_p, const uint8_t* buff, uint32_t size);
       int FileSeek(lfs_file_t* file_p, uint32_t pos);
+      int FileSize(lfs_file_t* file_p);
 
       int FileDelete(const char* fileName);
 
@@ -31,6 +97,22 @@ namespace Pinetime {
       int Stat(const char* path, lfs_info* info);
       void VerifyResource();
 
+      // Looks for path in the resource pack, which is kept open after the first lookup
+      bool FindResource(const char* path, Resource& resource);
+      // Returns 0 if the pack has been modified since the resource was found
+      int ResourceRead(const Resource& resource, uint32_t offset, uint8_t* buffer, uint32_t size);
+      bool ResourceValid(const Resource& resource) const {
+        return resource.generation == resourcePackGeneration;
+      }
+      // True if the resource is in the pack or is a file
+      bool ResourceExists(const char* path);
+
+      // The blocks of the files written, deleted or renamed are dropped from this cache (all the blocks when the
+      // resource pack is modified)
+      void SetResourceCache(ResourceCache* cache) {
+        resourceCache = cache;
+      }
+
       static size_t getSize() {
         return size;
       }
@@ -68,11 +150,32 @@ namespace Pinetime {
       static constexpr size_t size = 0x34C000;
       static constexpr size_t blockSize = 4096;
 
+      static_assert(blockSize % profile.cacheSize == 0, "The cache size must divide the block size");
+      static_assert(profile.cacheSize % profile.readSize == 0 && profile.cacheSize % profile.progSize == 0,
+                    "The cache size must be a multiple of the read and program sizes");
+      static_assert(profile.lookaheadSize % 8 == 0, "The lookahead size must be a multiple of 8");
+
+      static_assert(sizeof(ResourcePackHeader) == 16, "The resource pack header must be 16 bytes");
+      static_assert(sizeof(ResourcePackEntry) == 48, "A resource pack entry must be 48 bytes");
+
+      bool OpenResourcePack();
+      // Closes the resource pack if it's modifiedPath, and drops the blocks of modifiedPath from the resource cache
+      void OnModified(const char* modifiedPath);
+
       bool resourcesValid = false;
+      lfs_file_t resourcePack;
+      bool resourcePackOpen = false;
+      bool resourcePackChecked = false;
+      uint16_t nbPackedResources = 0;
+      uint32_t resourcePackGeneration = 0;
+      ResourceCache* resourceCache = nullptr;
+      SemaphoreHandle_t mutex = nullptr;
       const struct lfs_config lfsConfig;
 
       lfs_t lfs;
 
+      static int LfsLock(const struct lfs_config* c);
+      static int LfsUnlock(const struct lfs_config* c);
       static int SectorSync(const struct lfs_config* c);
       static int SectorErase(const struct lfs_config* c, lfs_block_t block);
       static int SectorProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size);
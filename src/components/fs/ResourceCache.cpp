@@ -0,0 +1,73 @@
+#include "components/fs/ResourceCache.h"
+
+using namespace Pinetime::Controllers;
+
+uint32_t ResourceCache::Id(const char* path) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  while (*path != '\0') {
+    hash ^= static_cast<uint8_t>(*path++);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+ResourceCache::Entry* ResourceCache::Find(uint32_t id, uint32_t fileLength, uint32_t blockIndex) {
+  for (auto& entry : entries) {
+    if (entry.valid && entry.id == id && entry.fileLength == fileLength && entry.blockIndex == blockIndex) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+ResourceCache::Entry* ResourceCache::Allocate(bool pinned) {
+  Entry* unpinnedVictim = nullptr;
+  Entry* pinnedVictim = nullptr;
+  size_t nbPinned = 0;
+  for (auto& entry : entries) {
+    if (!entry.valid) {
+      return &entry;
+    }
+    if (entry.pinned) {
+      nbPinned++;
+      if (pinnedVictim == nullptr || entry.lastUse < pinnedVictim->lastUse) {
+        pinnedVictim = &entry;
+      }
+    } else if (unpinnedVictim == nullptr || entry.lastUse < unpinnedVictim->lastUse) {
+      unpinnedVictim = &entry;
+    }
+  }
+
+  Entry* victim = unpinnedVictim;
+  if (pinned && nbPinned >= maxPinnedBlocks) {
+    // Pinned files replace their own blocks once they reach their quota
+    victim = pinnedVictim;
+  }
+  if (victim == nullptr) {
+    return nullptr;
+  }
+  statistics.evictions++;
+  victim->valid = false;
+  return victim;
+}
+
+void ResourceCache::UnpinAll() {
+  for (auto& entry : entries) {
+    entry.pinned = false;
+  }
+}
+
+void ResourceCache::Invalidate(uint32_t id) {
+  for (auto& entry : entries) {
+    if (entry.id == id) {
+      entry.valid = false;
+    }
+  }
+}
+
+void ResourceCache::Clear() {
+  for (auto& entry : entries) {
+    entry.valid = false;
+  }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "components/fs/FS.h"
+
+namespace Pinetime {
+  namespace Controllers {
+    // Bounded cache of the resources (fonts, images) read from the external file system.
+    // Files are split in blocks of blockSize bytes, identified by the hash of the path of the file, the length of
+    // the file (two files whose paths have the same hash are unlikely to have the same length) and the index of the
+    // block. The least recently used block is evicted first, except for the blocks of pinned files, which are only
+    // evicted by other pinned blocks.
+    // FS invalidates the blocks of the files it modifies: the cache is used with the FS lock held.
+    class ResourceCache {
+    public:
+      static constexpr size_t blockSize = 256;
+      static constexpr size_t nbBlocks = FS::profile.resourceCacheSize / blockSize;
+      // Pinned files can't use more than this number of blocks, so that other resources can still be cached
+      static constexpr size_t maxPinnedBlocks = nbBlocks / 2;
+
+      struct Statistics {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+        uint32_t bypassed = 0;
+      };
+
+      static uint32_t Id(const char* path);
+
+      // Copies size bytes at offset of the file into buffer. Missing blocks are loaded with
+      // reader(offset, buffer, size), which returns the number of bytes read.
+      template <typename Reader>
+      uint32_t Read(uint32_t id, uint32_t fileLength, bool pinned, uint32_t offset, uint8_t* buffer, uint32_t size, Reader&& reader);
+
+      void UnpinAll();
+      // Drops the blocks of a file, or all the blocks
+      void Invalidate(uint32_t id);
+      void Clear();
+
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      struct Entry {
+        uint32_t id = 0;
+        uint32_t fileLength = 0;
+        uint32_t blockIndex = 0;
+        uint32_t lastUse = 0;
+        uint16_t length = 0;
+        bool valid = false;
+        bool pinned = false;
+      };
+
+      Entry* Find(uint32_t id, uint32_t fileLength, uint32_t blockIndex);
+      Entry* Allocate(bool pinned);
+
+      std::array<Entry, nbBlocks> entries;
+      std::array<std::array<uint8_t, blockSize>, nbBlocks> blocks;
+      uint32_t useCounter = 0;
+      Statistics statistics;
+    };
+
+    template <typename Reader>
+    uint32_t ResourceCache::Read(uint32_t id,
+                                 uint32_t fileLength,
+                                 bool pinned,
+                                 uint32_t offset,
+                                 uint8_t* buffer,
+                                 uint32_t size,
+                                 Reader&& reader) {
+      // Large reads (a whole font bitmap for example) would flush the cache for a single use
+      if (nbBlocks == 0 || size > 2 * blockSize) {
+        statistics.bypassed++;
+        int res = reader(offset, buffer, size);
+        return res > 0 ? res : 0;
+      }
+
+      uint32_t read = 0;
+      while (read < size) {
+        uint32_t position = offset + read;
+        uint32_t blockIndex = position / blockSize;
+        Entry* entry = Find(id, fileLength, blockIndex);
+        if (entry != nullptr) {
+          statistics.hits++;
+        } else {
+          statistics.misses++;
+          entry = Allocate(pinned);
+          if (entry == nullptr) {
+            int res = reader(position, buffer + read, size - read);
+            return read + (res > 0 ? res : 0);
+          }
+          int res = reader(blockIndex * blockSize, blocks[entry - entries.data()].data(), blockSize);
+          if (res <= 0) {
+            return read;
+          }
+          entry->id = id;
+          entry->fileLength = fileLength;
+          entry->blockIndex = blockIndex;
+          entry->length = res;
+          entry->valid = true;
+          entry->pinned = pinned;
+        }
+        entry->lastUse = ++useCounter;
+
+        uint32_t blockOffset = position - (blockIndex * blockSize);
+        if (blockOffset >= entry->length) {
+          // End of file
+          return read;
+        }
+        uint32_t toCopy = std::min<uint32_t>(size - read, entry->length - blockOffset);
+        std::memcpy(buffer + read, blocks[entry - entries.data()].data() + blockOffset, toCopy);
+        read += toCopy;
+      }
+      return read;
+    }
+  }
+}
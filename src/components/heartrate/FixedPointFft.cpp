@@ -0,0 +1,97 @@
+#include "components/heartrate/FixedPointFft.h"
+#include <cmath>
+#include <utility>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr size_t complexLength = FixedPointFft::length / 2;
+
+  // sin(2 * pi * k / 64) in Q15, for k in [0, 48[. cos(2 * pi * k / 64) is sine[k + 16].
+  constexpr int16_t sine[48] {
+    0,      3212,   6393,   9512,   12539,  15446,  18204,  20787,  23170,  25329,  27245,  28898,
+    30273,  31356,  32137,  32609,  32767,  32609,  32137,  31356,  30273,  28898,  27245,  25329,
+    23170,  20787,  18204,  15446,  12539,  9512,   6393,   3212,   0,      -3212,  -6393,  -9512,
+    -12539, -15446, -18204, -20787, -23170, -25329, -27245, -28898, -30273, -31356, -32137, -32609,
+  };
+
+  constexpr int32_t Cosine(size_t k) {
+    return sine[k + 16];
+  }
+
+  constexpr int32_t Sine(size_t k) {
+    return sine[k];
+  }
+
+  // Multiplication of Q15 values with rounding
+  constexpr int32_t MultiplyQ15(int32_t a, int32_t b) {
+    return (a * b + (1 << 14)) >> 15;
+  }
+
+  constexpr size_t ReverseBits5(size_t value) {
+    return ((value & 0x01) << 4) | ((value & 0x02) << 2) | (value & 0x04) | ((value & 0x08) >> 2) | ((value & 0x10) >> 4);
+  }
+}
+
+// In place radix-2 decimation in time FFT of complexLength interleaved (real, imaginary) Q15 values, scaled by 1/complexLength
+void FixedPointFft::ComplexFft(int16_t* data) {
+  static_assert(complexLength == 32, "ReverseBits5() only supports 32 points");
+  for (size_t i = 0; i < complexLength; i++) {
+    size_t j = ReverseBits5(i);
+    if (j > i) {
+      std::swap(data[2 * i], data[2 * j]);
+      std::swap(data[2 * i + 1], data[2 * j + 1]);
+    }
+  }
+
+  for (size_t size = 2; size <= complexLength; size *= 2) {
+    size_t half = size / 2;
+    // Twiddle factors of this stage are exp(-2i * pi * j / size) = W64^(j * step)
+    size_t step = length / size;
+    for (size_t start = 0; start < complexLength; start += size) {
+      for (size_t j = 0; j < half; j++) {
+        int32_t cosine = Cosine(j * step);
+        int32_t sine = Sine(j * step);
+        int16_t* a = data + 2 * (start + j);
+        int16_t* b = data + 2 * (start + j + half);
+        int32_t tReal = MultiplyQ15(b[0], cosine) + MultiplyQ15(b[1], sine);
+        int32_t tImag = MultiplyQ15(b[1], cosine) - MultiplyQ15(b[0], sine);
+        int32_t aReal = a[0];
+        int32_t aImag = a[1];
+        a[0] = static_cast<int16_t>((aReal + tReal) >> 1);
+        a[1] = static_cast<int16_t>((aImag + tImag) >> 1);
+        b[0] = static_cast<int16_t>((aReal - tReal) >> 1);
+        b[1] = static_cast<int16_t>((aImag - tImag) >> 1);
+      }
+    }
+  }
+}
+
+void FixedPointFft::Magnitudes(std::array<int16_t, length>& samples, float* magnitudes) {
+  ComplexFft(samples.data());
+
+  // Split the spectrum Z of the packed signal into the spectrum X of the real signal:
+  // X[k] = E[k] + W64^k * O[k], with E[k] = (Z[k] + conj(Z[32 - k])) / 2 and O[k] = -i * (Z[k] - conj(Z[32 - k])) / 2.
+  // The results keep 1 more bit than Q15, they are only used to compute the magnitudes.
+  for (size_t k = 0; k < spectrumLength; k++) {
+    size_t mirror = (complexLength - k) % complexLength;
+    int32_t zReal = samples[2 * k];
+    int32_t zImag = samples[2 * k + 1];
+    int32_t mirrorReal = samples[2 * mirror];
+    int32_t mirrorImag = -samples[2 * mirror + 1];
+
+    int32_t evenReal = zReal + mirrorReal;
+    int32_t evenImag = zImag + mirrorImag;
+    int32_t oddReal = zImag - mirrorImag;
+    int32_t oddImag = mirrorReal - zReal;
+
+    int32_t cosine = Cosine(k);
+    int32_t sine = Sine(k);
+    int32_t real = evenReal + MultiplyQ15(oddReal, cosine) + MultiplyQ15(oddImag, sine);
+    int32_t imag = evenImag + MultiplyQ15(oddImag, cosine) - MultiplyQ15(oddReal, sine);
+    // real and imag are 2 * X[k]
+    auto realF = static_cast<float>(real);
+    auto imagF = static_cast<float>(imag);
+    magnitudes[k] = std::sqrt(realF * realF + imagF * imagF) * 0.5f / 32768.0f;
+  }
+}
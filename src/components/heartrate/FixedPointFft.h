@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    // FFT of 64 real samples in Q15, for the fixed point heart rate engine of Ppg.
+    // The real input is packed into 32 complex values (even samples as real part, odd samples as imaginary part),
+    // transformed by a radix-2 complex FFT and split into the spectrum of the real signal. Each butterfly stage
+    // divides its output by 2 so that it can't overflow: the magnitudes are those of the spectrum divided by outputScale.
+    // The magnitudes are computed in float from the Q15 spectrum.
+    class FixedPointFft {
+    public:
+      static constexpr size_t length = 64;
+      static constexpr size_t spectrumLength = length / 2;
+      static constexpr float outputScale = static_cast<float>(length / 2);
+
+      // The samples must be in [-0.5, 0.5[ (Q15 values between -16384 and 16383) to leave room for the first stage.
+      // They are overwritten by the intermediate results. Writes the magnitudes of the first spectrumLength bins.
+      static void Magnitudes(std::array<int16_t, length>& samples, float* magnitudes);
+
+    private:
+      static void ComplexFft(int16_t* data);
+    };
+  }
+}
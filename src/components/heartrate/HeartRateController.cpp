@@ -4,17 +4,27 @@
 
 using namespace Pinetime::Controllers;
 
+HeartRateController::HeartRateController(ChangeNotifier& changeNotifier, HeartRateHistory& history)
+  : changeNotifier {changeNotifier}, history {history} {
+}
+
 void HeartRateController::Update(HeartRateController::States newState, uint8_t heartRate) {
+  bool changed = (this->state != newState);
   this->state = newState;
   if (this->heartRate != heartRate) {
     this->heartRate = heartRate;
     service->OnNewHeartRateValue(heartRate);
+    changed = true;
+  }
+  if (changed) {
+    changeNotifier.Publish(Changes::HeartRate);
   }
 }
 
 void HeartRateController::Start() {
   if (task != nullptr) {
     state = States::NotEnoughData;
+    changeNotifier.Publish(Changes::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::StartMeasurement);
   }
 }
@@ -22,6 +32,7 @@ void HeartRateController::Start() {
 void HeartRateController::Stop() {
   if (task != nullptr) {
     state = States::Stopped;
+    changeNotifier.Publish(Changes::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::StopMeasurement);
   }
 }
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <components/ble/HeartRateService.h>
+#include "components/changenotifier/ChangeNotifier.h"
+#include "components/heartrate/HeartRateHistory.h"
 
 namespace Pinetime {
   namespace Applications {
@@ -17,7 +19,7 @@ namespace Pinetime {
     public:
       enum class States { Stopped, NotEnoughData, NoTouch, Running };
 
-      HeartRateController() = default;
+      HeartRateController(ChangeNotifier& changeNotifier, HeartRateHistory& history);
       void Start();
       void Stop();
       void Update(States newState, uint8_t heartRate);
@@ -34,11 +36,17 @@ namespace Pinetime {
 
       void SetService(Pinetime::Controllers::HeartRateService* service);
 
+      HeartRateHistory& History() {
+        return history;
+      }
+
     private:
       Applications::HeartRateTask* task = nullptr;
       States state = States::Stopped;
       uint8_t heartRate = 0;
       Pinetime::Controllers::HeartRateService* service = nullptr;
+      ChangeNotifier& changeNotifier;
+      HeartRateHistory& history;
     };
   }
 }
\ No newline at end of file
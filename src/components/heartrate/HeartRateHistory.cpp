@@ -0,0 +1,134 @@
+#include "components/heartrate/HeartRateHistory.h"
+#include <algorithm>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+#include "nrf_assert.h"
+
+using namespace Pinetime::Controllers;
+
+HeartRateHistory::HeartRateHistory(FS& fs) : fs {fs} {
+  mutex = xSemaphoreCreateMutex();
+  ASSERT(mutex != nullptr);
+}
+
+void HeartRateHistory::Init() {
+  lfs_info info;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (fs.Stat(currentFile, &info) == LFS_ERR_OK) {
+    currentRecords = info.size / recordSize;
+  }
+  xSemaphoreGive(mutex);
+}
+
+void HeartRateHistory::Add(const Record& record) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (pendingCount == pending.size()) {
+    std::move(pending.begin() + 1, pending.end(), pending.begin());
+    pendingCount--;
+  }
+  pending[pendingCount++] = record;
+  xSemaphoreGive(mutex);
+}
+
+void HeartRateHistory::Flush() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  while (pendingCount > 0) {
+    if (currentRecords >= maxRecordsPerFile) {
+      Rotate();
+    }
+
+    size_t count = std::min(pendingCount, maxRecordsPerFile - currentRecords);
+    uint8_t buffer[maxPendingRecords * recordSize];
+    for (size_t i = 0; i < count; i++) {
+      Encode(pending[i], buffer + i * recordSize);
+    }
+
+    lfs_file_t file;
+    if (fs.FileOpen(&file, currentFile, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND) != LFS_ERR_OK) {
+      NRF_LOG_INFO("[HeartRateHistory] Cannot open %s", currentFile);
+      break;
+    }
+    int written = fs.FileWrite(&file, buffer, count * recordSize);
+    fs.FileClose(&file);
+    if (written != static_cast<int>(count * recordSize)) {
+      NRF_LOG_INFO("[HeartRateHistory] Cannot write %s : %d", currentFile, written);
+      break;
+    }
+
+    currentRecords += count;
+    std::move(pending.begin() + count, pending.begin() + pendingCount, pending.begin());
+    pendingCount -= count;
+  }
+  xSemaphoreGive(mutex);
+}
+
+// The current file replaces the previous one, the readers restart from the beginning of the log
+void HeartRateHistory::Rotate() {
+  fs.Rename(currentFile, previousFile);
+  currentRecords = 0;
+  generation++;
+}
+
+size_t HeartRateHistory::Read(Cursor& cursor, Record* records, size_t maxRecords) {
+  static constexpr size_t recordsPerRead = 8;
+  uint8_t buffer[recordsPerRead * recordSize];
+  size_t count = 0;
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (!cursor.valid || cursor.generation != generation) {
+    cursor.generation = generation;
+    cursor.file = 0;
+    cursor.offset = 0;
+    cursor.valid = true;
+  }
+
+  while (count < maxRecords) {
+    lfs_file_t file;
+    bool endOfFile = true;
+    if (fs.FileOpen(&file, files[cursor.file], LFS_O_RDONLY) == LFS_ERR_OK) {
+      fs.FileSeek(&file, cursor.offset);
+      while (count < maxRecords) {
+        size_t toRead = std::min(maxRecords - count, recordsPerRead);
+        int read = fs.FileRead(&file, buffer, toRead * recordSize);
+        if (read < static_cast<int>(recordSize)) {
+          break;
+        }
+        for (size_t i = 0; i < static_cast<size_t>(read) / recordSize; i++) {
+          Record record = Decode(buffer + i * recordSize);
+          cursor.offset += recordSize;
+          if (record.timestamp >= cursor.since) {
+            records[count++] = record;
+          }
+        }
+      }
+      endOfFile = count < maxRecords;
+      fs.FileClose(&file);
+    }
+
+    // The cursor stays at the end of the current file, to get the records added later
+    if (!endOfFile || cursor.file + 1u == files.size()) {
+      break;
+    }
+    cursor.file++;
+    cursor.offset = 0;
+  }
+  xSemaphoreGive(mutex);
+  return count;
+}
+
+void HeartRateHistory::Encode(const Record& record, uint8_t* buffer) {
+  buffer[0] = record.timestamp & 0xff;
+  buffer[1] = (record.timestamp >> 8) & 0xff;
+  buffer[2] = (record.timestamp >> 16) & 0xff;
+  buffer[3] = (record.timestamp >> 24) & 0xff;
+  buffer[4] = record.bpm;
+  buffer[5] = static_cast<uint8_t>(record.source);
+}
+
+HeartRateHistory::Record HeartRateHistory::Decode(const uint8_t* buffer) {
+  Record record;
+  record.timestamp = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<uint32_t>(buffer[3]) << 24);
+  record.bpm = buffer[4];
+  record.source = static_cast<Sources>(buffer[5]);
+  return record;
+}
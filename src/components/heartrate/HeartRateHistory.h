@@ -0,0 +1,72 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+
+    // Append-only log of the heart rate measurements, in two files of at most maxRecordsPerFile records: when the
+    // current file is full, it replaces the previous one. The SPI flash is powered down while the system sleeps, so
+    // Add() only queues the records in RAM and SystemTask writes them with Flush() once the flash is awake.
+    class HeartRateHistory {
+    public:
+      enum class Sources : uint8_t { Background, Measurement };
+
+      struct Record {
+        uint32_t timestamp; // UTC, seconds since the epoch
+        uint8_t bpm;
+        Sources source;
+      };
+
+      // On flash and over BLE, little endian: timestamp (4 bytes), bpm (1 byte), source (1 byte)
+      static constexpr size_t recordSize = 6;
+      // One 4 KiB block per file: about 9 days of history with a measurement every 10 minutes
+      static constexpr size_t maxRecordsPerFile = 680;
+
+      // Position of a reader in the log. A rotation invalidates it: the reader then restarts from the oldest
+      // record, skipping the records older than since.
+      struct Cursor {
+        uint32_t since = 0;
+        uint32_t generation = 0;
+        uint8_t file = 0;
+        uint32_t offset = 0;
+        bool valid = false;
+      };
+
+      explicit HeartRateHistory(FS& fs);
+
+      void Init();
+
+      // Drops the oldest pending record if the flash hasn't been written for maxPendingRecords records
+      void Add(const Record& record);
+      // The SPI flash must be awake
+      void Flush();
+
+      // Reads up to maxRecords records after the cursor, returns the number of records read (0 at the end of the log)
+      size_t Read(Cursor& cursor, Record* records, size_t maxRecords);
+
+      static void Encode(const Record& record, uint8_t* buffer);
+      static Record Decode(const uint8_t* buffer);
+
+    private:
+      void Rotate();
+
+      static constexpr const char* previousFile = "/heartrate.old.dat";
+      static constexpr const char* currentFile = "/heartrate.dat";
+      static constexpr std::array<const char*, 2> files {previousFile, currentFile};
+      static constexpr size_t maxPendingRecords = 8;
+
+      FS& fs;
+      SemaphoreHandle_t mutex = nullptr;
+      std::array<Record, maxPendingRecords> pending;
+      size_t pendingCount = 0;
+      size_t currentRecords = 0;
+      uint32_t generation = 0;
+    };
+  }
+}
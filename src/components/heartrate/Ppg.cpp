@@ -1,10 +1,13 @@
 #include "components/heartrate/Ppg.h"
 #include <nrf_log.h>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 using namespace Pinetime::Controllers;
 
 namespace {
+#if !defined(HEART_RATE_ENGINE_FIXED_POINT)
   float LinearInterpolation(const float* xValues, const float* yValues, int length, float pointX) {
     if (pointX > xValues[length - 1]) {
       return yValues[length - 1];
@@ -58,6 +61,51 @@ namespace {
     }
     return peakCenter;
   }
+#else
+  // Same peak detection as PeakSearch() on the spectrum linearly interpolated between the bins, without walking it: the
+  // threshold crossings are computed on each segment. A peak is only counted if it starts and ends inside [start, end].
+  // The peak location is refined by parabolic interpolation around the highest bin of the peak.
+  float ThresholdPeakSearch(const float* spectrum, float threshold, float& width, int start, int end) {
+    int peaks = 0;
+    bool inPeak = false;
+    float minBin = 0.0f;
+    int maxIndex = start;
+    float peakCenter = 0.0f;
+    for (int idx = start; idx < end; idx++) {
+      float value = spectrum[idx];
+      float nextValue = spectrum[idx + 1];
+      if (inPeak && value > spectrum[maxIndex]) {
+        maxIndex = idx;
+      }
+      if (value < threshold && nextValue >= threshold) {
+        inPeak = true;
+        minBin = static_cast<float>(idx) + (threshold - value) / (nextValue - value);
+        maxIndex = idx + 1;
+      } else if (value >= threshold && nextValue < threshold) {
+        if (inPeak) {
+          float maxBin = static_cast<float>(idx) + (value - threshold) / (value - nextValue);
+          peaks++;
+          width = maxBin - minBin;
+          // maxIndex is inside ]start, end[: both neighbours are in the spectrum
+          float left = spectrum[maxIndex - 1];
+          float center = spectrum[maxIndex];
+          float right = spectrum[maxIndex + 1];
+          float curvature = left - 2.0f * center + right;
+          peakCenter = static_cast<float>(maxIndex);
+          if (curvature < 0.0f) {
+            peakCenter += 0.5f * (left - right) / curvature;
+          }
+        }
+        inPeak = false;
+      }
+    }
+    if (peaks != 1) {
+      width = 0.0f;
+      peakCenter = 0.0f;
+    }
+    return peakCenter;
+  }
+#endif
 
   float SpectrumMean(const std::array<float, Ppg::spectrumLength>& signal, int start, int end) {
     int total = 0;
@@ -187,7 +235,9 @@ int Ppg::ProcessHeartRate(bool init) {
   std::copy(dataHRS.begin(), dataHRS.end(), vReal.begin());
   Detrend(vReal);
   Filter30to240(vReal);
+#if !defined(HEART_RATE_ENGINE_FIXED_POINT)
   vImag.fill(0.0f);
+#endif
   // Apply Hanning Window
   int hannIdx = 0;
   for (int idx = 0; idx < dataLength; idx++) {
@@ -200,10 +250,27 @@ int Ppg::ProcessHeartRate(bool init) {
     }
   }
   // Compute in place power spectrum
+#if defined(HEART_RATE_ENGINE_FIXED_POINT)
+  // Scale the signal to half the Q15 range, and the magnitudes back so that they can be compared with the same thresholds
+  float maxAbs = 0.0f;
+  for (float value : vReal) {
+    maxAbs = std::max(maxAbs, std::abs(value));
+  }
+  float gain = maxAbs > 0.0f ? 16383.0f / maxAbs : 1.0f;
+  for (int idx = 0; idx < dataLength; idx++) {
+    fftData[idx] = static_cast<int16_t>(vReal[idx] * gain);
+  }
+  FixedPointFft::Magnitudes(fftData, vReal.data());
+  float magnitudeScale = FixedPointFft::outputScale * 32768.0f / gain;
+  for (int idx = 0; idx < spectrumLength; idx++) {
+    vReal[idx] *= magnitudeScale;
+  }
+#else
   ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
   FFT.compute(FFTDirection::Forward);
   FFT.complexToMagnitude();
   FFT.~ArduinoFFT();
+#endif
   SpectrumAverage(vReal.data(), spectrum.data(), spectrum.size(), init);
   peakLocation = 0.0f;
   float threshold = peakDetectionThreshold;
@@ -213,6 +280,9 @@ int Ppg::ProcessHeartRate(bool init) {
   float signalToNoiseRatio = SignalToNoise(spectrum, hrROIbegin, hrROIend, max);
   if (signalToNoiseRatio > signalToNoiseThreshold && spectrum.at(0) < dcThreshold) {
     threshold *= max;
+#if defined(HEART_RATE_ENGINE_FIXED_POINT)
+    peakLocation = ThresholdPeakSearch(spectrum.data(), threshold, peakWidth, hrROIbegin, std::min<int>(hrROIend, specLen - 1));
+#else
     // Reuse VImag for interpolation x values passed to PeakSearch
     for (int idx = 0; idx < dataLength; idx++) {
       vImag[idx] = idx;
@@ -224,6 +294,7 @@ int Ppg::ProcessHeartRate(bool init) {
                               static_cast<float>(hrROIbegin),
                               static_cast<float>(hrROIend),
                               specLen);
+#endif
     peakLocation *= freqResolution;
   }
   // Peak too wide? (broad spectrum noise or large, rapid HR change)
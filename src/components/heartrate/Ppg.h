@@ -3,11 +3,20 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
-// Note: Change internal define 'sqrt_internal sqrt' to
-// 'sqrt_internal sqrtf' to save ~3KB of flash.
-#define sqrt_internal sqrtf
-#define FFT_SPEED_OVER_PRECISION
-#include "libs/arduinoFFT/src/arduinoFFT.h"
+// The heart rate engine is selected at build time (HEART_RATE_ENGINE in CMake):
+//  - Float: ArduinoFFT<float> and a peak search that walks the interpolated spectrum in 0.01 bin steps.
+//  - FixedPoint: Q15 FFT of the real signal (FixedPointFft) and a peak search that computes the threshold
+//    crossings and the peak location (parabolic interpolation) in closed form. Only the FFT is computed in fixed point:
+//    the detrending, the filters, the Hann window, the magnitudes and the peak search use float like the Float engine.
+#if defined(HEART_RATE_ENGINE_FIXED_POINT)
+  #include "components/heartrate/FixedPointFft.h"
+#else
+  // Note: Change internal define 'sqrt_internal sqrt' to
+  // 'sqrt_internal sqrtf' to save ~3KB of flash.
+  #define sqrt_internal sqrtf
+  #define FFT_SPEED_OVER_PRECISION
+  #include "libs/arduinoFFT/src/arduinoFFT.h"
+#endif
 
 namespace Pinetime {
   namespace Controllers {
@@ -56,8 +65,14 @@ namespace Pinetime {
       std::array<uint16_t, dataLength> dataHRS;
       // Stores Real numbers from FFT
       std::array<float, dataLength> vReal;
+#if defined(HEART_RATE_ENGINE_FIXED_POINT)
+      static_assert(dataLength == FixedPointFft::length);
+      // Q15 input and intermediate results of the FFT
+      std::array<int16_t, dataLength> fftData;
+#else
       // Stores Imaginary numbers from FFT
       std::array<float, dataLength> vImag;
+#endif
       // Stores power spectrum calculated from FFT real and imag values
       std::array<float, (spectrumLength)> spectrum;
       // Stores each new HR value (Hz). Non zero values are averaged for HR output
@@ -0,0 +1,63 @@
+#include "components/lz/LzDecoder.h"
+
+using namespace Pinetime::Tools;
+
+bool LzDecoder::ReadHeader(const uint8_t* data, size_t size, uint32_t& decodedSize) {
+  if (size < headerSize || data[0] != 'I' || data[1] != 'T' || data[2] != 'L' || data[3] != 'Z') {
+    return false;
+  }
+  decodedSize = data[4] + (data[5] << 8) + (data[6] << 16) + (static_cast<uint32_t>(data[7]) << 24);
+  return true;
+}
+
+void LzDecoder::Reset() {
+  decoded = 0;
+  control = 0;
+  remainingTokens = 0;
+  hasMatchLow = false;
+  copyLength = 0;
+  error = false;
+}
+
+size_t LzDecoder::Decode(const uint8_t* input, size_t inputSize, size_t& consumed, uint8_t* output, size_t outputSize) {
+  size_t inputIndex = 0;
+  size_t outputIndex = 0;
+
+  while (outputIndex < outputSize && !error) {
+    uint8_t value;
+    if (copyLength > 0) {
+      value = window[(decoded - copyDistance) & distanceMask];
+      copyLength--;
+    } else if (inputIndex == inputSize) {
+      break;
+    } else if (remainingTokens == 0) {
+      control = input[inputIndex++];
+      remainingTokens = 8;
+      continue;
+    } else if ((control & 0x01) != 0) {
+      value = input[inputIndex++];
+      control >>= 1;
+      remainingTokens--;
+    } else if (!hasMatchLow) {
+      matchLow = input[inputIndex++];
+      hasMatchLow = true;
+      continue;
+    } else {
+      uint16_t match = matchLow + (input[inputIndex++] << 8);
+      hasMatchLow = false;
+      control >>= 1;
+      remainingTokens--;
+      copyDistance = (match & distanceMask) + 1;
+      copyLength = (match >> 11) + minMatch;
+      error = (copyDistance > decoded);
+      continue;
+    }
+
+    window[decoded & distanceMask] = value;
+    output[outputIndex++] = value;
+    decoded++;
+  }
+
+  consumed = inputIndex;
+  return outputIndex;
+}
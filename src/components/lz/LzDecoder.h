@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Tools {
+    /* Streaming decoder of the compressed firmware images (LZSS with a window of 2 KiB), generated by
+     * tools/dfu_compress.py. The image starts with a header (magic "ITLZ", size of the decoded image): check it with
+     * ReadHeader(), then provide the data following the header to Decode(), in chunks of any size.
+     *
+     * The image is made of groups of 8 tokens, each group starting with a control byte. The bit i (LSB first) of the
+     * control byte is the type of the token i: 1 for a literal (1 byte), 0 for a match (2 bytes, little endian), which
+     * copies (value >> 11) + 3 bytes from (value & 0x7ff) + 1 bytes before in the decoded data.
+     */
+    class LzDecoder {
+    public:
+      static constexpr size_t headerSize = 8;
+      static constexpr size_t windowSize = 2048;
+
+      // Returns true if the data starts with the header of a compressed image
+      static bool ReadHeader(const uint8_t* data, size_t size, uint32_t& decodedSize);
+
+      void Reset();
+
+      // Decodes at most outputSize bytes. Returns the number of bytes written to output, and sets consumed to the
+      // number of bytes of input that were used: the rest of the input must be provided again in the next call.
+      size_t Decode(const uint8_t* input, size_t inputSize, size_t& consumed, uint8_t* output, size_t outputSize);
+
+      // A match refers to data before the beginning of the image
+      bool HasError() const {
+        return error;
+      }
+
+    private:
+      static constexpr uint8_t minMatch = 3;
+      static constexpr uint16_t distanceMask = windowSize - 1;
+
+      std::array<uint8_t, windowSize> window;
+      uint32_t decoded = 0;
+      uint8_t control = 0;
+      uint8_t remainingTokens = 0;
+      // First byte of a match split between two chunks of input
+      uint8_t matchLow = 0;
+      bool hasMatchLow = false;
+      uint16_t copyDistance = 0;
+      uint8_t copyLength = 0;
+      bool error = false;
+    };
+  }
+}
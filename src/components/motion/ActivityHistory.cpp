@@ -0,0 +1,235 @@
+#include "components/motion/ActivityHistory.h"
+#include <algorithm>
+#include <cstdio>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+#include "nrf_assert.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr const char* directory = "/activity";
+  // Unit of the intensity, in 1/1024 g
+  constexpr uint32_t intensityScale = 4;
+  constexpr size_t recordsPerRead = 32;
+
+  void Put32(uint32_t value, uint8_t* buffer) {
+    buffer[0] = value & 0xff;
+    buffer[1] = (value >> 8) & 0xff;
+    buffer[2] = (value >> 16) & 0xff;
+    buffer[3] = (value >> 24) & 0xff;
+  }
+
+  uint32_t Get32(const uint8_t* buffer) {
+    return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<uint32_t>(buffer[3]) << 24);
+  }
+
+  // 0 means that there were no samples during the interval
+  uint8_t Intensity(uint32_t activity, uint32_t nbSamples) {
+    if (nbSamples == 0) {
+      return 0;
+    }
+    return static_cast<uint8_t>(std::clamp<uint32_t>(activity / nbSamples / intensityScale, 1, 255));
+  }
+}
+
+ActivityHistory::ActivityHistory(FS& fs) : fs {fs} {
+  mutex = xSemaphoreCreateMutex();
+  ASSERT(mutex != nullptr);
+}
+
+void ActivityHistory::Init() {
+  // Fails if the directory already exists
+  fs.DirCreate(directory);
+}
+
+void ActivityHistory::Update(uint32_t timestamp, uint32_t nbSteps, uint32_t activity, size_t nbSamples) {
+  uint32_t index = timestamp / intervalDuration;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (!started) {
+    started = true;
+    currentIndex = index;
+    lastNbSteps = nbSteps;
+  }
+
+  // The steps are read at least once per interval (see IntervalEnded()): those read at the beginning of a new interval
+  // were mostly taken during the previous one. The step counter of the motion sensor is reset every day.
+  currentSteps += (nbSteps >= lastNbSteps) ? nbSteps - lastNbSteps : nbSteps;
+  lastNbSteps = nbSteps;
+  currentActivity += activity;
+  currentSamples += nbSamples;
+
+  if (index != currentIndex) {
+    EndCurrentInterval();
+    currentIndex = index;
+  }
+  xSemaphoreGive(mutex);
+}
+
+bool ActivityHistory::IntervalEnded(uint32_t timestamp) const {
+  return started && timestamp / intervalDuration != currentIndex;
+}
+
+// Intervals without any activity are not recorded: the records of a new day are initialized to 0
+void ActivityHistory::EndCurrentInterval() {
+  if (currentSteps > 0 || currentSamples > 0) {
+    if (pendingCount == pending.size()) {
+      NRF_LOG_INFO("[ActivityHistory] Too many pending intervals, dropping %lu", pending[0].index);
+      std::move(pending.begin() + 1, pending.end(), pending.begin());
+      pendingCount--;
+    }
+    pending[pendingCount++] = {currentIndex,
+                               static_cast<uint16_t>(std::min<uint32_t>(currentSteps, UINT16_MAX)),
+                               Intensity(currentActivity, currentSamples)};
+  }
+  currentSteps = 0;
+  currentActivity = 0;
+  currentSamples = 0;
+}
+
+bool ActivityHistory::MustFlush(bool flashSleeping) const {
+  if (pendingCount == 0) {
+    return false;
+  }
+  if (pendingCount >= maxPendingIntervals / 2) {
+    return true;
+  }
+  return !flashSleeping && xTaskGetTickCount() - lastFlushTime >= flushPeriod;
+}
+
+void ActivityHistory::Flush() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  lfs_file_t file;
+  bool fileOpen = false;
+  uint32_t fileDay = 0;
+  size_t written = 0;
+  for (; written < pendingCount; written++) {
+    const auto& interval = pending[written];
+    uint32_t day = interval.index / intervalsPerDay;
+    if (!fileOpen || day != fileDay) {
+      if (fileOpen) {
+        fs.FileClose(&file);
+      }
+      fileOpen = OpenDay(file, day, true);
+      fileDay = day;
+      if (!fileOpen) {
+        break;
+      }
+    }
+
+    uint8_t record[recordSize] = {static_cast<uint8_t>(interval.steps & 0xff),
+                                  static_cast<uint8_t>(interval.steps >> 8),
+                                  interval.intensity};
+    fs.FileSeek(&file, headerSize + (interval.index % intervalsPerDay) * recordSize);
+    if (fs.FileWrite(&file, record, recordSize) != static_cast<int>(recordSize)) {
+      break;
+    }
+  }
+  if (fileOpen) {
+    fs.FileClose(&file);
+  }
+  if (written < pendingCount) {
+    NRF_LOG_INFO("[ActivityHistory] Cannot write the interval %lu", pending[written].index);
+  }
+
+  std::move(pending.begin() + written, pending.begin() + pendingCount, pending.begin());
+  pendingCount -= written;
+  lastFlushTime = xTaskGetTickCount();
+  xSemaphoreGive(mutex);
+}
+
+void ActivityHistory::Query(uint32_t from, size_t intervalsPerBucket, Summary* buckets, size_t nbBuckets) {
+  std::fill(buckets, buckets + nbBuckets, Summary {0, 0});
+  uint32_t firstInterval = from / intervalDuration;
+  uint32_t endInterval = firstInterval + intervalsPerBucket * nbBuckets;
+  uint8_t buffer[recordsPerRead * recordSize];
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (uint32_t index = firstInterval; index < endInterval;) {
+    uint32_t day = index / intervalsPerDay;
+    uint32_t dayEnd = std::min<uint32_t>(endInterval, (day + 1) * intervalsPerDay);
+    lfs_file_t file;
+    if (OpenDay(file, day, false)) {
+      fs.FileSeek(&file, headerSize + (index % intervalsPerDay) * recordSize);
+      while (index < dayEnd) {
+        size_t count = std::min<size_t>(dayEnd - index, recordsPerRead);
+        if (fs.FileRead(&file, buffer, count * recordSize) != static_cast<int>(count * recordSize)) {
+          break;
+        }
+        for (size_t i = 0; i < count; i++) {
+          const uint8_t* record = buffer + i * recordSize;
+          Interval interval {static_cast<uint32_t>(index + i), static_cast<uint16_t>(record[0] | (record[1] << 8)), record[2]};
+          AddToBuckets(interval, firstInterval, intervalsPerBucket, buckets, nbBuckets);
+        }
+        index += count;
+      }
+      fs.FileClose(&file);
+    }
+    index = dayEnd;
+  }
+
+  for (size_t i = 0; i < pendingCount; i++) {
+    AddToBuckets(pending[i], firstInterval, intervalsPerBucket, buckets, nbBuckets);
+  }
+  if (started) {
+    Interval current {currentIndex,
+                      static_cast<uint16_t>(std::min<uint32_t>(currentSteps, UINT16_MAX)),
+                      Intensity(currentActivity, currentSamples)};
+    AddToBuckets(current, firstInterval, intervalsPerBucket, buckets, nbBuckets);
+  }
+  xSemaphoreGive(mutex);
+}
+
+void ActivityHistory::AddToBuckets(const Interval& interval,
+                                   uint32_t firstInterval,
+                                   size_t intervalsPerBucket,
+                                   Summary* buckets,
+                                   size_t nbBuckets) {
+  if (interval.index < firstInterval) {
+    return;
+  }
+  size_t bucket = (interval.index - firstInterval) / intervalsPerBucket;
+  if (bucket >= nbBuckets) {
+    return;
+  }
+  buckets[bucket].steps += interval.steps;
+  buckets[bucket].intensity = std::max(buckets[bucket].intensity, interval.intensity);
+}
+
+// Opens the file of the day. If create is set, a file that doesn't exist or contains a day that is more than
+// maxDays days old is (re)initialized for this day. Otherwise, the file must contain this day.
+bool ActivityHistory::OpenDay(lfs_file_t& file, uint32_t day, bool create) {
+  char path[24];
+  DayPath(day, path);
+  if (fs.FileOpen(&file, path, create ? LFS_O_RDWR | LFS_O_CREAT : LFS_O_RDONLY) != LFS_ERR_OK) {
+    return false;
+  }
+
+  uint8_t buffer[recordsPerRead * recordSize] = {};
+  if (fs.FileRead(&file, buffer, headerSize) == static_cast<int>(headerSize) && Get32(buffer) == day) {
+    return true;
+  }
+  if (!create) {
+    fs.FileClose(&file);
+    return false;
+  }
+
+  // All the day files have the same size: overwriting the whole file is enough
+  fs.FileSeek(&file, 0);
+  Put32(day, buffer);
+  bool success = fs.FileWrite(&file, buffer, headerSize) == static_cast<int>(headerSize);
+  std::fill(buffer, buffer + headerSize, 0);
+  for (size_t size = dayFileSize - headerSize; success && size > 0;) {
+    size_t chunk = std::min(size, sizeof(buffer));
+    success = fs.FileWrite(&file, buffer, chunk) == static_cast<int>(chunk);
+    size -= chunk;
+  }
+  if (!success) {
+    fs.FileClose(&file);
+  }
+  return success;
+}
+
+void ActivityHistory::DayPath(uint32_t day, char* path) {
+  snprintf(path, 24, "%s/%02lu.dat", directory, static_cast<unsigned long>(day % maxDays));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <littlefs/lfs.h>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+
+    // Steps and activity intensity per interval of 15 minutes (UTC), for the last maxDays days.
+    // Each day is a file of fixed size records in /activity, reused maxDays days later: the record of an interval is
+    // at a computed offset, reads and writes never scan the files. The intervals are kept in RAM until SystemTask
+    // writes them with Flush(), at most every flushPeriod while the system is running.
+    class ActivityHistory {
+    public:
+      static constexpr uint32_t intervalDuration = 15 * 60; // seconds
+      static constexpr size_t intervalsPerDay = 24 * 60 * 60 / intervalDuration;
+      static constexpr size_t maxDays = 32;
+      static constexpr TickType_t flushPeriod = pdMS_TO_TICKS(5 * 60 * 1000);
+
+      struct Summary {
+        uint32_t steps;
+        // Highest intensity of the intervals: mean variation of the acceleration between two samples at 50 Hz,
+        // in units of 4/1024 g (0 = no samples)
+        uint8_t intensity;
+      };
+
+      explicit ActivityHistory(FS& fs);
+
+      void Init();
+
+      // nbSteps is the step counter of the motion sensor (it can be reset), activity the sum of the variations of the
+      // acceleration over the nbSamples last samples (in 1/1024 g)
+      void Update(uint32_t timestamp, uint32_t nbSteps, uint32_t activity, size_t nbSamples);
+      // True if the interval of the last Update() is over: the step counter should be read, even if there are no
+      // samples, so that the steps are counted in the right interval
+      bool IntervalEnded(uint32_t timestamp) const;
+
+      // True if the intervals kept in RAM should be written now. While the SPI flash sleeps, they are only written
+      // when the RAM buffer is half full.
+      bool MustFlush(bool flashSleeping) const;
+      // The SPI flash must be awake
+      void Flush();
+
+      // Sums the intervals by buckets of intervalsPerBucket intervals, starting from the interval of from (UTC), including
+      // the intervals that are still in RAM. Each interval is read only once: "the last 7 days per hour" reads 672 records.
+      void Query(uint32_t from, size_t intervalsPerBucket, Summary* buckets, size_t nbBuckets);
+
+    private:
+      // A day file: the day number (uint32_t, days since the epoch), then intervalsPerDay records of recordSize bytes:
+      // steps during the interval (uint16_t) and intensity (uint8_t), little endian. Intervals without activity are 0.
+      static constexpr size_t headerSize = 4;
+      static constexpr size_t recordSize = 3;
+      static constexpr size_t dayFileSize = headerSize + intervalsPerDay * recordSize;
+      static constexpr size_t maxPendingIntervals = 16;
+
+      struct Interval {
+        uint32_t index; // Number of intervals since the epoch
+        uint16_t steps;
+        uint8_t intensity;
+      };
+
+      void EndCurrentInterval();
+      bool OpenDay(lfs_file_t& file, uint32_t day, bool create);
+      static void DayPath(uint32_t day, char* path);
+      static void AddToBuckets(const Interval& interval,
+                               uint32_t firstInterval,
+                               size_t intervalsPerBucket,
+                               Summary* buckets,
+                               size_t nbBuckets);
+
+      FS& fs;
+      SemaphoreHandle_t mutex = nullptr;
+
+      bool started = false;
+      uint32_t lastNbSteps = 0;
+      uint32_t currentIndex = 0;
+      uint32_t currentSteps = 0;
+      uint32_t currentActivity = 0;
+      uint32_t currentSamples = 0;
+
+      std::array<Interval, maxPendingIntervals> pending;
+      size_t pendingCount = 0;
+      TickType_t lastFlushTime = 0;
+    };
+  }
+}
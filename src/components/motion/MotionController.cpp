@@ -1,5 +1,7 @@
 #include "components/motion/MotionController.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <task.h>
 
 #include "utility/Math.h"
@@ -35,32 +37,69 @@ namespace {
   }
 }
 
-void MotionController::Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps) {
+MotionController::MotionController(ChangeNotifier& changeNotifier, ActivityHistory& history)
+  : changeNotifier {changeNotifier}, history {history} {
+}
+
+void MotionController::Update(const Drivers::Bma421::Sample* samples, size_t nbSamples, TickType_t time, uint32_t nbSteps) {
   if (this->nbSteps != nbSteps && service != nullptr) {
     service->OnNewStepCountValue(nbSteps);
   }
 
-  if (service != nullptr && (xHistory[0] != x || yHistory[0] != y || zHistory[0] != z)) {
-    service->OnNewMotionValues(x, y, z);
+  raiseWake = false;
+  lowerSleep = false;
+  peakShakeSpeed = 0;
+  activity = 0;
+  constexpr TickType_t samplePeriod = configTICK_RATE_HZ / Drivers::Bma421::fifoSampleRate;
+  // time is the time of the last sample. The batches read back to back when the FIFO is drained get the same time:
+  // the samples of a batch then follow those of the previous batch, so that the time always increases.
+  TickType_t firstSampleTime = time - (nbSamples - 1) * samplePeriod;
+  if (nbSamples > 0 && static_cast<int32_t>(firstSampleTime - lastSampleTime) <= 0) {
+    firstSampleTime = lastSampleTime + samplePeriod;
+  }
+  for (size_t i = 0; i < nbSamples; i++) {
+    activity += std::abs(samples[i].x - previousSample.x) + std::abs(samples[i].y - previousSample.y) +
+                std::abs(samples[i].z - previousSample.z);
+    previousSample = samples[i];
+    lastSampleTime = firstSampleTime + i * samplePeriod;
+
+    if (++decimationCounter < historyDecimation) {
+      continue;
+    }
+    decimationCounter = 0;
+    UpdateHistory(samples[i], lastSampleTime);
+    UpdateShakeSpeed();
+    raiseWake |= DetectRaise();
+    lowerSleep |= DetectLower();
+    peakShakeSpeed = std::max(peakShakeSpeed, accumulatedSpeed);
+  }
+
+  int32_t deltaSteps = nbSteps - this->nbSteps;
+  if (deltaSteps > 0) {
+    currentTripSteps += deltaSteps;
+  }
+  this->nbSteps = nbSteps;
+  if (deltaSteps != 0) {
+    changeNotifier.Publish(Changes::Steps);
+  }
+}
+
+void MotionController::UpdateHistory(const Drivers::Bma421::Sample& sample, TickType_t sampleTime) {
+  if (service != nullptr && (xHistory[0] != sample.x || yHistory[0] != sample.y || zHistory[0] != sample.z)) {
+    service->OnNewMotionValues(sample.x, sample.y, sample.z);
   }
 
   lastTime = time;
-  time = xTaskGetTickCount();
+  time = sampleTime;
 
   xHistory++;
-  xHistory[0] = x;
+  xHistory[0] = sample.x;
   yHistory++;
-  yHistory[0] = y;
+  yHistory[0] = sample.y;
   zHistory++;
-  zHistory[0] = z;
+  zHistory[0] = sample.z;
 
   stats = GetAccelStats();
-
-  int32_t deltaSteps = nbSteps - this->nbSteps;
-  if (deltaSteps > 0) {
-    currentTripSteps += deltaSteps;
-  }
-  this->nbSteps = nbSteps;
 }
 
 MotionController::AccelStats MotionController::GetAccelStats() const {
@@ -94,6 +133,18 @@ MotionController::AccelStats MotionController::GetAccelStats() const {
 }
 
 bool MotionController::ShouldRaiseWake() const {
+  return raiseWake;
+}
+
+bool MotionController::ShouldShakeWake(uint16_t thresh) const {
+  return peakShakeSpeed > thresh;
+}
+
+bool MotionController::ShouldLowerSleep() const {
+  return lowerSleep;
+}
+
+bool MotionController::DetectRaise() const {
   constexpr uint32_t varianceThresh = 56 * 56;
   constexpr int16_t xThresh = 384;
   constexpr int16_t yThresh = -64;
@@ -111,18 +162,16 @@ bool MotionController::ShouldRaiseWake() const {
   return DegreesRolled(stats.yMean, stats.zMean, stats.prevYMean, stats.prevZMean) < rollDegreesThresh;
 }
 
-bool MotionController::ShouldShakeWake(uint16_t thresh) {
-  /* Currently Polling at 10hz, If this ever goes faster scalar and EMA might need adjusting */
+void MotionController::UpdateShakeSpeed() {
+  /* Computed on the 10hz history, if this ever goes faster scalar and EMA might need adjusting */
   int32_t speed = std::abs(zHistory[0] - zHistory[histSize - 1] + (yHistory[0] - yHistory[histSize - 1]) / 2 +
                            (xHistory[0] - xHistory[histSize - 1]) / 4) *
                   100 / (time - lastTime);
   // (.2 * speed) + ((1 - .2) * accumulatedSpeed);
   accumulatedSpeed = speed / 5 + accumulatedSpeed * 4 / 5;
-
-  return accumulatedSpeed > thresh;
 }
 
-bool MotionController::ShouldLowerSleep() const {
+bool MotionController::DetectLower() const {
   if ((stats.xMean > 887 && DegreesRolled(stats.xMean, stats.zMean, stats.prevXMean, stats.prevZMean) > 30) ||
       (stats.xMean < -887 && DegreesRolled(stats.xMean, stats.zMean, stats.prevXMean, stats.prevZMean) < -30)) {
     return true;
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include <FreeRTOS.h>
 
 #include "drivers/Bma421.h"
 #include "components/ble/MotionService.h"
+#include "components/changenotifier/ChangeNotifier.h"
+#include "components/motion/ActivityHistory.h"
 #include "utility/CircularBuffer.h"
 
 namespace Pinetime {
@@ -18,7 +21,11 @@ namespace Pinetime {
         BMA425,
       };
 
-      void Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps);
+      MotionController(ChangeNotifier& changeNotifier, ActivityHistory& history);
+
+      // Samples read from the FIFO of the motion sensor, oldest first, at Bma421::fifoSampleRate.
+      // time is the time at which the last sample was read.
+      void Update(const Drivers::Bma421::Sample* samples, size_t nbSamples, TickType_t time, uint32_t nbSteps);
 
       int16_t X() const {
         return xHistory[0];
@@ -36,6 +43,15 @@ namespace Pinetime {
         return nbSteps;
       }
 
+      // Sum of the variations of the acceleration between consecutive samples of the last Update(), in 1/1024 g
+      uint32_t Activity() const {
+        return activity;
+      }
+
+      ActivityHistory& History() {
+        return history;
+      }
+
       void ResetTrip() {
         currentTripSteps = 0;
       }
@@ -44,7 +60,8 @@ namespace Pinetime {
         return currentTripSteps;
       }
 
-      bool ShouldShakeWake(uint16_t thresh);
+      // Gestures detected in the samples of the last Update()
+      bool ShouldShakeWake(uint16_t thresh) const;
       bool ShouldRaiseWake() const;
       bool ShouldLowerSleep() const;
 
@@ -69,6 +86,7 @@ namespace Pinetime {
     private:
       uint32_t nbSteps = 0;
       uint32_t currentTripSteps = 0;
+      uint32_t activity = 0;
 
       TickType_t lastTime = 0;
       TickType_t time = 0;
@@ -89,9 +107,26 @@ namespace Pinetime {
       };
 
       AccelStats GetAccelStats() const;
+      void UpdateHistory(const Drivers::Bma421::Sample& sample, TickType_t sampleTime);
+      void UpdateShakeSpeed();
+      bool DetectRaise() const;
+      bool DetectLower() const;
 
       AccelStats stats = {};
 
+      // The gestures are detected on a 10Hz history of the samples
+      static constexpr uint8_t historyRate = 10;
+      static constexpr uint8_t historyDecimation = Drivers::Bma421::fifoSampleRate / historyRate;
+      static_assert(Drivers::Bma421::fifoSampleRate % historyRate == 0);
+      uint8_t decimationCounter = 0;
+
+      bool raiseWake = false;
+      bool lowerSleep = false;
+      int32_t peakShakeSpeed = 0;
+
+      Drivers::Bma421::Sample previousSample = {};
+      TickType_t lastSampleTime = 0;
+
       static constexpr uint8_t histSize = 8;
       Utility::CircularBuffer<int16_t, histSize> xHistory = {};
       Utility::CircularBuffer<int16_t, histSize> yHistory = {};
@@ -100,6 +135,8 @@ namespace Pinetime {
 
       DeviceTypes deviceType = DeviceTypes::Unknown;
       Pinetime::Controllers::MotionService* service = nullptr;
+      ChangeNotifier& changeNotifier;
+      ActivityHistory& history;
     };
   }
 }
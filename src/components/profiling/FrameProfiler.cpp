@@ -0,0 +1,144 @@
+#include "components/profiling/FrameProfiler.h"
+#include <algorithm>
+#include "components/profiling/ProfilingClock.h"
+
+using namespace Pinetime::Controllers;
+
+void FrameProfiler::SetScreen(uint8_t screen) {
+  FinishFlush();
+  auto& active = accumulators[0];
+  if (active.valid && active.screen == screen) {
+    return;
+  }
+
+  // Reuse the summary of the screen if it was displayed recently, otherwise replace the oldest one
+  size_t index = 0;
+  while (index < nbScreens - 1 && accumulators[index].valid && accumulators[index].screen != screen) {
+    index++;
+  }
+  Accumulator accumulator = accumulators[index];
+  std::move_backward(accumulators.begin(), accumulators.begin() + index, accumulators.begin() + index + 1);
+  if (!accumulator.valid || accumulator.screen != screen) {
+    accumulator = {};
+    accumulator.screen = screen;
+    accumulator.valid = true;
+  }
+  accumulators[0] = accumulator;
+}
+
+void FrameProfiler::StartRefresh() {
+  FinishFlush();
+  refreshStartCycles = ProfilingClock::Cycles();
+  waitCycles = 0;
+  refreshBytes = 0;
+  refreshAreas = 0;
+}
+
+void FrameProfiler::EndRefresh() {
+  if (refreshAreas == 0) {
+    return;
+  }
+  auto& accumulator = accumulators[0];
+  uint32_t renderCycles = ProfilingClock::Cycles() - refreshStartCycles - waitCycles;
+  uint32_t now = ProfilingClock::Ticks();
+  if (accumulator.frames > 0) {
+    uint32_t interval = ProfilingClock::TicksBetween(accumulator.lastFrameTicks, now);
+    if (interval <= maxFrameIntervalTicks) {
+      accumulator.intervals++;
+      accumulator.intervalTicks += interval;
+    }
+  }
+  accumulator.lastFrameTicks = now;
+  accumulator.frames++;
+  accumulator.renderCycles += renderCycles;
+  accumulator.maxRenderCycles = std::max(accumulator.maxRenderCycles, renderCycles);
+  accumulator.bytes += refreshBytes;
+  accumulator.areas += refreshAreas;
+}
+
+void FrameProfiler::OnFlush(size_t bytes, bool lastOfFrame) {
+  if (!flushStarted) {
+    flushStarted = true;
+    flushStartTicks = ProfilingClock::Ticks();
+  }
+  refreshBytes += bytes;
+  refreshAreas++;
+  flushesStarted++;
+  if (lastOfFrame) {
+    lastFlushDone = false;
+    lastFlush = flushesStarted;
+    lastFlushPending = true;
+  }
+}
+
+void FrameProfiler::OnFlushComplete() {
+  flushesCompleted = flushesCompleted + 1;
+  if (lastFlushPending && flushesCompleted == lastFlush) {
+    flushEndTicks = ProfilingClock::Ticks();
+    lastFlushPending = false;
+    lastFlushDone = true;
+  }
+}
+
+void FrameProfiler::FinishFlush() {
+  // The transfer of the last flush usually ends after lv_task_handler() returns
+  if (!flushStarted || !lastFlushDone) {
+    return;
+  }
+  auto& accumulator = accumulators[0];
+  uint32_t flushTicks = ProfilingClock::TicksBetween(flushStartTicks, flushEndTicks);
+  accumulator.flushedFrames++;
+  accumulator.flushTicks += flushTicks;
+  accumulator.maxFlushTicks = std::max(accumulator.maxFlushTicks, flushTicks);
+  flushStarted = false;
+  lastFlushDone = false;
+}
+
+void FrameProfiler::OnFrameCommands(uint32_t commands) {
+  accumulators[0].commands += commands;
+}
+
+void FrameProfiler::OnFullRefresh() {
+  accumulators[0].fullRefreshes++;
+}
+
+void FrameProfiler::StartWait() {
+  waitStartCycles = ProfilingClock::Cycles();
+}
+
+void FrameProfiler::EndWait() {
+  waitCycles += ProfilingClock::Cycles() - waitStartCycles;
+}
+
+size_t FrameProfiler::GetSummaries(std::array<Summary, nbScreens>& summaries) const {
+  size_t count = 0;
+  for (const auto& accumulator : accumulators) {
+    if (accumulator.valid) {
+      summaries[count++] = Summarize(accumulator);
+    }
+  }
+  return count;
+}
+
+FrameProfiler::Summary FrameProfiler::Summarize(const Accumulator& accumulator) {
+  Summary summary;
+  summary.screen = accumulator.screen;
+  summary.frames = accumulator.frames;
+  summary.fullRefreshes = accumulator.fullRefreshes;
+  if (accumulator.frames == 0) {
+    return summary;
+  }
+  summary.averageRenderUs = ProfilingClock::CyclesToUs(accumulator.renderCycles / accumulator.frames);
+  summary.maxRenderUs = ProfilingClock::CyclesToUs(accumulator.maxRenderCycles);
+  summary.averageBytes = accumulator.bytes / accumulator.frames;
+  summary.averageAreas = accumulator.areas / accumulator.frames;
+  summary.averageCommands = accumulator.commands / accumulator.frames;
+  if (accumulator.flushedFrames > 0) {
+    summary.averageFlushUs = ProfilingClock::TicksToUs(accumulator.flushTicks / accumulator.flushedFrames);
+    summary.maxFlushUs = ProfilingClock::TicksToUs(accumulator.maxFlushTicks);
+  }
+  if (accumulator.intervalTicks > 0) {
+    summary.frameRate = static_cast<uint16_t>((accumulator.intervals * 10ULL * ProfilingClock::ticksPerSecond) / accumulator.intervalTicks);
+  }
+  return summary;
+}
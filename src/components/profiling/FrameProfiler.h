@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    // Measures the frames rendered by LVGL: the time spent rendering (CPU cycles of lv_task_handler(), without the
+    // time waiting for the display), the time spent flushing (from the first flush of the frame to the end of the
+    // transfer of the last one), and the amount of data sent to the display.
+    // The measurements are aggregated per screen, for the last few screens displayed.
+    class FrameProfiler {
+    public:
+      struct Summary {
+        uint8_t screen = 0;
+        uint32_t frames = 0;
+        // Frames per second while the screen is updating, multiplied by 10
+        uint16_t frameRate = 0;
+        uint32_t averageRenderUs = 0;
+        uint32_t maxRenderUs = 0;
+        uint32_t averageFlushUs = 0;
+        uint32_t maxFlushUs = 0;
+        uint32_t averageBytes = 0;
+        uint16_t averageAreas = 0;
+        uint16_t averageCommands = 0;
+        uint32_t fullRefreshes = 0;
+      };
+
+      static constexpr size_t nbScreens = 4;
+
+      // Called from the display task
+      void SetScreen(uint8_t screen);
+      void StartRefresh();
+      void EndRefresh();
+      void OnFlush(size_t bytes, bool lastOfFrame);
+      void OnFrameCommands(uint32_t commands);
+      void OnFullRefresh();
+      void StartWait();
+      void EndWait();
+
+      // Called from the SPI interrupt when the transfer of a flush is done, once per OnFlush(), in the same order
+      void OnFlushComplete();
+
+      // Most recent screen first. Returns the number of summaries copied.
+      size_t GetSummaries(std::array<Summary, nbScreens>& summaries) const;
+
+    private:
+      struct Accumulator {
+        uint8_t screen = 0;
+        bool valid = false;
+        uint32_t frames = 0;
+        uint32_t flushedFrames = 0;
+        uint64_t renderCycles = 0;
+        uint32_t maxRenderCycles = 0;
+        uint64_t flushTicks = 0;
+        uint32_t maxFlushTicks = 0;
+        uint64_t bytes = 0;
+        uint32_t areas = 0;
+        uint32_t commands = 0;
+        uint32_t fullRefreshes = 0;
+        uint32_t lastFrameTicks = 0;
+        uint32_t intervals = 0;
+        uint64_t intervalTicks = 0;
+      };
+
+      // Longer intervals between two frames are pauses (static screen, display off), they are not used for the frame rate
+      static constexpr uint32_t maxFrameIntervalTicks = 2 * 32768;
+
+      void FinishFlush();
+      static Summary Summarize(const Accumulator& accumulator);
+
+      // accumulators[0] is the active screen, the others are ordered from the most recent
+      std::array<Accumulator, nbScreens> accumulators;
+
+      uint32_t refreshStartCycles = 0;
+      uint32_t waitStartCycles = 0;
+      uint32_t waitCycles = 0;
+      uint32_t refreshBytes = 0;
+      uint32_t refreshAreas = 0;
+
+      uint32_t flushStartTicks = 0;
+      bool flushStarted = false;
+      // The flushes are numbered: OnFlush() of the last one of a frame is called while the transfer of the previous
+      // one is still running, the end of the frame is the completion of the last one, not the next completion
+      uint32_t flushesStarted = 0;
+      volatile uint32_t flushesCompleted = 0;
+      volatile uint32_t lastFlush = 0;
+      volatile bool lastFlushPending = false;
+      volatile bool lastFlushDone = false;
+      volatile uint32_t flushEndTicks = 0;
+    };
+  }
+}
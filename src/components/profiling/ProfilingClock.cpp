@@ -0,0 +1,89 @@
+#include "components/profiling/ProfilingClock.h"
+#include <nrf.h>
+#include <nrfx.h>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  volatile uint32_t overflows = 0;
+  volatile uint32_t sleepTime = 0;
+  uint32_t sleepStart = 0;
+}
+
+void ProfilingClock::Init() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  // RTC2 runs from the low frequency clock, which is already running for the FreeRTOS tick (RTC1)
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->TASKS_CLEAR = 1;
+  NRF_RTC2->PRESCALER = 0;
+  NRF_RTC2->EVENTS_OVRFLW = 0;
+  NRF_RTC2->INTENSET = RTC_INTENSET_OVRFLW_Msk;
+  NRFX_IRQ_PRIORITY_SET(RTC2_IRQn, 7);
+  NRFX_IRQ_ENABLE(RTC2_IRQn);
+  NRF_RTC2->TASKS_START = 1;
+}
+
+uint32_t ProfilingClock::Cycles() {
+  return DWT->CYCCNT;
+}
+
+uint32_t ProfilingClock::Ticks() {
+  return NRF_RTC2->COUNTER;
+}
+
+uint32_t ProfilingClock::RunTime() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t counter = NRF_RTC2->COUNTER;
+  uint32_t nbOverflows = overflows;
+  if (NRF_RTC2->EVENTS_OVRFLW != 0) {
+    // The counter wrapped but the interrupt didn't run yet (interrupts are disabled during the tickless sleep)
+    nbOverflows++;
+    counter = NRF_RTC2->COUNTER;
+  }
+  __set_PRIMASK(primask);
+  return (nbOverflows << 24) | counter;
+}
+
+uint32_t ProfilingClock::SleepTime() {
+  return sleepTime;
+}
+
+void ProfilingClock::EnterSleep() {
+  sleepStart = RunTime();
+}
+
+void ProfilingClock::ExitSleep() {
+  sleepTime = sleepTime + (RunTime() - sleepStart);
+}
+
+extern "C" {
+void RTC2_IRQHandler(void) {
+  if (NRF_RTC2->EVENTS_OVRFLW != 0) {
+    NRF_RTC2->EVENTS_OVRFLW = 0;
+    // Read back the event to make sure it's cleared before leaving the handler
+    (void) NRF_RTC2->EVENTS_OVRFLW;
+    overflows = overflows + 1;
+  }
+}
+
+// Hooks of FreeRTOSConfig.h
+void ProfilingClockInit(void) {
+  ProfilingClock::Init();
+}
+
+uint32_t ProfilingClockRunTime(void) {
+  return ProfilingClock::RunTime();
+}
+
+void ProfilingClockEnterSleep(void) {
+  ProfilingClock::EnterSleep();
+}
+
+void ProfilingClockExitSleep(void) {
+  ProfilingClock::ExitSleep();
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    // Time sources used to profile the firmware:
+    //  - Cycles() is the DWT cycle counter. It only counts while the CPU runs, and measures the processing cost of the code.
+    //  - Ticks() is the counter of RTC2 (32768 Hz, 24 bits). It keeps counting while the CPU sleeps, and measures elapsed time.
+    //  - RunTime() is the same counter extended to 32 bits with the overflow interrupt of RTC2. It's the run time counter
+    //    of FreeRTOS (configGENERATE_RUN_TIME_STATS), which starts the clock before the scheduler.
+    class ProfilingClock {
+    public:
+      static constexpr uint32_t cyclesPerUs = 64;
+      static constexpr uint32_t ticksPerSecond = 32768;
+
+      static void Init();
+      static uint32_t Cycles();
+      static uint32_t Ticks();
+      static uint32_t RunTime();
+
+      // Total time spent sleeping in the tickless idle mode of FreeRTOS, in RunTime() ticks
+      static uint32_t SleepTime();
+      static void EnterSleep();
+      static void ExitSleep();
+
+      static uint32_t TicksBetween(uint32_t from, uint32_t to) {
+        return (to - from) & 0xffffff;
+      }
+
+      static uint32_t TicksToUs(uint64_t ticks) {
+        return static_cast<uint32_t>((ticks * 1000000) / ticksPerSecond);
+      }
+
+      static uint32_t CyclesToUs(uint64_t cycles) {
+        return static_cast<uint32_t>(cycles / cyclesPerUs);
+      }
+    };
+  }
+}
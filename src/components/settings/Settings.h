@@ -296,6 +296,18 @@ namespace Pinetime {
         return settings.stepsGoal;
       };
 
+      // Minutes between two background heart rate measurements, 0 disables them
+      void SetHeartRateBackgroundInterval(uint8_t minutes) {
+        if (minutes != settings.heartRateBackgroundInterval) {
+          settingsChanged = true;
+        }
+        settings.heartRateBackgroundInterval = minutes;
+      };
+
+      uint8_t GetHeartRateBackgroundInterval() const {
+        return settings.heartRateBackgroundInterval;
+      };
+
       void SetBleRadioEnabled(bool enabled) {
         bleRadioEnabled = enabled;
       };
@@ -308,7 +320,7 @@ namespace Pinetime {
       Pinetime::Controllers::FS& fs;
 
       // high number to not collide with a mainline infinitime release and cause heavoc (they wont ever catch up, im sure)
-      static constexpr uint32_t settingsVersion = 0x0069;
+      static constexpr uint32_t settingsVersion = 0x006A;
 
       struct SettingsData {
         uint32_t version = settingsVersion;
@@ -332,6 +344,8 @@ namespace Pinetime {
         Controllers::BrightnessController::Levels brightLevel = Controllers::BrightnessController::Levels::Medium;
 
         CongressMode congressMode;
+
+        uint8_t heartRateBackgroundInterval = 0;
       };
 
       SettingsData settings;
@@ -36,6 +36,7 @@
 #include "drivers/Watchdog.h"
 #include "systemtask/SystemTask.h"
 #include "systemtask/Messages.h"
+#include "FreeRTOS/heap_4_infinitime.h"
 
 #include "displayapp/screens/settings/QuickSettings.h"
 #include "displayapp/screens/settings/Settings.h"
@@ -45,6 +46,7 @@
 #include "displayapp/screens/settings/SettingWakeUp.h"
 #include "displayapp/screens/settings/SettingDisplay.h"
 #include "displayapp/screens/settings/SettingSteps.h"
+#include "displayapp/screens/settings/SettingHeartRate.h"
 #include "displayapp/screens/settings/SettingSetDateTime.h"
 #include "displayapp/screens/settings/SettingCongressMode.h"
 #include "displayapp/screens/settings/SettingChimes.h"
@@ -82,7 +84,9 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::AlarmController& alarmController,
                        Pinetime::Controllers::BrightnessController& brightnessController,
                        Pinetime::Controllers::TouchHandler& touchHandler,
-                       Pinetime::Controllers::FS& filesystem)
+                       Pinetime::Controllers::FS& filesystem,
+                       Pinetime::Controllers::FrameProfiler& frameProfiler,
+                       Pinetime::Controllers::ChangeNotifier& changeNotifier)
   : lcd {lcd},
     touchPanel {touchPanel},
     batteryController {batteryController},
@@ -98,7 +102,9 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
     brightnessController {brightnessController},
     touchHandler {touchHandler},
     filesystem {filesystem},
-    lvgl {lcd, filesystem},
+    frameProfiler {frameProfiler},
+    changeNotifier {changeNotifier},
+    lvgl {lcd, filesystem, frameProfiler},
     timer(this, TimerCallback),
     controllers {batteryController,
                  bleController,
@@ -126,7 +132,11 @@ void DisplayApp::Start(System::BootErrors error) {
   bootError = error;
 
   lvgl.Init();
+  screenArena.Init();
   motorController.Init();
+  changeNotifier.SetListener([this]() {
+    PushMessage(Messages::ControllersChanged);
+  });
 
   if (error == System::BootErrors::TouchController) {
     LoadNewScreen(Apps::Error, DisplayApp::FullRefreshDirections::None);
@@ -210,7 +220,14 @@ void DisplayApp::Refresh() {
       if (!currentScreen->IsRunning()) {
         LoadPreviousScreen();
       }
+      frameProfiler.StartRefresh();
+      RefreshSubscribedScreen();
+      lvgl.ResumeTasks();
       queueTimeout = lv_task_handler();
+      frameProfiler.EndRefresh();
+      if (currentScreen->Subscriptions() != 0 && !currentScreen->IsAnimating() && lvgl.SuspendTasks()) {
+        queueTimeout = SubscribedScreenTimeout();
+      }
 
       if (!systemTask->IsSleepDisabled() && IsPastDimTime()) {
         if (!isDimmed) {
@@ -231,6 +248,9 @@ void DisplayApp::Refresh() {
 
   Messages msg;
   if (xQueueReceive(msgQueue, &msg, queueTimeout) == pdTRUE) {
+    if (msg != Messages::ControllersChanged) {
+      lvgl.ResumeTasks();
+    }
     switch (msg) {
       case Messages::DimScreen:
         DimScreen();
@@ -382,6 +402,9 @@ void DisplayApp::Refresh() {
         RestoreBrightness();
         motorController.RunForDuration(15);
         break;
+      case Messages::ControllersChanged:
+        // The screen is refreshed at the beginning of the next loop
+        break;
     }
   }
 
@@ -395,6 +418,41 @@ void DisplayApp::Refresh() {
   }
 }
 
+void DisplayApp::RefreshSubscribedScreen() {
+  auto subscriptions = currentScreen->Subscriptions();
+  changeNotifier.Subscribe(subscriptions);
+  changeNotifier.Acknowledge();
+  if (subscriptions == 0) {
+    return;
+  }
+
+  bool refresh = changeNotifier.ChangedSince(changeSequences, subscriptions) != 0 || currentScreen->IsAnimating();
+  auto now = std::chrono::time_point_cast<std::chrono::seconds>(dateTimeController.CurrentDateTime());
+  if (currentScreen->DisplaysSeconds()) {
+    refresh |= now != displayedTime;
+  } else {
+    refresh |= std::chrono::time_point_cast<std::chrono::minutes>(now) != std::chrono::time_point_cast<std::chrono::minutes>(displayedTime);
+  }
+  displayedTime = now;
+
+  if (refresh) {
+    currentScreen->Refresh();
+  }
+}
+
+TickType_t DisplayApp::SubscribedScreenTimeout() {
+  // Wake up right after the displayed time changes, or when the screen must be dimmed or turned off
+  TickType_t timeout = currentScreen->DisplaysSeconds() ? dateTimeController.TicksToNextSecond() : dateTimeController.TicksToNextMinute();
+  timeout += 1;
+  if (!systemTask->IsSleepDisabled()) {
+    // Same comparison as IsPastDimTime() and IsPastSleepTime() in Refresh()
+    uint32_t inactiveTime = lv_disp_get_inactive_time(nullptr);
+    uint32_t deadline = pdMS_TO_TICKS(settingsController.GetScreenTimeOut() - (isDimmed ? 0 : 2000));
+    timeout = std::min<TickType_t>(timeout, deadline > inactiveTime ? pdMS_TO_TICKS(deadline - inactiveTime) + 1 : 1);
+  }
+  return timeout;
+}
+
 void DisplayApp::StartApp(Apps app, DisplayApp::FullRefreshDirections direction) {
   nextApp = app;
   nextDirection = direction;
@@ -417,7 +475,19 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
   motorController.StopRinging();
 
   currentScreen.reset(nullptr);
+  // The images kept open in the cache of LVGL would outlive the screen
+  lv_img_cache_invalidate_src(nullptr);
+  screenArena.End();
+  screenArena.Begin(app);
+  // The failed allocations of the heap are attributed to the displayed app
+  vPortSetHeapContext(static_cast<uint8_t>(app));
+  lvgl.ResumeTasks();
+  changeNotifier.Subscribe(0);
+  frameProfiler.SetScreen(static_cast<uint8_t>(app));
   SetFullRefresh(direction);
+  // The resources of the watch face stay pinned in the cache while other apps are displayed,
+  // so that going back to the watch face doesn't read them from the flash again.
+  lvgl.SetResourcePinning(false);
 
   switch (app) {
     case Apps::Launcher: {
@@ -435,6 +505,8 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
                                                                  std::move(apps));
     } break;
     case Apps::Clock: {
+      lvgl.UnpinResources();
+      lvgl.SetResourcePinning(true);
       const auto* watchFace =
         std::find_if(userWatchFaces.begin(), userWatchFaces.end(), [this](const WatchFaceDescription& watchfaceDescription) {
           return watchfaceDescription.watchFace == settingsController.GetWatchFace();
@@ -513,6 +585,9 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
     case Apps::SettingSteps:
       currentScreen = std::make_unique<Screens::SettingSteps>(settingsController);
       break;
+    case Apps::SettingHeartRate:
+      currentScreen = std::make_unique<Screens::SettingHeartRate>(settingsController);
+      break;
     case Apps::SettingSetDateTime:
       currentScreen = std::make_unique<Screens::SettingSetDateTime>(this, dateTimeController, settingsController);
       break;
@@ -539,7 +614,11 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
                                                             bleController,
                                                             watchdog,
                                                             motionController,
-                                                            touchPanel);
+                                                            touchPanel,
+                                                            frameProfiler,
+                                                            screenArena,
+                                                            systemTask->systemMonitor(),
+                                                            lvgl);
       break;
     case Apps::FlashLight:
       currentScreen = std::make_unique<Screens::FlashLight>(*systemTask, brightnessController);
@@ -569,7 +648,7 @@ void DisplayApp::PushMessage(Messages msg) {
     // Make xQueueSend() non-blocking if the message is a Notification message. We do this to avoid
     // deadlock between SystemTask and DisplayApp when their respective message queues are getting full
     // when a lot of notifications are received on a very short time span.
-    if (msg == Messages::NewNotification) {
+    if (msg == Messages::NewNotification || msg == Messages::ControllersChanged) {
       timeout = static_cast<TickType_t>(0);
     }
 
@@ -3,9 +3,11 @@
 #include <queue.h>
 #include <task.h>
 #include <memory>
+#include <chrono>
 #include <systemtask/Messages.h>
 #include "displayapp/apps/Apps.h"
 #include "displayapp/LittleVgl.h"
+#include "displayapp/ScreenArena.h"
 #include "displayapp/TouchEvents.h"
 #include "components/brightness/BrightnessController.h"
 #include "components/motor/MotorController.h"
@@ -40,6 +42,8 @@ namespace Pinetime {
     class MotionController;
     class TouchHandler;
     class SimpleWeatherService;
+    class FrameProfiler;
+    class ChangeNotifier;
   }
 
   namespace System {
@@ -66,7 +70,9 @@ namespace Pinetime {
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::FS& filesystem);
+                 Pinetime::Controllers::FS& filesystem,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler,
+                 Pinetime::Controllers::ChangeNotifier& changeNotifier);
       void Start(System::BootErrors error);
       void PushMessage(Display::Messages msg);
 
@@ -96,10 +102,13 @@ namespace Pinetime {
       Pinetime::Controllers::BrightnessController& brightnessController;
       Pinetime::Controllers::TouchHandler& touchHandler;
       Pinetime::Controllers::FS& filesystem;
+      Pinetime::Controllers::FrameProfiler& frameProfiler;
+      Pinetime::Controllers::ChangeNotifier& changeNotifier;
 
       Pinetime::Controllers::FirmwareValidator validator;
       Pinetime::Components::LittleVgl lvgl;
       Pinetime::Controllers::Timer timer;
+      ScreenArena screenArena;
 
       AppControllers controllers;
       TaskHandle_t taskHandle;
@@ -124,6 +133,8 @@ namespace Pinetime {
       void LoadNewScreen(Apps app, DisplayApp::FullRefreshDirections direction);
       void LoadScreen(Apps app, DisplayApp::FullRefreshDirections direction);
       void PushMessageToSystemTask(Pinetime::System::Messages message);
+      void RefreshSubscribedScreen();
+      TickType_t SubscribedScreenTimeout();
 
       Apps nextApp = Apps::None;
       DisplayApp::FullRefreshDirections nextDirection;
@@ -135,6 +146,10 @@ namespace Pinetime {
       Utility::StaticStack<FullRefreshDirections, returnAppStackSize> appStackDirections;
 
       bool isDimmed = false;
+
+      // State of the controllers and time when the current screen was last refreshed
+      Pinetime::Controllers::ChangeNotifier::Sequences changeSequences {};
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> displayedTime {};
     };
   }
 }
@@ -24,7 +24,9 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::AlarmController& /*alarmController*/,
                        Pinetime::Controllers::BrightnessController& /*brightnessController*/,
                        Pinetime::Controllers::TouchHandler& /*touchHandler*/,
-                       Pinetime::Controllers::FS& /*filesystem*/)
+                       Pinetime::Controllers::FS& /*filesystem*/,
+                       Pinetime::Controllers::FrameProfiler& /*frameProfiler*/,
+                       Pinetime::Controllers::ChangeNotifier& /*changeNotifier*/)
   : lcd {lcd}, bleController {bleController} {
 }
 
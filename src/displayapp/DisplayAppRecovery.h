@@ -33,6 +33,8 @@ namespace Pinetime {
     class AlarmController;
     class BrightnessController;
     class FS;
+    class FrameProfiler;
+    class ChangeNotifier;
     class SimpleWeatherService;
     class MusicService;
     class NavigationService;
@@ -59,7 +61,9 @@ namespace Pinetime {
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::FS& filesystem);
+                 Pinetime::Controllers::FS& filesystem,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler,
+                 Pinetime::Controllers::ChangeNotifier& changeNotifier);
       void Start();
 
       void Start(Pinetime::System::BootErrors) {
@@ -3,6 +3,8 @@
 
 #include <FreeRTOS.h>
 #include <task.h>
+#include <algorithm>
+#include <cstring>
 #include "drivers/St7789.h"
 #include "littlefs/lfs.h"
 #include "components/fs/FS.h"
@@ -16,13 +18,23 @@ namespace {
   }
 
   lv_fs_res_t lvglOpen(lv_fs_drv_t* drv, void* file_p, const char* path, lv_fs_mode_t /*mode*/) {
-    lfs_file_t* file = static_cast<lfs_file_t*>(file_p);
-    Pinetime::Controllers::FS* filesys = static_cast<Pinetime::Controllers::FS*>(drv->user_data);
-    int res = filesys->FileOpen(file, path, LFS_O_RDONLY);
+    auto* file = static_cast<LittleVgl::File*>(file_p);
+    LittleVgl* lvgl = static_cast<LittleVgl*>(drv->user_data);
+    file->position = 0;
+    file->id = Pinetime::Controllers::ResourceCache::Id(path);
+    file->pinned = lvgl->ResourcePinning();
+    file->packed = lvgl->FileSystem().FindResource(path, file->resource);
+    if (file->packed) {
+      file->length = file->resource.length;
+      return LV_FS_RES_OK;
+    }
+
+    int res = lvgl->FileSystem().FileOpen(&file->file, path, LFS_O_RDONLY);
     if (res == 0) {
-      if (file->type == 0) {
+      if (file->file.type == 0) {
         return LV_FS_RES_FS_ERR;
       } else {
+        file->length = lvgl->FileSystem().FileSize(&file->file);
         return LV_FS_RES_OK;
       }
     }
@@ -30,25 +42,20 @@ namespace {
   }
 
   lv_fs_res_t lvglClose(lv_fs_drv_t* drv, void* file_p) {
-    Pinetime::Controllers::FS* filesys = static_cast<Pinetime::Controllers::FS*>(drv->user_data);
-    lfs_file_t* file = static_cast<lfs_file_t*>(file_p);
-    filesys->FileClose(file);
-
+    LittleVgl* lvgl = static_cast<LittleVgl*>(drv->user_data);
+    lvgl->FileClose(static_cast<LittleVgl::File*>(file_p));
     return LV_FS_RES_OK;
   }
 
   lv_fs_res_t lvglRead(lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br) {
-    Pinetime::Controllers::FS* filesys = static_cast<Pinetime::Controllers::FS*>(drv->user_data);
-    lfs_file_t* file = static_cast<lfs_file_t*>(file_p);
-    filesys->FileRead(file, static_cast<uint8_t*>(buf), btr);
-    *br = btr;
+    LittleVgl* lvgl = static_cast<LittleVgl*>(drv->user_data);
+    *br = lvgl->FileRead(static_cast<LittleVgl::File*>(file_p), static_cast<uint8_t*>(buf), btr);
     return LV_FS_RES_OK;
   }
 
   lv_fs_res_t lvglSeek(lv_fs_drv_t* drv, void* file_p, uint32_t pos) {
-    Pinetime::Controllers::FS* filesys = static_cast<Pinetime::Controllers::FS*>(drv->user_data);
-    lfs_file_t* file = static_cast<lfs_file_t*>(file_p);
-    filesys->FileSeek(file, pos);
+    LittleVgl* lvgl = static_cast<LittleVgl*>(drv->user_data);
+    lvgl->FileSeek(static_cast<LittleVgl::File*>(file_p), pos);
     return LV_FS_RES_OK;
   }
 }
@@ -58,6 +65,11 @@ static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_
   lvgl->FlushDisplay(area, color_p);
 }
 
+static void disp_wait(lv_disp_drv_t* disp_drv) {
+  auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
+  lvgl->WaitFlushComplete();
+}
+
 static void rounder(lv_disp_drv_t* disp_drv, lv_area_t* area) {
   auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
   if (lvgl->GetFullRefresh()) {
@@ -73,7 +85,10 @@ bool touchpad_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
   return lvgl->GetTouchPadInfo(data);
 }
 
-LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem) : lcd {lcd}, filesystem {filesystem} {
+LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd,
+                     Pinetime::Controllers::FS& filesystem,
+                     Pinetime::Controllers::FrameProfiler& frameProfiler)
+  : lcd {lcd}, filesystem {filesystem}, frameProfiler {frameProfiler} {
 }
 
 void LittleVgl::Init() {
@@ -85,8 +100,15 @@ void LittleVgl::Init() {
 }
 
 void LittleVgl::InitDisplay() {
-  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * 4); /*Initialize the display buffer*/
-  lv_disp_drv_init(&disp_drv);                                       /*Basic initialization*/
+  flushCompleteSemaphore = xSemaphoreCreateBinary();
+  ASSERT(flushCompleteSemaphore != nullptr);
+
+#if LVGL_DRAW_BUFFER_DOUBLE
+  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * nbWriteLines); /*Initialize the display buffer*/
+#else
+  lv_disp_buf_init(&disp_buf_2, buf2_1, nullptr, LV_HOR_RES_MAX * nbWriteLines);
+#endif
+  lv_disp_drv_init(&disp_drv); /*Basic initialization*/
 
   /*Set up the functions to access to your display*/
 
@@ -100,9 +122,11 @@ void LittleVgl::InitDisplay() {
   disp_drv.buffer = &disp_buf_2;
   disp_drv.user_data = this;
   disp_drv.rounder_cb = rounder;
+  /*Sleep instead of spinning while a buffer is still being sent to the display*/
+  disp_drv.wait_cb = disp_wait;
 
   /*Finally register the driver*/
-  lv_disp_drv_register(&disp_drv);
+  display = lv_disp_drv_register(&disp_drv);
 }
 
 void LittleVgl::InitTouchpad() {
@@ -112,28 +136,91 @@ void LittleVgl::InitTouchpad() {
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = touchpad_read;
   indev_drv.user_data = this;
-  lv_indev_drv_register(&indev_drv);
+  touchpad = lv_indev_drv_register(&indev_drv);
 }
 
 void LittleVgl::InitFileSystem() {
   lv_fs_drv_t fs_drv;
   lv_fs_drv_init(&fs_drv);
 
-  fs_drv.file_size = sizeof(lfs_file_t);
+  fs_drv.file_size = sizeof(File);
   fs_drv.letter = 'F';
   fs_drv.open_cb = lvglOpen;
   fs_drv.close_cb = lvglClose;
   fs_drv.read_cb = lvglRead;
   fs_drv.seek_cb = lvglSeek;
 
-  fs_drv.user_data = &filesystem;
+  fs_drv.user_data = this;
 
   lv_fs_drv_register(&fs_drv);
+  filesystem.SetResourceCache(&resourceCache);
+}
+
+uint32_t LittleVgl::FileRead(File* file, uint8_t* buffer, uint32_t size) {
+  auto reader = [this, file](uint32_t offset, uint8_t* data, uint32_t length) {
+    if (file->packed) {
+      return filesystem.ResourceRead(file->resource, offset, data, length);
+    }
+    filesystem.FileSeek(&file->file, offset);
+    return filesystem.FileRead(&file->file, data, length);
+  };
+  // Held during the whole read so that a file written in the meantime can't leave stale blocks in the cache
+  filesystem.Lock();
+  uint32_t read = 0;
+  // A resource opened from a pack that has been replaced since can't be read anymore: its offset and its blocks in
+  // the cache would be those of another resource, or of the new version of this one
+  if (!file->packed || filesystem.ResourceValid(file->resource)) {
+    read = resourceCache.Read(file->id, file->length, file->pinned, file->position, buffer, size, reader);
+  }
+  filesystem.Unlock();
+  file->position += read;
+  return read;
+}
+
+void LittleVgl::FileSeek(File* file, uint32_t position) {
+  // The actual seek is done on the next read that misses the resource cache
+  file->position = position;
+}
+
+void LittleVgl::FileClose(File* file) {
+  if (!file->packed) {
+    filesystem.FileClose(&file->file);
+  }
+}
+
+bool LittleVgl::SuspendTasks() {
+  if (tasksSuspended) {
+    return true;
+  }
+  if (display->inv_p != 0 || lv_anim_count_running() != 0 || fullRefresh || scrollDirection != FullRefreshDirections::None) {
+    return false;
+  }
+  if (tapped || touchpad->proc.state != LV_INDEV_STATE_REL) {
+    return false;
+  }
+  refreshTaskPriority = display->refr_task->prio;
+  readTaskPriority = touchpad->driver.read_task->prio;
+  lv_task_set_prio(display->refr_task, LV_TASK_PRIO_OFF);
+  lv_task_set_prio(touchpad->driver.read_task, LV_TASK_PRIO_OFF);
+  tasksSuspended = true;
+  return true;
+}
+
+void LittleVgl::ResumeTasks() {
+  if (!tasksSuspended) {
+    return;
+  }
+  lv_task_set_prio(display->refr_task, refreshTaskPriority);
+  lv_task_set_prio(touchpad->driver.read_task, readTaskPriority);
+  tasksSuspended = false;
 }
 
 void LittleVgl::SetFullRefresh(FullRefreshDirections direction) {
   if (scrollDirection == FullRefreshDirections::None) {
     scrollDirection = direction;
+    if (scrollDirection != FullRefreshDirections::None) {
+      frameProfiler.OnFullRefresh();
+    }
     if (scrollDirection == FullRefreshDirections::Down) {
       lv_disp_set_direction(lv_disp_get_default(), 1);
     } else if (scrollDirection == FullRefreshDirections::Right) {
@@ -210,6 +297,15 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
     }
   }
 
+  // The transfer runs in the background. LVGL is informed that the buffer can be reused
+  // from the SPI interrupt, once the last byte has been sent (see OnFlushComplete()).
+  auto onTransferComplete = [this]() {
+    OnFlushComplete();
+  };
+
+  const bool lastOfFrame = lv_disp_flush_is_last(&disp_drv);
+  frameProfiler.OnFlush(width * height * 2, lastOfFrame);
+
   if (y2 < y1) {
     height = totalNbLines - y1;
 
@@ -219,15 +315,41 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
 
     uint16_t pixOffset = width * height;
     height = y2 + 1;
-    lcd.DrawBuffer(area->x1, 0, width, height, reinterpret_cast<const uint8_t*>(color_p + pixOffset), width * height * 2);
+    lcd.DrawBuffer(area->x1,
+                   0,
+                   width,
+                   height,
+                   reinterpret_cast<const uint8_t*>(color_p + pixOffset),
+                   width * height * 2,
+                   onTransferComplete);
 
   } else {
-    lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
+    lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2, onTransferComplete);
+  }
+
+  if (lastOfFrame) {
+    lcd.EndFrame();
+    frameProfiler.OnFrameCommands(lcd.LastFrameStatistics().commands);
   }
+}
 
+void LittleVgl::OnFlushComplete() {
+  // Called from the SPI interrupt
   // IMPORTANT!!!
   // Inform the graphics library that you are ready with the flushing
   lv_disp_flush_ready(&disp_drv);
+  frameProfiler.OnFlushComplete();
+
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xSemaphoreGiveFromISR(flushCompleteSemaphore, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void LittleVgl::WaitFlushComplete() {
+  // LVGL calls this in a loop until the flush is done, the timeout only guards against a missed interrupt
+  frameProfiler.StartWait();
+  xSemaphoreTake(flushCompleteSemaphore, pdMS_TO_TICKS(10));
+  frameProfiler.EndWait();
 }
 
 void LittleVgl::SetNewTouchPoint(int16_t x, int16_t y, bool contact) {
@@ -1,7 +1,20 @@
 #pragma once
 
+#include <array>
+#include <FreeRTOS.h>
+#include <semphr.h>
 #include <lvgl/lvgl.h>
 #include <components/fs/FS.h>
+#include <components/fs/ResourceCache.h>
+#include <components/profiling/FrameProfiler.h>
+
+#ifndef LVGL_DRAW_BUFFER_LINES
+  #define LVGL_DRAW_BUFFER_LINES 4
+#endif
+
+#ifndef LVGL_DRAW_BUFFER_DOUBLE
+  #define LVGL_DRAW_BUFFER_DOUBLE 1
+#endif
 
 namespace Pinetime {
   namespace Drivers {
@@ -12,7 +25,9 @@ namespace Pinetime {
     class LittleVgl {
     public:
       enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
-      LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem);
+      LittleVgl(Pinetime::Drivers::St7789& lcd,
+                Pinetime::Controllers::FS& filesystem,
+                Pinetime::Controllers::FrameProfiler& frameProfiler);
 
       LittleVgl(const LittleVgl&) = delete;
       LittleVgl& operator=(const LittleVgl&) = delete;
@@ -22,11 +37,58 @@ namespace Pinetime {
       void Init();
 
       void FlushDisplay(const lv_area_t* area, lv_color_t* color_p);
+      void WaitFlushComplete();
       bool GetTouchPadInfo(lv_indev_data_t* ptr);
       void SetFullRefresh(FullRefreshDirections direction);
       void SetNewTouchPoint(int16_t x, int16_t y, bool contact);
       void CancelTap();
 
+      // Stops the display refresh and touch input tasks of LVGL when there is nothing left for them to do: no invalidated
+      // area, no running animation, no touch in progress and no full refresh pending. Returns false and leaves the
+      // tasks running otherwise. ResumeTasks() must be called before lv_task_handler() and after any touch event.
+      bool SuspendTasks();
+      void ResumeTasks();
+
+      // Used by the 'F:' file system driver. Resources found in the resource pack are read
+      // from the pack instead of being opened as files.
+      struct File {
+        lfs_file_t file;
+        Pinetime::Controllers::FS::Resource resource;
+        uint32_t position;
+        uint32_t length;
+        uint32_t id;
+        bool pinned;
+        bool packed;
+      };
+
+      uint32_t FileRead(File* file, uint8_t* buffer, uint32_t size);
+      void FileSeek(File* file, uint32_t position);
+      void FileClose(File* file);
+
+      // Files opened while the pinning is enabled keep their blocks in the resource cache
+      // until UnpinResources() is called. Used for the resources of the watch face.
+      void SetResourcePinning(bool enabled) {
+        pinResources = enabled;
+      }
+
+      bool ResourcePinning() const {
+        return pinResources;
+      }
+
+      void UnpinResources() {
+        filesystem.Lock();
+        resourceCache.UnpinAll();
+        filesystem.Unlock();
+      }
+
+      const Pinetime::Controllers::ResourceCache::Statistics& ResourceCacheStatistics() const {
+        return resourceCache.GetStatistics();
+      }
+
+      Pinetime::Controllers::FS& FileSystem() {
+        return filesystem;
+      }
+
       bool GetFullRefresh() {
         bool returnValue = fullRefresh;
         if (fullRefresh) {
@@ -39,20 +101,31 @@ namespace Pinetime {
       void InitDisplay();
       void InitTouchpad();
       void InitFileSystem();
+      void OnFlushComplete();
 
       Pinetime::Drivers::St7789& lcd;
       Pinetime::Controllers::FS& filesystem;
-
-      lv_disp_buf_t disp_buf_2;
-      lv_color_t buf2_1[LV_HOR_RES_MAX * 4];
-      lv_color_t buf2_2[LV_HOR_RES_MAX * 4];
-
-      lv_disp_drv_t disp_drv;
+      Pinetime::Controllers::FrameProfiler& frameProfiler;
 
       bool fullRefresh = false;
-      static constexpr uint8_t nbWriteLines = 4;
+      static constexpr uint8_t nbWriteLines = LVGL_DRAW_BUFFER_LINES;
       static constexpr uint16_t totalNbLines = 320;
       static constexpr uint16_t visibleNbLines = 240;
+      static_assert(nbWriteLines > 0 && visibleNbLines % nbWriteLines == 0, "LVGL_DRAW_BUFFER_LINES must divide the display height");
+
+      lv_disp_buf_t disp_buf_2;
+      lv_color_t buf2_1[LV_HOR_RES_MAX * nbWriteLines];
+#if LVGL_DRAW_BUFFER_DOUBLE
+      lv_color_t buf2_2[LV_HOR_RES_MAX * nbWriteLines];
+#endif
+
+      lv_disp_drv_t disp_drv;
+      lv_disp_t* display = nullptr;
+      lv_indev_t* touchpad = nullptr;
+      bool tasksSuspended = false;
+      lv_task_prio_t refreshTaskPriority = LV_TASK_PRIO_MID;
+      lv_task_prio_t readTaskPriority = LV_TASK_PRIO_HIGH;
+      SemaphoreHandle_t flushCompleteSemaphore = nullptr;
 
       static constexpr uint8_t MaxScrollOffset() {
         return LV_VER_RES_MAX - nbWriteLines;
@@ -62,6 +135,10 @@ namespace Pinetime {
       uint16_t writeOffset = 0;
       uint16_t scrollOffset = 0;
 
+      // Small reads (font glyphs, image lines) are served from this cache
+      Pinetime::Controllers::ResourceCache resourceCache;
+      bool pinResources = false;
+
       lv_point_t touchPoint = {};
       bool tapped = false;
       bool isCancelled = false;
@@ -0,0 +1,161 @@
+#include "displayapp/ScreenArena.h"
+#include "displayapp/ScreenArenaHooks.h"
+#include <FreeRTOS.h>
+#include <algorithm>
+#include <libraries/log/nrf_log.h>
+
+using namespace Pinetime::Applications;
+
+namespace {
+  ScreenArena* screenArena = nullptr;
+
+  constexpr size_t Align(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+  }
+}
+
+static_assert(ScreenArena::maxSize <= UINT16_MAX, "The high-water marks are stored on 16 bits");
+static_assert(ScreenArena::maxSize % 8 == 0, "SCREEN_ARENA_SIZE must be a multiple of 8");
+
+void ScreenArena::Init() {
+  screenArena = this;
+}
+
+void ScreenArena::Begin(Apps app) {
+  // The blocks left by the previous screen keep its arena until they're freed
+  if (buffer == nullptr) {
+    size_t highWaterMark = highWaterMarks[static_cast<size_t>(app)];
+    size_t wanted = (highWaterMark == 0) ? maxSize : std::min(maxSize, Align(highWaterMark + highWaterMark / 4));
+    if (wanted >= minSize) {
+      buffer = static_cast<uint8_t*>(pvPortMalloc(wanted));
+      if (buffer != nullptr) {
+        capacity = wanted;
+        Reset();
+      } else {
+        NRF_LOG_INFO("[ScreenArena] Cannot allocate %d bytes, the screen uses the heap", wanted);
+      }
+    }
+  }
+  this->app = app;
+  peak = used;
+  active = true;
+}
+
+void ScreenArena::End() {
+  if (!active) {
+    return;
+  }
+  active = false;
+  auto& highWaterMark = highWaterMarks[static_cast<size_t>(app)];
+  highWaterMark = std::max<uint16_t>(highWaterMark, peak);
+  NRF_LOG_INFO("[ScreenArena] App %d: %d bytes (max %d)", static_cast<int>(app), peak, highWaterMark);
+
+  // Resetting the arena while a block is still in use would corrupt it: the blocks that the screen didn't free stay
+  // where they are, and the arena is reset once they're freed
+  if (liveBlocks > 0) {
+    NRF_LOG_INFO("[ScreenArena] App %d left %d blocks allocated", static_cast<int>(app), liveBlocks);
+    return;
+  }
+  Release();
+}
+
+void* ScreenArena::Allocate(size_t size) {
+  if (screenArena != nullptr && screenArena->active && screenArena->buffer != nullptr) {
+    void* ptr = screenArena->AllocateBlock(size);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+    screenArena->overflows++;
+  }
+  return pvPortMalloc(size);
+}
+
+void ScreenArena::Free(void* ptr) {
+  if (screenArena != nullptr && screenArena->Contains(ptr)) {
+    screenArena->FreeBlock(ptr);
+    return;
+  }
+  vPortFree(ptr);
+}
+
+Apps ScreenArena::LargestApp() const {
+  return static_cast<Apps>(std::max_element(highWaterMarks.begin(), highWaterMarks.end()) - highWaterMarks.begin());
+}
+
+// First fit: the adjacent free blocks are merged while searching
+void* ScreenArena::AllocateBlock(size_t size) {
+  size_t needed = Align(size) + sizeof(Block);
+  size_t offset = firstFree;
+  size_t firstFreeSeen = capacity;
+  while (offset < capacity) {
+    Block* block = BlockAt(offset);
+    if (block->used == 0) {
+      for (size_t next = offset + block->size; next < capacity && BlockAt(next)->used == 0; next = offset + block->size) {
+        block->size += BlockAt(next)->size;
+      }
+      firstFreeSeen = std::min(firstFreeSeen, offset);
+      if (block->size >= needed) {
+        if (block->size - needed >= minBlockSize) {
+          Block* remainder = BlockAt(offset + needed);
+          remainder->size = block->size - needed;
+          remainder->used = 0;
+          block->size = needed;
+        }
+        block->used = 1;
+        // The blocks before firstFreeSeen are in use: the next search can start after them
+        firstFree = (firstFreeSeen == offset) ? offset + block->size : firstFreeSeen;
+        used += block->size;
+        liveBlocks++;
+        peak = std::max(peak, used);
+        return block + 1;
+      }
+    }
+    offset += block->size;
+  }
+  firstFree = firstFreeSeen;
+  return nullptr;
+}
+
+void ScreenArena::FreeBlock(void* ptr) {
+  Block* block = static_cast<Block*>(ptr) - 1;
+  block->used = 0;
+  used -= block->size;
+  liveBlocks--;
+  firstFree = std::min(firstFree, static_cast<size_t>(reinterpret_cast<uint8_t*>(block) - buffer));
+  if (liveBlocks == 0 && !active) {
+    Release();
+  }
+}
+
+bool ScreenArena::Contains(const void* ptr) const {
+  auto* bytes = static_cast<const uint8_t*>(ptr);
+  return buffer != nullptr && bytes >= buffer && bytes < buffer + capacity;
+}
+
+void ScreenArena::Reset() {
+  Block* block = BlockAt(0);
+  block->size = capacity;
+  block->used = 0;
+  used = 0;
+  firstFree = 0;
+}
+
+void ScreenArena::Release() {
+  vPortFree(buffer);
+  buffer = nullptr;
+  capacity = 0;
+  used = 0;
+  firstFree = 0;
+}
+
+ScreenArena::Block* ScreenArena::BlockAt(size_t offset) const {
+  return reinterpret_cast<Block*>(buffer + offset);
+}
+
+void* ScreenArenaMalloc(size_t size) {
+  return ScreenArena::Allocate(size);
+}
+
+void ScreenArenaFree(void* ptr) {
+  ScreenArena::Free(ptr);
+}
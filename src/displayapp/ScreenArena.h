@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "displayapp/apps/Apps.h"
+
+#ifndef SCREEN_ARENA_SIZE
+  #define SCREEN_ARENA_SIZE (12 * 1024)
+#endif
+
+namespace Pinetime {
+  namespace Applications {
+    // Memory of the displayed screen: the Screen object and its LVGL objects are allocated in a block of the FreeRTOS
+    // heap, instead of being mixed with the allocations of the other tasks. When the screen is destroyed, everything
+    // it allocated has been freed and the block is released as a whole, so the fragmentation caused by a screen never
+    // outlives it.
+    // The block is allocated when the screen is created: maxSize bytes the first time an app is displayed, then its
+    // high-water mark with a margin, so that the memory reserved for a screen is close to what it uses.
+    // The allocations go to the heap while no screen is being created or displayed, when the arena is full, and when
+    // the block can't be allocated. Only used from the display task, like LVGL.
+    class ScreenArena {
+    public:
+      static constexpr size_t maxSize = SCREEN_ARENA_SIZE;
+      static constexpr size_t nbApps = static_cast<size_t>(Apps::Error) + 1;
+
+      // Routes the allocations of the screens and LVGL to the arena
+      void Init();
+
+      // Called before the screen of app is created and after it's destroyed
+      void Begin(Apps app);
+      void End();
+
+      static void* Allocate(size_t size);
+      static void Free(void* ptr);
+
+      // Size of the block of the displayed screen, 0 if it uses the heap
+      size_t Capacity() const {
+        return capacity;
+      }
+
+      // Bytes used in the arena, including the headers of the blocks
+      size_t Used() const {
+        return used;
+      }
+
+      // Largest usage of the arena by a screen of the app since the startup
+      size_t HighWaterMark(Apps app) const {
+        return highWaterMarks[static_cast<size_t>(app)];
+      }
+
+      // App with the largest high-water mark
+      Apps LargestApp() const;
+
+      // Allocations that went to the heap because the arena was full
+      uint32_t Overflows() const {
+        return overflows;
+      }
+
+    private:
+      struct alignas(8) Block {
+        uint32_t size; // Including this header
+        uint32_t used;
+      };
+
+      static constexpr size_t minBlockSize = 2 * sizeof(Block);
+      // Screens that use less than this allocate in the heap, a block of their own isn't worth it
+      static constexpr size_t minSize = 512;
+
+      void* AllocateBlock(size_t size);
+      void FreeBlock(void* ptr);
+      bool Contains(const void* ptr) const;
+      void Reset();
+      void Release();
+      Block* BlockAt(size_t offset) const;
+
+      uint8_t* buffer = nullptr;
+      size_t capacity = 0;
+      bool active = false;
+      Apps app = Apps::None;
+      size_t used = 0;
+      size_t liveBlocks = 0;
+      size_t peak = 0;
+      // Offset of the first block that can be free: the search of a free block starts there
+      size_t firstFree = 0;
+      uint32_t overflows = 0;
+      std::array<uint16_t, nbApps> highWaterMarks {};
+    };
+  }
+}
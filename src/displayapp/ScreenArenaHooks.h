@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+// Allocation functions of LVGL (LV_MEM_CUSTOM_ALLOC and LV_MEM_CUSTOM_FREE in lv_conf.h): the objects created by the
+// screens are allocated in the screen arena (see Pinetime::Applications::ScreenArena).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* ScreenArenaMalloc(size_t size);
+void ScreenArenaFree(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,8 +27,9 @@ Notifications::Notifications(DisplayApp* app,
   auto notification = notificationManager.GetLastNotification();
   if (notification.valid) {
     currentId = notification.id;
-    currentItem = std::make_unique<NotificationItem>(notification.Title(),
-                                                     notification.Message(),
+    notificationManager.Load(currentId, message);
+    currentItem = std::make_unique<NotificationItem>(message.Title(),
+                                                     message.Message(),
                                                      1,
                                                      notification.category,
                                                      notificationManager.NbNotifications(),
@@ -105,8 +106,9 @@ void Notifications::Refresh() {
 
     if (validDisplay) {
       Controllers::NotificationManager::Notification::Idx currentIdx = notificationManager.IndexOf(currentId);
-      currentItem = std::make_unique<NotificationItem>(notification.Title(),
-                                                       notification.Message(),
+      notificationManager.Load(currentId, message);
+      currentItem = std::make_unique<NotificationItem>(message.Title(),
+                                                       message.Message(),
                                                        currentIdx + 1,
                                                        notification.category,
                                                        notificationManager.NbNotifications(),
@@ -180,7 +182,7 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
       }
       return false;
     case Pinetime::Applications::TouchEvents::SwipeDown: {
-      Controllers::NotificationManager::Notification previousNotification;
+      Controllers::NotificationManager::Handle previousNotification;
       if (validDisplay) {
         previousNotification = notificationManager.GetPrevious(currentId);
       } else {
@@ -196,8 +198,9 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
       validDisplay = true;
       currentItem.reset(nullptr);
       app->SetFullRefresh(DisplayApp::FullRefreshDirections::Down);
-      currentItem = std::make_unique<NotificationItem>(previousNotification.Title(),
-                                                       previousNotification.Message(),
+      notificationManager.Load(currentId, message);
+      currentItem = std::make_unique<NotificationItem>(message.Title(),
+                                                       message.Message(),
                                                        currentIdx + 1,
                                                        previousNotification.category,
                                                        notificationManager.NbNotifications(),
@@ -206,7 +209,7 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
     }
       return true;
     case Pinetime::Applications::TouchEvents::SwipeUp: {
-      Controllers::NotificationManager::Notification nextNotification;
+      Controllers::NotificationManager::Handle nextNotification;
       if (validDisplay) {
         nextNotification = notificationManager.GetNext(currentId);
       } else {
@@ -223,8 +226,9 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
       validDisplay = true;
       currentItem.reset(nullptr);
       app->SetFullRefresh(DisplayApp::FullRefreshDirections::Up);
-      currentItem = std::make_unique<NotificationItem>(nextNotification.Title(),
-                                                       nextNotification.Message(),
+      notificationManager.Load(currentId, message);
+      currentItem = std::make_unique<NotificationItem>(message.Title(),
+                                                       message.Message(),
                                                        currentIdx + 1,
                                                        nextNotification.category,
                                                        notificationManager.NbNotifications(),
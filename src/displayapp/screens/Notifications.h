@@ -77,6 +77,8 @@ namespace Pinetime {
         Modes mode = Modes::Normal;
         std::unique_ptr<NotificationItem> currentItem;
         Pinetime::Controllers::NotificationManager::Notification::Id currentId;
+        // The message of the displayed notification, read from the log. It only takes RAM while this screen is open.
+        Pinetime::Controllers::NotificationManager::Notification message;
         bool validDisplay = false;
         bool afterDismissNextMessageFromAbove = false;
 
@@ -1,6 +1,15 @@
 #include "displayapp/screens/Screen.h"
+#include "displayapp/ScreenArena.h"
 using namespace Pinetime::Applications::Screens;
 
 void Screen::RefreshTaskCallback(lv_task_t* task) {
   static_cast<Screen*>(task->user_data)->Refresh();
 }
+
+void* Screen::operator new(size_t size) {
+  return ScreenArena::Allocate(size);
+}
+
+void Screen::operator delete(void* ptr) {
+  ScreenArena::Free(ptr);
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include "displayapp/TouchEvents.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include <lvgl/lvgl.h>
 
 namespace Pinetime {
@@ -10,17 +12,36 @@ namespace Pinetime {
 
     namespace Screens {
       class Screen {
-      private:
-        virtual void Refresh() {
-        }
-
       public:
         explicit Screen() = default;
 
         virtual ~Screen() = default;
 
+        // The screens are allocated in the screen arena, with their LVGL objects (see ScreenArena)
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
+        virtual void Refresh() {
+        }
+
         static void RefreshTaskCallback(lv_task_t* task);
 
+        // Screens that don't poll their data with a refresh task return the changes they display (see
+        // Controllers::ChangeNotifier). DisplayApp then calls Refresh() when one of them is published, when the
+        // displayed time changes (every minute, or every second if DisplaysSeconds() returns true), and at the display
+        // refresh rate while IsAnimating() returns true.
+        virtual Controllers::ChangeNotifier::Mask Subscriptions() const {
+          return 0;
+        }
+
+        virtual bool DisplaysSeconds() const {
+          return false;
+        }
+
+        virtual bool IsAnimating() const {
+          return false;
+        }
+
         bool IsRunning() const {
           return running;
         }
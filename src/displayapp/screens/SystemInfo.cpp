@@ -1,9 +1,13 @@
 #include <FreeRTOS.h>
 #include <algorithm>
+#include <cstring>
 #include <task.h>
 #include "displayapp/screens/SystemInfo.h"
 #include <lvgl/lvgl.h>
 #include "displayapp/DisplayApp.h"
+#include "displayapp/ScreenArena.h"
+#include "displayapp/LittleVgl.h"
+#include "FreeRTOS/heap_4_infinitime.h"
 #include "displayapp/screens/Label.h"
 #include "Version.h"
 #include "BootloaderVersion.h"
@@ -12,6 +16,10 @@
 #include "components/brightness/BrightnessController.h"
 #include "components/datetime/DateTimeController.h"
 #include "components/motion/MotionController.h"
+#include "components/fs/FS.h"
+#include "components/fs/ResourceCache.h"
+#include "components/profiling/FrameProfiler.h"
+#include "systemtask/SystemMonitor.h"
 #include "drivers/Watchdog.h"
 #include "displayapp/InfiniTimeTheme.h"
 
@@ -29,6 +37,23 @@ namespace {
     }
     return "???";
   }
+
+  void AppName(Pinetime::Applications::Apps app, char* buffer, size_t size) {
+    switch (app) {
+      case Pinetime::Applications::Apps::Clock:
+        snprintf(buffer, size, "Clock");
+        break;
+      case Pinetime::Applications::Apps::Launcher:
+        snprintf(buffer, size, "Launcher");
+        break;
+      case Pinetime::Applications::Apps::SysInfo:
+        snprintf(buffer, size, "SysInfo");
+        break;
+      default:
+        snprintf(buffer, size, "App %u", static_cast<unsigned>(app));
+        break;
+    }
+  }
 }
 
 SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
@@ -38,7 +63,11 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
                        const Pinetime::Controllers::Ble& bleController,
                        const Pinetime::Drivers::Watchdog& watchdog,
                        Pinetime::Controllers::MotionController& motionController,
-                       const Pinetime::Drivers::Cst816S& touchPanel)
+                       const Pinetime::Drivers::Cst816S& touchPanel,
+                       const Pinetime::Controllers::FrameProfiler& frameProfiler,
+                       const Pinetime::Applications::ScreenArena& screenArena,
+                       const Pinetime::System::SystemMonitor& systemMonitor,
+                       const Pinetime::Components::LittleVgl& lvgl)
   : app {app},
     dateTimeController {dateTimeController},
     batteryController {batteryController},
@@ -47,6 +76,10 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
     watchdog {watchdog},
     motionController {motionController},
     touchPanel {touchPanel},
+    frameProfiler {frameProfiler},
+    screenArena {screenArena},
+    systemMonitor {systemMonitor},
+    lvgl {lvgl},
     screens {app,
              0,
              {[this]() -> std::unique_ptr<Screen> {
@@ -63,6 +96,18 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
               },
               [this]() -> std::unique_ptr<Screen> {
                 return CreateScreen5();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen6();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen7();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen8();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen9();
               }},
              Screens::ScreenListModes::UpDown} {
 }
@@ -96,7 +141,7 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen1() {
                         BootloaderVersion::VersionString());
   lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(0, 5, label);
+  return std::make_unique<Screens::Label>(0, 9, label);
 }
 
 std::unique_ptr<Screen> SystemInfo::CreateScreen2() {
@@ -175,7 +220,7 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen2() {
                         touchPanel.GetFwVersion(),
                         TARGET_DEVICE_NAME);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(1, 5, label);
+  return std::make_unique<Screens::Label>(1, 9, label);
 }
 
 extern int mallocFailedCount;
@@ -183,6 +228,9 @@ extern int stackOverflowCount;
 std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
   lv_mem_monitor_t mon;
   lv_mem_monitor(&mon);
+  Apps largestApp = screenArena.LargestApp();
+  char largestAppName[12];
+  AppName(largestApp, largestAppName, sizeof(largestAppName));
 
   lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
   lv_label_set_recolor(label, true);
@@ -191,12 +239,15 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
                         "#808080 BLE MAC#\n"
                         " %02x:%02x:%02x:%02x:%02x:%02x"
                         "\n"
-                        "\n"
                         "#808080 Memory heap#\n"
                         " #808080 Free# %d\n"
                         " #808080 Min free# %d\n"
                         " #808080 Alloc err# %d\n"
-                        " #808080 Ovrfl err# %d\n",
+                        " #808080 Ovrfl err# %d\n"
+                        "#808080 Screen arena#\n"
+                        " #808080 Used# %d/%d\n"
+                        " #808080 Max# %d %s\n"
+                        " #808080 Overflows# %lu\n",
                         bleAddr[5],
                         bleAddr[4],
                         bleAddr[3],
@@ -206,9 +257,14 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
                         xPortGetFreeHeapSize(),
                         xPortGetMinimumEverFreeHeapSize(),
                         mallocFailedCount,
-                        stackOverflowCount);
+                        stackOverflowCount,
+                        screenArena.Used(),
+                        screenArena.Capacity(),
+                        screenArena.HighWaterMark(largestApp),
+                        largestAppName,
+                        screenArena.Overflows());
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(2, 5, label);
+  return std::make_unique<Screens::Label>(2, 9, label);
 }
 
 bool SystemInfo::sortById(const TaskStatus_t& lhs, const TaskStatus_t& rhs) {
@@ -269,10 +325,189 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen4() {
     }
     lv_table_set_cell_value(infoTask, i + 1, 3, buffer);
   }
-  return std::make_unique<Screens::Label>(3, 5, infoTask);
+  return std::make_unique<Screens::Label>(3, 9, infoTask);
 }
 
 std::unique_ptr<Screen> SystemInfo::CreateScreen5() {
+  static constexpr uint8_t maxTaskCount = 8;
+  std::array<System::SystemMonitor::Task, System::SystemMonitor::maxTasks> tasks;
+  std::array<System::SystemMonitor::Sample, System::SystemMonitor::historySize> samples;
+  size_t nbSamples = systemMonitor.GetHistory(samples);
+  size_t nbTasks = std::min<size_t>(systemMonitor.GetTasks(tasks), maxTaskCount);
+
+  lv_obj_t* infoLoad = lv_table_create(lv_scr_act(), nullptr);
+  lv_table_set_col_cnt(infoLoad, 3);
+  lv_table_set_row_cnt(infoLoad, nbTasks + 2);
+  lv_obj_set_style_local_pad_all(infoLoad, LV_TABLE_PART_CELL1, LV_STATE_DEFAULT, 0);
+  lv_obj_set_style_local_border_color(infoLoad, LV_TABLE_PART_CELL1, LV_STATE_DEFAULT, Colors::lightGray);
+
+  lv_table_set_cell_value(infoLoad, 0, 0, "Load %");
+  lv_table_set_col_width(infoLoad, 0, 100);
+  lv_table_set_cell_value(infoLoad, 0, 1, "Now");
+  lv_table_set_col_width(infoLoad, 1, 65);
+  lv_table_set_cell_value(infoLoad, 0, 2, "Avg"); // Average of the history (2 minutes)
+  lv_table_set_col_width(infoLoad, 2, 65);
+
+  // The first row is the tickless sleep, the others are the tasks. Loads are in tenths of percents.
+  auto loadOf = [](const System::SystemMonitor::Sample& sample, size_t row) -> uint16_t {
+    return (row == 0) ? sample.sleep : sample.loads[row - 1];
+  };
+  for (size_t row = 0; row <= nbTasks; row++) {
+    lv_table_set_cell_value(infoLoad, row + 1, 0, (row == 0) ? "Sleep" : tasks[row - 1].name);
+    if (nbSamples == 0) {
+      continue;
+    }
+    char buffer[8];
+    uint16_t now = loadOf(samples[0], row);
+    snprintf(buffer, sizeof(buffer), "%u.%u", now / 10, now % 10);
+    lv_table_set_cell_value(infoLoad, row + 1, 1, buffer);
+
+    uint32_t total = 0;
+    for (size_t i = 0; i < nbSamples; i++) {
+      total += loadOf(samples[i], row);
+    }
+    uint32_t average = total / nbSamples;
+    snprintf(buffer, sizeof(buffer), "%" PRIu32 ".%" PRIu32, average / 10, average % 10);
+    lv_table_set_cell_value(infoLoad, row + 1, 2, buffer);
+  }
+  return std::make_unique<Screens::Label>(4, 9, infoLoad);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen6() {
+  std::array<Controllers::FrameProfiler::Summary, Controllers::FrameProfiler::nbScreens> summaries;
+  size_t nbSummaries = frameProfiler.GetSummaries(summaries);
+
+  // The first summary is this screen, the previous screens are more interesting
+  static constexpr size_t lineSize = 40;
+  char text[lineSize * 3 * Controllers::FrameProfiler::nbScreens] = "#FFFF00 Frames# (render/flush ms)\n";
+  for (size_t i = 1; i < nbSummaries; i++) {
+    const auto& summary = summaries[i];
+    char name[12];
+    AppName(static_cast<Apps>(summary.screen), name, sizeof(name));
+    size_t length = strlen(text);
+    snprintf(text + length,
+             sizeof(text) - length,
+             "#808080 %s# %" PRIu32 " fr %u.%u fps\n"
+             " %" PRIu32 ".%" PRIu32 "/%" PRIu32 ".%" PRIu32 " %" PRIu32 ".%" PRIu32 "/%" PRIu32 ".%" PRIu32 "\n"
+             " %" PRIu32 " B %u ar %u cmd\n",
+             name,
+             summary.frames,
+             summary.frameRate / 10,
+             summary.frameRate % 10,
+             summary.averageRenderUs / 1000,
+             (summary.averageRenderUs / 100) % 10,
+             summary.maxRenderUs / 1000,
+             (summary.maxRenderUs / 100) % 10,
+             summary.averageFlushUs / 1000,
+             (summary.averageFlushUs / 100) % 10,
+             summary.maxFlushUs / 1000,
+             (summary.maxFlushUs / 100) % 10,
+             summary.averageBytes,
+             summary.averageAreas,
+             summary.averageCommands);
+  }
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text(label, text);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(5, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen7() {
+  HeapStats_t stats;
+  vPortGetHeapStats(&stats);
+  HeapFailure_t failure;
+  bool failed = xPortGetLastHeapFailure(&failure) != 0;
+  static constexpr size_t nbCallSites = 3;
+  HeapCallSite_t callSites[nbCallSites];
+  size_t nbFound = xPortGetHeapCallSites(callSites, nbCallSites);
+
+  char text[400];
+  int length = snprintf(text,
+                        sizeof(text),
+                        "#FFFF00 Heap# %u #808080 min# %u\n"
+                        "#808080 Largest# %u #808080 in# %u\n"
+                        "#808080 By size# (32B..4K+)\n"
+                        " %u %u %u %u %u %u %u %u %u\n",
+                        stats.xAvailableHeapSpaceInBytes,
+                        stats.xMinimumEverFreeBytesRemaining,
+                        stats.xSizeOfLargestFreeBlockInBytes,
+                        stats.xNumberOfFreeBlocks,
+                        stats.usFreeBlockHistogram[0],
+                        stats.usFreeBlockHistogram[1],
+                        stats.usFreeBlockHistogram[2],
+                        stats.usFreeBlockHistogram[3],
+                        stats.usFreeBlockHistogram[4],
+                        stats.usFreeBlockHistogram[5],
+                        stats.usFreeBlockHistogram[6],
+                        stats.usFreeBlockHistogram[7],
+                        stats.usFreeBlockHistogram[8]);
+  if (failed) {
+    char name[12];
+    AppName(static_cast<Apps>(failure.ucContext), name, sizeof(name));
+    length += snprintf(text + length,
+                       sizeof(text) - length,
+                       "#808080 Failed# %u B %s\n"
+                       " #808080 in# %s #808080 lrg# %u\n",
+                       failure.xWantedSize,
+                       failure.pcTaskName,
+                       name,
+                       failure.xLargestFreeBlock);
+  }
+  // The call sites using the most memory at their peak: use addr2line to find the functions
+  length += snprintf(text + length, sizeof(text) - length, "#808080 Call sites# (peak)\n");
+  for (size_t i = 0; i < nbFound; i++) {
+    length += snprintf(text + length,
+                       sizeof(text) - length,
+                       " %08" PRIxPTR " %u\n",
+                       callSites[i].uxAddress,
+                       callSites[i].xPeakLiveBytes);
+  }
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text(label, text);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(6, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen8() {
+  const auto& stats = lvgl.ResourceCacheStatistics();
+  uint32_t lookups = stats.hits + stats.misses;
+  uint32_t hitRate = (lookups == 0) ? 0 : static_cast<uint32_t>((uint64_t {stats.hits} * 100) / lookups);
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text_fmt(label,
+                        "#FFFF00 Resource cache#
+"
+                        "#808080 FS profile# %s
+"
+                        "#808080 Size# %d B
+"
+                        "#808080 Hits# %lu
+"
+                        "#808080 Misses# %lu
+"
+                        "#808080 Hit rate# %lu%%
+"
+                        "#808080 Evictions# %lu
+"
+                        "#808080 Bypassed# %lu
+",
+                        Pinetime::Controllers::FS::profile.name,
+                        Pinetime::Controllers::ResourceCache::nbBlocks * Pinetime::Controllers::ResourceCache::blockSize,
+                        stats.hits,
+                        stats.misses,
+                        hitRate,
+                        stats.evictions,
+                        stats.bypassed);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(7, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen9() {
   lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
   lv_label_set_recolor(label, true);
   lv_label_set_text_static(label,
@@ -286,5 +521,5 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen5() {
                            "#FFFF00 InfiniTime#");
   lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(4, 5, label);
+  return std::make_unique<Screens::Label>(8, 9, label);
 }
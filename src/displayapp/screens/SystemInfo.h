@@ -10,14 +10,24 @@ namespace Pinetime {
     class Battery;
     class BrightnessController;
     class Ble;
+    class FrameProfiler;
   }
 
   namespace Drivers {
     class Watchdog;
   }
 
+  namespace Components {
+    class LittleVgl;
+  }
+
+  namespace System {
+    class SystemMonitor;
+  }
+
   namespace Applications {
     class DisplayApp;
+    class ScreenArena;
 
     namespace Screens {
       class SystemInfo : public Screen {
@@ -29,7 +39,11 @@ namespace Pinetime {
                             const Pinetime::Controllers::Ble& bleController,
                             const Pinetime::Drivers::Watchdog& watchdog,
                             Pinetime::Controllers::MotionController& motionController,
-                            const Pinetime::Drivers::Cst816S& touchPanel);
+                            const Pinetime::Drivers::Cst816S& touchPanel,
+                            const Pinetime::Controllers::FrameProfiler& frameProfiler,
+                            const ScreenArena& screenArena,
+                            const Pinetime::System::SystemMonitor& systemMonitor,
+                            const Pinetime::Components::LittleVgl& lvgl);
         ~SystemInfo() override;
         bool OnTouchEvent(TouchEvents event) override;
 
@@ -42,8 +56,12 @@ namespace Pinetime {
         const Pinetime::Drivers::Watchdog& watchdog;
         Pinetime::Controllers::MotionController& motionController;
         const Pinetime::Drivers::Cst816S& touchPanel;
+        const Pinetime::Controllers::FrameProfiler& frameProfiler;
+        const ScreenArena& screenArena;
+        const Pinetime::System::SystemMonitor& systemMonitor;
+        const Pinetime::Components::LittleVgl& lvgl;
 
-        ScreenList<5> screens;
+        ScreenList<9> screens;
 
         static bool sortById(const TaskStatus_t& lhs, const TaskStatus_t& rhs);
 
@@ -52,6 +70,10 @@ namespace Pinetime {
         std::unique_ptr<Screen> CreateScreen3();
         std::unique_ptr<Screen> CreateScreen4();
         std::unique_ptr<Screen> CreateScreen5();
+        std::unique_ptr<Screen> CreateScreen6();
+        std::unique_ptr<Screen> CreateScreen7();
+        std::unique_ptr<Screen> CreateScreen8();
+        std::unique_ptr<Screen> CreateScreen9();
       };
     }
   }
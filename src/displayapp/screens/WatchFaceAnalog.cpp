@@ -154,14 +154,10 @@ WatchFaceAnalog::WatchFaceAnalog(Controllers::DateTime& dateTimeController,
   lv_style_set_line_rounded(&hour_line_style_trace, LV_STATE_DEFAULT, false);
   lv_obj_add_style(hour_body_trace, LV_LINE_PART_MAIN, &hour_line_style_trace);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
-
   Refresh();
 }
 
 WatchFaceAnalog::~WatchFaceAnalog() {
-  lv_task_del(taskRefresh);
-
   lv_style_reset(&hour_line_style);
   lv_style_reset(&hour_line_style_trace);
   lv_style_reset(&minute_line_style);
@@ -218,6 +214,16 @@ void WatchFaceAnalog::SetBatteryIcon() {
   batteryIcon.SetBatteryPercentage(batteryPercent);
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFaceAnalog::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time, Changes::Battery, Changes::Ble, Changes::Notifications);
+}
+
+bool WatchFaceAnalog::DisplaysSeconds() const {
+  return true;
+}
+
 void WatchFaceAnalog::Refresh() {
   isCharging = batteryController.IsCharging();
   if (isCharging.IsUpdated()) {
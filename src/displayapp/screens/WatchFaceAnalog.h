@@ -34,6 +34,8 @@ namespace Pinetime {
         ~WatchFaceAnalog() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
+        bool DisplaysSeconds() const override;
 
       private:
         uint8_t sHour, sMinute, sSecond;
@@ -83,8 +85,6 @@ namespace Pinetime {
 
         void UpdateClock();
         void SetBatteryIcon();
-
-        lv_task_t* taskRefresh;
       };
     }
 
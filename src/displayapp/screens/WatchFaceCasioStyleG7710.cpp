@@ -32,19 +32,15 @@ WatchFaceCasioStyleG7710::WatchFaceCasioStyleG7710(Controllers::DateTime& dateTi
     heartRateController {heartRateController},
     motionController {motionController} {
 
-  lfs_file f = {};
-  if (filesystem.FileOpen(&f, "/fonts/lv_font_dots_40.bin", LFS_O_RDONLY) >= 0) {
-    filesystem.FileClose(&f);
+  if (filesystem.ResourceExists("/fonts/lv_font_dots_40.bin")) {
     font_dot40 = lv_font_load("F:/fonts/lv_font_dots_40.bin");
   }
 
-  if (filesystem.FileOpen(&f, "/fonts/7segments_40.bin", LFS_O_RDONLY) >= 0) {
-    filesystem.FileClose(&f);
+  if (filesystem.ResourceExists("/fonts/7segments_40.bin")) {
     font_segment40 = lv_font_load("F:/fonts/7segments_40.bin");
   }
 
-  if (filesystem.FileOpen(&f, "/fonts/7segments_115.bin", LFS_O_RDONLY) >= 0) {
-    filesystem.FileClose(&f);
+  if (filesystem.ResourceExists("/fonts/7segments_115.bin")) {
     font_segment115 = lv_font_load("F:/fonts/7segments_115.bin");
   }
 
@@ -168,13 +164,10 @@ WatchFaceCasioStyleG7710::WatchFaceCasioStyleG7710(Controllers::DateTime& dateTi
   lv_label_set_text_static(stepIcon, Symbols::shoe);
   lv_obj_align(stepIcon, stepValue, LV_ALIGN_OUT_LEFT_MID, -5, 0);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceCasioStyleG7710::~WatchFaceCasioStyleG7710() {
-  lv_task_del(taskRefresh);
-
   lv_style_reset(&style_line);
   lv_style_reset(&style_border);
 
@@ -193,6 +186,12 @@ WatchFaceCasioStyleG7710::~WatchFaceCasioStyleG7710() {
   lv_obj_clean(lv_scr_act());
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFaceCasioStyleG7710::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time, Changes::Battery, Changes::Ble, Changes::Notifications, Changes::HeartRate, Changes::Steps);
+}
+
 void WatchFaceCasioStyleG7710::Refresh() {
   powerPresent = batteryController.IsPowerPresent();
   if (powerPresent.IsUpdated()) {
@@ -313,22 +312,7 @@ void WatchFaceCasioStyleG7710::Refresh() {
 }
 
 bool WatchFaceCasioStyleG7710::IsAvailable(Pinetime::Controllers::FS& filesystem) {
-  lfs_file file = {};
-
-  if (filesystem.FileOpen(&file, "/fonts/lv_font_dots_40.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  if (filesystem.FileOpen(&file, "/fonts/7segments_40.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  if (filesystem.FileOpen(&file, "/fonts/7segments_115.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  return true;
+  return filesystem.ResourceExists("/fonts/lv_font_dots_40.bin") &&
+         filesystem.ResourceExists("/fonts/7segments_40.bin") &&
+         filesystem.ResourceExists("/fonts/7segments_115.bin");
 }
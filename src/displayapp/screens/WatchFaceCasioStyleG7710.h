@@ -38,6 +38,7 @@ namespace Pinetime {
         ~WatchFaceCasioStyleG7710() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
 
         static bool IsAvailable(Pinetime::Controllers::FS& filesystem);
 
@@ -94,8 +95,6 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
-
-        lv_task_t* taskRefresh;
         lv_font_t* font_dot40 = nullptr;
         lv_font_t* font_segment40 = nullptr;
         lv_font_t* font_segment115 = nullptr;
@@ -84,15 +84,25 @@ WatchFaceDigital::WatchFaceDigital(Controllers::DateTime& dateTimeController,
   lv_label_set_text_static(stepIcon, Symbols::shoe);
   lv_obj_align(stepIcon, stepValue, LV_ALIGN_OUT_LEFT_MID, -5, 0);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceDigital::~WatchFaceDigital() {
-  lv_task_del(taskRefresh);
   lv_obj_clean(lv_scr_act());
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFaceDigital::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time,
+                                Changes::Battery,
+                                Changes::Ble,
+                                Changes::Notifications,
+                                Changes::HeartRate,
+                                Changes::Steps,
+                                Changes::Weather);
+}
+
 void WatchFaceDigital::Refresh() {
   statusIcons.Update();
 
@@ -38,6 +38,7 @@ namespace Pinetime {
         ~WatchFaceDigital() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
 
       private:
         uint8_t displayedHour = -1;
@@ -69,8 +70,6 @@ namespace Pinetime {
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
         Controllers::SimpleWeatherService& weatherService;
-
-        lv_task_t* taskRefresh;
         Widgets::StatusIcons statusIcons;
       };
     }
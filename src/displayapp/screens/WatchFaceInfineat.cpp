@@ -133,14 +133,11 @@ WatchFaceInfineat::WatchFaceInfineat(Controllers::DateTime& dateTimeController,
     notificationManager {notificationManager},
     settingsController {settingsController},
     motionController {motionController} {
-  lfs_file f = {};
-  if (filesystem.FileOpen(&f, "/fonts/teko.bin", LFS_O_RDONLY) >= 0) {
-    filesystem.FileClose(&f);
+  if (filesystem.ResourceExists("/fonts/teko.bin")) {
     font_teko = lv_font_load("F:/fonts/teko.bin");
   }
 
-  if (filesystem.FileOpen(&f, "/fonts/bebas.bin", LFS_O_RDONLY) >= 0) {
-    filesystem.FileClose(&f);
+  if (filesystem.ResourceExists("/fonts/bebas.bin")) {
     font_bebas = lv_font_load("F:/fonts/bebas.bin");
   }
 
@@ -296,13 +293,10 @@ WatchFaceInfineat::WatchFaceInfineat(Controllers::DateTime& dateTimeController,
   lv_label_set_text_static(labelBtnSettings, Symbols::settings);
   lv_obj_set_hidden(btnSettings, true);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceInfineat::~WatchFaceInfineat() {
-  lv_task_del(taskRefresh);
-
   if (font_bebas != nullptr) {
     lv_font_free(font_bebas);
   }
@@ -390,6 +384,16 @@ void WatchFaceInfineat::UpdateSelected(lv_obj_t* object, lv_event_t event) {
   }
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFaceInfineat::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time, Changes::Battery, Changes::Ble, Changes::Notifications, Changes::Steps);
+}
+
+bool WatchFaceInfineat::IsAnimating() const {
+  return batteryController.IsCharging() || !lv_obj_get_hidden(btnSettings);
+}
+
 void WatchFaceInfineat::Refresh() {
   notificationState = notificationManager.AreNewNotificationsAvailable();
   if (notificationState.IsUpdated()) {
@@ -488,22 +492,7 @@ void WatchFaceInfineat::ToggleBatteryIndicatorColor(bool showSideCover) {
 }
 
 bool WatchFaceInfineat::IsAvailable(Pinetime::Controllers::FS& filesystem) {
-  lfs_file file = {};
-
-  if (filesystem.FileOpen(&file, "/fonts/teko.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  if (filesystem.FileOpen(&file, "/fonts/bebas.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  if (filesystem.FileOpen(&file, "/images/pine_small.bin", LFS_O_RDONLY) < 0) {
-    return false;
-  }
-
-  filesystem.FileClose(&file);
-  return true;
+  return filesystem.ResourceExists("/fonts/teko.bin") &&
+         filesystem.ResourceExists("/fonts/bebas.bin") &&
+         filesystem.ResourceExists("/images/pine_small.bin");
 }
@@ -41,6 +41,8 @@ namespace Pinetime {
         void CloseMenu();
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
+        bool IsAnimating() const override;
 
         static bool IsAvailable(Pinetime::Controllers::FS& filesystem);
 
@@ -93,8 +95,6 @@ namespace Pinetime {
 
         void SetBatteryLevel(uint8_t batteryPercent);
         void ToggleBatteryIndicatorColor(bool showSideCover);
-
-        lv_task_t* taskRefresh;
         lv_font_t* font_teko = nullptr;
         lv_font_t* font_bebas = nullptr;
       };
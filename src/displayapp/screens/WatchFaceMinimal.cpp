@@ -96,15 +96,29 @@ WatchFaceMinimal::WatchFaceMinimal(Controllers::DateTime& dateTimeController,
   lv_label_set_anim_speed(weatherLocation, 60);
 
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceMinimal::~WatchFaceMinimal() {
-  lv_task_del(taskRefresh);
   lv_obj_clean(lv_scr_act());
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFaceMinimal::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time,
+                                Changes::Battery,
+                                Changes::Ble,
+                                Changes::Notifications,
+                                Changes::HeartRate,
+                                Changes::Steps,
+                                Changes::Weather);
+}
+
+bool WatchFaceMinimal::DisplaysSeconds() const {
+  return true;
+}
+
 void WatchFaceMinimal::Refresh() {
   powerPresent = batteryController.IsPowerPresent();
   batteryPercentRemaining = batteryController.PercentRemaining();
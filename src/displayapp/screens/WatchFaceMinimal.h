@@ -36,6 +36,8 @@ namespace Pinetime {
         ~WatchFaceMinimal() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
+        bool DisplaysSeconds() const override;
 
       private:
         Utility::DirtyValue<int> batteryPercentRemaining {};
@@ -71,8 +73,6 @@ namespace Pinetime {
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
         Controllers::SimpleWeatherService& weatherService;
-
-        lv_task_t* taskRefresh;
       };
     }
 
@@ -394,12 +394,10 @@ WatchFacePineTimeStyle::WatchFacePineTimeStyle(Controllers::DateTime& dateTimeCo
   lv_label_set_text_static(lblSetOpts, Symbols::settings);
   lv_obj_set_hidden(btnSetOpts, true);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFacePineTimeStyle::~WatchFacePineTimeStyle() {
-  lv_task_del(taskRefresh);
   lv_obj_clean(lv_scr_act());
 }
 
@@ -444,6 +442,20 @@ void WatchFacePineTimeStyle::SetBatteryIcon() {
   batteryIcon.SetBatteryPercentage(batteryPercent);
 }
 
+Pinetime::Controllers::ChangeNotifier::Mask WatchFacePineTimeStyle::Subscriptions() const {
+  using Pinetime::Controllers::Changes;
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::MaskOf(Changes::Time, Changes::Battery, Changes::Ble, Changes::Notifications, Changes::Steps, Changes::Weather);
+}
+
+bool WatchFacePineTimeStyle::DisplaysSeconds() const {
+  return !lv_obj_get_hidden(timeDD3);
+}
+
+bool WatchFacePineTimeStyle::IsAnimating() const {
+  return !lv_obj_get_hidden(btnSetColor);
+}
+
 void WatchFacePineTimeStyle::Refresh() {
   isCharging = batteryController.IsCharging();
   if (isCharging.IsUpdated()) {
@@ -40,6 +40,9 @@ namespace Pinetime {
         bool OnButtonPushed() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
+        bool DisplaysSeconds() const override;
+        bool IsAnimating() const override;
 
         void UpdateSelected(lv_obj_t* object, lv_event_t event);
 
@@ -116,8 +119,6 @@ namespace Pinetime {
 
         void SetBatteryIcon();
         void CloseMenu();
-
-        lv_task_t* taskRefresh;
       };
     }
 
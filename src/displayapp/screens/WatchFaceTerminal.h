@@ -34,6 +34,8 @@ namespace Pinetime {
         ~WatchFaceTerminal() override;
 
         void Refresh() override;
+        Controllers::ChangeNotifier::Mask Subscriptions() const override;
+        bool DisplaysSeconds() const override;
 
       private:
         Utility::DirtyValue<int> batteryPercentRemaining {};
@@ -64,8 +66,6 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
-
-        lv_task_t* taskRefresh;
       };
     }
 
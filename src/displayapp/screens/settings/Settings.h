@@ -48,12 +48,12 @@ namespace Pinetime {
           {Symbols::bluetooth, "Bluetooth", Apps::SettingBluetooth},
 
           {Symbols::ccc, "Congress Mode", Apps::SettingCongressMode, true},
+          {Symbols::heartBeat, "Heart rate", Apps::SettingHeartRate},
           {Symbols::list, "About", Apps::SysInfo},
 
           // {Symbols::none, "None", Apps::None},
           // {Symbols::none, "None", Apps::None},
           // {Symbols::none, "None", Apps::None},
-          // {Symbols::none, "None", Apps::None},
 
         }};
         ScreenList<nScreens> screens;
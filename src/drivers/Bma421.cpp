@@ -1,4 +1,5 @@
 #include "drivers/Bma421.h"
+#include <algorithm>
 #include <libraries/delay/nrf_delay.h>
 #include <libraries/log/nrf_log.h>
 #include "drivers/TwiMaster.h"
@@ -32,6 +33,18 @@ namespace {
     [BMA4_ACCEL_RANGE_8G] = 256,  // LSB/g +/- 8g range
     [BMA4_ACCEL_RANGE_16G] = 128  // LSB/g +/- 16g range
   };
+
+  static_assert(Bma421::Interrupts::WristTilt == BMA423_WRIST_WEAR_INT);
+  static_assert(Bma421::Interrupts::AnyMotion == BMA423_ANY_MOT_INT);
+  static_assert(Bma421::Interrupts::FifoWatermark == BMA4_FIFO_WM_INT);
+
+  constexpr uint8_t fifoFrameSize = BMA4_FIFO_A_LENGTH;
+  constexpr uint8_t fifoFlushCommand = 0xB0;
+  // 100Hz / 2^1
+  constexpr uint8_t fifoDownsampling = 1;
+  // Any-motion: slope above 83mg (5.11g format) during 100ms (5 samples at 50Hz)
+  constexpr uint16_t anyMotionThreshold = 0xAA;
+  constexpr uint16_t anyMotionDuration = 5;
 }
 
 Bma421::Bma421(TwiMaster& twiMaster, uint8_t twiAddress) : twiMaster {twiMaster}, deviceAddress {twiAddress} {
@@ -92,6 +105,43 @@ void Bma421::Init() {
   if (ret != BMA4_OK)
     return;
 
+  // Headerless FIFO with the filtered accelerometer data only. It's only enabled while streaming.
+  ret = bma4_set_fifo_config(BMA4_FIFO_ALL, BMA4_DISABLE, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_accel_fifo_filter_data(BMA4_ENABLE, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_fifo_down_accel(fifoDownsampling, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  ret = bma4_set_fifo_wm(fifoWatermark * fifoFrameSize, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  struct bma423_any_no_mot_config anyMotion;
+  anyMotion.threshold = anyMotionThreshold;
+  anyMotion.duration = anyMotionDuration;
+  anyMotion.axes_en = BMA423_DIS_ALL_AXIS;
+  ret = bma423_set_any_mot_config(&anyMotion, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  struct bma4_int_pin_config pinConfig;
+  pinConfig.edge_ctrl = BMA4_LEVEL_TRIGGER;
+  pinConfig.lvl = BMA4_ACTIVE_HIGH;
+  pinConfig.od = BMA4_PUSH_PULL;
+  pinConfig.output_en = BMA4_OUTPUT_ENABLE;
+  pinConfig.input_en = BMA4_INPUT_DISABLE;
+  ret = bma4_set_int_pin_config(&pinConfig, BMA4_INTR1_MAP, &bma);
+  if (ret != BMA4_OK)
+    return;
+
+  fifoStreaming = false;
+  motionInterrupts = false;
   isOk = true;
 }
 
@@ -108,26 +158,79 @@ void Bma421::Write(uint8_t registerAddress, const uint8_t* data, size_t size) {
   twiMaster.Write(deviceAddress, registerAddress, data, size);
 }
 
-Bma421::Values Bma421::Process() {
+uint32_t Bma421::ReadSteps() {
   if (not isOk)
-    return {};
-  struct bma4_accel rawData;
-  struct bma4_accel data;
-  bma4_read_accel_xyz(&rawData, &bma);
-
-  // Scale the measured ADC counts to units of 'binary milli-g'
-  // where 1g = 1024 'binary milli-g' units.
-  // See https://github.com/InfiniTimeOrg/InfiniTime/pull/1950 for
-  // discussion of why we opted for scaling to 1024 rather than 1000.
-  data.x = 1024 * rawData.x / accelScaleFactors[accel_conf.range];
-  data.y = 1024 * rawData.y / accelScaleFactors[accel_conf.range];
-  data.z = 1024 * rawData.z / accelScaleFactors[accel_conf.range];
-
+    return 0;
   uint32_t steps = 0;
   bma423_step_counter_output(&steps, &bma);
+  return steps;
+}
 
-  // X and Y axis are swapped because of the way the sensor is mounted in the PineTime
-  return {steps, data.y, data.x, data.z};
+void Bma421::SetFifoStreaming(bool enabled) {
+  if (not isOk || enabled == fifoStreaming)
+    return;
+
+  bma4_set_fifo_config(BMA4_FIFO_ACCEL, enabled ? BMA4_ENABLE : BMA4_DISABLE, &bma);
+  bma4_set_command_register(fifoFlushCommand, &bma);
+  bma423_map_interrupt(BMA4_INTR1_MAP, BMA4_FIFO_WM_INT, enabled ? BMA4_ENABLE : BMA4_DISABLE, &bma);
+  fifoStreaming = enabled;
+}
+
+void Bma421::SetMotionInterrupts(bool enabled) {
+  if (not isOk || enabled == motionInterrupts)
+    return;
+
+  struct bma423_any_no_mot_config anyMotion;
+  anyMotion.threshold = anyMotionThreshold;
+  anyMotion.duration = anyMotionDuration;
+  anyMotion.axes_en = enabled ? BMA423_EN_ALL_AXIS : BMA423_DIS_ALL_AXIS;
+  bma423_set_any_mot_config(&anyMotion, &bma);
+  bma423_feature_enable(BMA423_WRIST_WEAR, enabled ? 1 : 0, &bma);
+  bma423_map_interrupt(BMA4_INTR1_MAP, BMA423_ANY_MOT_INT | BMA423_WRIST_WEAR_INT, enabled ? BMA4_ENABLE : BMA4_DISABLE, &bma);
+  motionInterrupts = enabled;
+}
+
+uint16_t Bma421::ReadInterrupts() {
+  if (not isOk)
+    return Interrupts::None;
+  uint16_t status = 0;
+  bma423_read_int_status(&status, &bma);
+  return status & (Interrupts::WristTilt | Interrupts::AnyMotion | Interrupts::FifoWatermark);
+}
+
+size_t Bma421::ReadFifo(Sample* samples, size_t size) {
+  if (not isOk || not fifoStreaming)
+    return 0;
+
+  uint16_t length = 0;
+  if (bma4_get_fifo_length(&length, &bma) != BMA4_OK)
+    return 0;
+  size_t count = std::min<size_t>({static_cast<size_t>(length / fifoFrameSize), size, maxFifoRead});
+  if (count == 0)
+    return 0;
+
+  // The whole batch is transferred in a single burst read of the FIFO data register
+  uint8_t buffer[maxFifoRead * fifoFrameSize];
+  struct bma4_fifo_frame fifo = {};
+  fifo.data = buffer;
+  fifo.length = count * fifoFrameSize;
+  if (bma4_read_fifo_data(&fifo, &bma) != BMA4_OK)
+    return 0;
+
+  struct bma4_accel rawData[maxFifoRead];
+  uint16_t nbFrames = count;
+  if (bma4_extract_accel(rawData, &nbFrames, &fifo, &bma) != BMA4_OK)
+    return 0;
+
+  for (uint16_t i = 0; i < nbFrames; i++) {
+    // Same scaling and axes as the registers, see https://github.com/InfiniTimeOrg/InfiniTime/pull/1950
+    int16_t x = 1024 * rawData[i].x / accelScaleFactors[accel_conf.range];
+    int16_t y = 1024 * rawData[i].y / accelScaleFactors[accel_conf.range];
+    int16_t z = 1024 * rawData[i].z / accelScaleFactors[accel_conf.range];
+    // X and Y axis are swapped because of the way the sensor is mounted in the PineTime
+    samples[i] = {y, x, z};
+  }
+  return nbFrames;
 }
 
 bool Bma421::IsOk() const {
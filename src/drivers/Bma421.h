@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <drivers/Bma421_C/bma4_defs.h>
 
 namespace Pinetime {
@@ -9,13 +10,28 @@ namespace Pinetime {
     public:
       enum class DeviceTypes : uint8_t { Unknown, BMA421, BMA425 };
 
-      struct Values {
-        uint32_t steps;
+      // Acceleration in 'binary milli-g' (1g = 1024), with the axes of the PineTime
+      struct Sample {
         int16_t x;
         int16_t y;
         int16_t z;
       };
 
+      // Interrupts reported by ReadInterrupts(), on the INT1 pin (PinMap::Bma421Irq)
+      enum Interrupts : uint16_t {
+        None = 0,
+        WristTilt = 0x0008,
+        AnyMotion = 0x0020,
+        FifoWatermark = 0x0200,
+      };
+
+      // The accelerometer samples at 100Hz, the FIFO stores one sample out of two
+      static constexpr uint8_t fifoSampleRate = 50;
+      // Number of samples in the FIFO that raises the FifoWatermark interrupt (400ms)
+      static constexpr uint8_t fifoWatermark = 20;
+      // Maximum number of samples read from the FIFO in a single TWI transfer (the TWIM can transfer up to 255 bytes)
+      static constexpr uint8_t maxFifoRead = 40;
+
       Bma421(TwiMaster& twiMaster, uint8_t twiAddress);
       Bma421(const Bma421&) = delete;
       Bma421& operator=(const Bma421&) = delete;
@@ -26,8 +42,17 @@ namespace Pinetime {
       /// Init() method to allow the caller to uninit and then reinit the TWI device after the softreset.
       void SoftReset();
       void Init();
-      Values Process();
       void ResetStepCounter();
+      uint32_t ReadSteps();
+
+      /// Samples are stored in the FIFO and FifoWatermark is raised every fifoWatermark samples while streaming is enabled.
+      void SetFifoStreaming(bool enabled);
+      /// AnyMotion and WristTilt are raised while the motion interrupts are enabled.
+      void SetMotionInterrupts(bool enabled);
+      /// Returns the pending Interrupts and releases the (latched) interrupt pin.
+      uint16_t ReadInterrupts();
+      /// Reads up to min(size, maxFifoRead) samples from the FIFO, oldest first, and returns the number of samples read.
+      size_t ReadFifo(Sample* samples, size_t size);
 
       void Read(uint8_t registerAddress, uint8_t* buffer, size_t size);
       void Write(uint8_t registerAddress, const uint8_t* data, size_t size);
@@ -44,6 +69,8 @@ namespace Pinetime {
       struct bma4_accel_config accel_conf; // Store the device configuration for later reference.
       bool isOk = false;
       bool isResetOk = false;
+      bool fifoStreaming = false;
+      bool motionInterrupts = false;
       DeviceTypes deviceType = DeviceTypes::Unknown;
     };
   }
@@ -3,9 +3,17 @@
 #include <hal/nrf_spim.h>
 #include <nrfx_log.h>
 #include <algorithm>
+#include <cstdint>
 
 using namespace Pinetime::Drivers;
 
+namespace {
+  // EasyDMA pointers and PPI endpoints are 32 bits addresses
+  uint32_t BusAddress(const volatile void* ptr) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr));
+  }
+}
+
 SpiMaster::SpiMaster(const SpiMaster::SpiModule spi, const SpiMaster::Parameters& params) : spi {spi}, params {params} {
 }
 
@@ -90,6 +98,21 @@ bool SpiMaster::Init() {
   NRFX_IRQ_PRIORITY_SET(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, 2);
   NRFX_IRQ_ENABLE(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn);
 
+  // listTimer counts the END events of a list transfer. CC[0] (last chunk started) stops
+  // the END -> START chaining, CC[1] (last chunk sent) triggers the completion interrupt.
+  listTimer->TASKS_STOP = 1;
+  listTimer->MODE = TIMER_MODE_MODE_Counter << TIMER_MODE_MODE_Pos;
+  listTimer->BITMODE = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+  listTimer->EVENTS_COMPARE[1] = 0;
+  listTimer->INTENSET = TIMER_INTENSET_COMPARE1_Msk;
+  NRFX_IRQ_PRIORITY_SET(TIMER3_IRQn, 2);
+  NRFX_IRQ_ENABLE(TIMER3_IRQn);
+
+  nrf_ppi_channel_endpoint_setup(listRestartPpi, BusAddress(&spiBaseAddress->EVENTS_END), BusAddress(&spiBaseAddress->TASKS_START));
+  nrf_ppi_channel_endpoint_setup(listCountPpi, BusAddress(&spiBaseAddress->EVENTS_END), BusAddress(&listTimer->TASKS_COUNT));
+  nrf_ppi_channel_endpoint_setup(listStopPpi, BusAddress(&listTimer->EVENTS_COMPARE[0]), nrf_ppi_task_address_get(NRF_PPI_TASK_CHG0_DIS));
+  nrf_ppi_channel_include_in_group(listRestartPpi, listPpiGroup);
+
   xSemaphoreGive(mutex);
   return true;
 }
@@ -139,22 +162,99 @@ void SpiMaster::OnEndEvent() {
   if (currentBufferAddr == 0) {
     return;
   }
+  statistics.interrupts++;
 
   auto s = currentBufferSize;
   if (s > 0) {
-    auto currentSize = std::min((size_t) 255, s);
+    auto currentSize = std::min(maxChunkSize, s);
     PrepareTx(currentBufferAddr, currentSize);
     currentBufferAddr = currentBufferAddr + currentSize;
     currentBufferSize = currentBufferSize - currentSize;
 
     spiBaseAddress->TASKS_START = 1;
   } else {
-    nrf_gpio_pin_set(this->pinCsn);
-    currentBufferAddr = 0;
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(mutex, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    EndTransaction();
+  }
+}
+
+void SpiMaster::OnListEndEvent() {
+  statistics.interrupts++;
+  StopListTransfer();
+
+  if (currentBufferSize > 0) {
+    // Send the remaining bytes that did not fit in a whole number of chunks
+    auto currentSize = std::min(maxChunkSize, static_cast<size_t>(currentBufferSize));
+    PrepareTx(currentBufferAddr, currentSize);
+    currentBufferAddr = currentBufferAddr + currentSize;
+    currentBufferSize = currentBufferSize - currentSize;
+    spiBaseAddress->TASKS_START = 1;
+  } else {
+    EndTransaction();
+  }
+}
+
+void SpiMaster::EndTransaction() {
+  nrf_gpio_pin_set(this->pinCsn);
+  currentBufferAddr = 0;
+  // The hook must run before the mutex is released, another task could start a new transaction right after
+  if (postTransactionHook != nullptr) {
+    postTransactionHook();
+  }
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xSemaphoreGiveFromISR(mutex, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+size_t SpiMaster::ListChunkSize(size_t size) {
+  // All the chunks of a list transfer have the same size: use the largest divisor of the size
+  // that fits in MAXCNT so that no remainder has to be sent separately.
+  for (size_t chunkSize = maxChunkSize; chunkSize >= minListChunkSize; chunkSize--) {
+    if (size % chunkSize == 0) {
+      return chunkSize;
+    }
   }
+  return maxChunkSize;
+}
+
+void SpiMaster::StartListTransfer(uint32_t bufferAddress, size_t chunkSize, size_t nbChunks) {
+  // END and STARTED would otherwise fire for every chunk
+  spiBaseAddress->INTENCLR = (1 << 6);
+  spiBaseAddress->INTENCLR = (1 << 19);
+
+  listTimer->TASKS_CLEAR = 1;
+  listTimer->CC[0] = nbChunks - 1;
+  listTimer->CC[1] = nbChunks;
+  listTimer->EVENTS_COMPARE[0] = 0;
+  listTimer->EVENTS_COMPARE[1] = 0;
+  listTimer->TASKS_START = 1;
+
+  spiBaseAddress->TXD.PTR = bufferAddress;
+  spiBaseAddress->TXD.MAXCNT = chunkSize;
+  spiBaseAddress->TXD.LIST = SPIM_TXD_LIST_LIST_ArrayList << SPIM_TXD_LIST_LIST_Pos;
+  spiBaseAddress->RXD.PTR = 0;
+  spiBaseAddress->RXD.MAXCNT = 0;
+  spiBaseAddress->RXD.LIST = 0;
+  spiBaseAddress->EVENTS_END = 0;
+
+  nrf_ppi_channel_enable(listCountPpi);
+  nrf_ppi_channel_enable(listStopPpi);
+  nrf_ppi_group_enable(listPpiGroup);
+
+  statistics.listTransfers++;
+  spiBaseAddress->TASKS_START = 1;
+}
+
+void SpiMaster::StopListTransfer() {
+  nrf_ppi_group_disable(listPpiGroup);
+  nrf_ppi_channel_disable(listStopPpi);
+  nrf_ppi_channel_disable(listCountPpi);
+  listTimer->TASKS_STOP = 1;
+
+  spiBaseAddress->TXD.LIST = 0;
+  spiBaseAddress->EVENTS_END = 0;
+  spiBaseAddress->EVENTS_STARTED = 0;
+  spiBaseAddress->INTENSET = (1 << 6);
+  spiBaseAddress->INTENSET = (1 << 19);
 }
 
 void SpiMaster::OnStartedEvent() {
@@ -180,13 +280,18 @@ void SpiMaster::PrepareRx(const uint32_t bufferAddress, const size_t size) {
   spiBaseAddress->EVENTS_END = 0;
 }
 
-bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size, const std::function<void()>& preTransactionHook) {
+bool SpiMaster::Write(uint8_t pinCsn,
+                      const uint8_t* data,
+                      size_t size,
+                      const std::function<void()>& preTransactionHook,
+                      const std::function<void()>& postTransactionHook) {
   if (data == nullptr)
     return false;
   auto ok = xSemaphoreTake(mutex, portMAX_DELAY);
   ASSERT(ok == true);
 
   this->pinCsn = pinCsn;
+  this->postTransactionHook = postTransactionHook;
 
   if (size == 1) {
     SetupWorkaroundForErratum58();
@@ -199,10 +304,24 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size, const st
   }
   nrf_gpio_pin_clear(this->pinCsn);
 
-  currentBufferAddr = (uint32_t) data;
+  statistics.transactions++;
+  statistics.bytes += size;
+
+  if (size > maxChunkSize) {
+    auto chunkSize = ListChunkSize(size);
+    auto nbChunks = size / chunkSize;
+    if (nbChunks >= 2) {
+      currentBufferAddr = BusAddress(data) + (chunkSize * nbChunks);
+      currentBufferSize = size - (chunkSize * nbChunks);
+      StartListTransfer(BusAddress(data), chunkSize, nbChunks);
+      return true;
+    }
+  }
+
+  currentBufferAddr = BusAddress(data);
   currentBufferSize = size;
 
-  auto currentSize = std::min((size_t) 255, (size_t) currentBufferSize);
+  auto currentSize = std::min(maxChunkSize, (size_t) currentBufferSize);
   PrepareTx(currentBufferAddr, currentSize);
   currentBufferSize = currentBufferSize - currentSize;
   currentBufferAddr = currentBufferAddr + currentSize;
@@ -216,6 +335,9 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size, const st
 
     DisableWorkaroundForErratum58();
 
+    if (postTransactionHook != nullptr) {
+      postTransactionHook();
+    }
     xSemaphoreGive(mutex);
   }
 
@@ -235,13 +357,15 @@ bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data
 
   currentBufferAddr = 0;
   currentBufferSize = 0;
+  statistics.transactions++;
+  statistics.bytes += cmdSize + dataSize;
 
-  PrepareTx((uint32_t) cmd, cmdSize);
+  PrepareTx(BusAddress(cmd), cmdSize);
   spiBaseAddress->TASKS_START = 1;
   while (spiBaseAddress->EVENTS_END == 0)
     ;
 
-  PrepareRx((uint32_t) data, dataSize);
+  PrepareRx(BusAddress(data), dataSize);
   spiBaseAddress->TASKS_START = 1;
 
   while (spiBaseAddress->EVENTS_END == 0)
@@ -254,6 +378,7 @@ bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data
 }
 
 void SpiMaster::Sleep() {
+  listTimer->TASKS_SHUTDOWN = 1;
   while (spiBaseAddress->ENABLE != 0) {
     spiBaseAddress->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
   }
@@ -282,13 +407,15 @@ bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmd
 
   currentBufferAddr = 0;
   currentBufferSize = 0;
+  statistics.transactions++;
+  statistics.bytes += cmdSize + dataSize;
 
-  PrepareTx((uint32_t) cmd, cmdSize);
+  PrepareTx(BusAddress(cmd), cmdSize);
   spiBaseAddress->TASKS_START = 1;
   while (spiBaseAddress->EVENTS_END == 0)
     ;
 
-  PrepareTx((uint32_t) data, dataSize);
+  PrepareTx(BusAddress(data), dataSize);
   spiBaseAddress->TASKS_START = 1;
 
   while (spiBaseAddress->EVENTS_END == 0)
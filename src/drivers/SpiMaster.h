@@ -27,6 +27,13 @@ namespace Pinetime {
         uint8_t pinMISO;
       };
 
+      struct TransferStatistics {
+        uint32_t transactions = 0;
+        uint32_t bytes = 0;
+        uint32_t interrupts = 0;
+        uint32_t listTransfers = 0;
+      };
+
       SpiMaster(const SpiModule spi, const Parameters& params);
       SpiMaster(const SpiMaster&) = delete;
       SpiMaster& operator=(const SpiMaster&) = delete;
@@ -34,13 +41,29 @@ namespace Pinetime {
       SpiMaster& operator=(SpiMaster&&) = delete;
 
       bool Init();
-      bool Write(uint8_t pinCsn, const uint8_t* data, size_t size, const std::function<void()>& preTransactionHook);
+      // postTransactionHook is called from the SPIM END interrupt once the whole buffer has been sent,
+      // after CS is released. It must be ISR-safe.
+      bool Write(uint8_t pinCsn,
+                 const uint8_t* data,
+                 size_t size,
+                 const std::function<void()>& preTransactionHook,
+                 const std::function<void()>& postTransactionHook);
       bool Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
 
       bool WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
 
       void OnStartedEvent();
       void OnEndEvent();
+      // Called from the interrupt of listTimer when the last chunk of a list transfer has been sent
+      void OnListEndEvent();
+
+      const TransferStatistics& Statistics() const {
+        return statistics;
+      }
+
+      void ResetStatistics() {
+        statistics = {};
+      }
 
       void Sleep();
       void Wakeup();
@@ -50,6 +73,10 @@ namespace Pinetime {
       void DisableWorkaroundForErratum58();
       void PrepareTx(const volatile uint32_t bufferAddress, const volatile size_t size);
       void PrepareRx(const volatile uint32_t bufferAddress, const volatile size_t size);
+      void StartListTransfer(uint32_t bufferAddress, size_t chunkSize, size_t nbChunks);
+      void StopListTransfer();
+      void EndTransaction();
+      static size_t ListChunkSize(size_t size);
 
       NRF_SPIM_Type* spiBaseAddress;
       uint8_t pinCsn;
@@ -59,9 +86,25 @@ namespace Pinetime {
 
       volatile uint32_t currentBufferAddr = 0;
       volatile size_t currentBufferSize = 0;
+      std::function<void()> postTransactionHook;
       SemaphoreHandle_t mutex = nullptr;
       static constexpr nrf_ppi_channel_t workaroundPpi = NRF_PPI_CHANNEL0;
       bool workaroundActive = false;
+
+      // Buffers larger than the 255 bytes EasyDMA limit are sent using the TXD.LIST array list mode:
+      // END is chained to START by PPI and listTimer counts the chunks, so that the CPU is only interrupted
+      // once the whole buffer is sent instead of once per chunk.
+      // listRestartPpi is in listPpiGroup, which is disabled when the last chunk starts. The END events are
+      // counted on their own channel, outside of the group, so that the END of the last chunk is counted too.
+      static constexpr size_t maxChunkSize = 255;
+      static constexpr size_t minListChunkSize = 128;
+      static constexpr nrf_ppi_channel_t listRestartPpi = NRF_PPI_CHANNEL1;
+      static constexpr nrf_ppi_channel_t listStopPpi = NRF_PPI_CHANNEL2;
+      static constexpr nrf_ppi_channel_t listCountPpi = NRF_PPI_CHANNEL3;
+      static constexpr nrf_ppi_channel_group_t listPpiGroup = NRF_PPI_CHANNEL_GROUP0;
+      NRF_TIMER_Type* const listTimer = NRF_TIMER3;
+
+      TransferStatistics statistics;
     };
   }
 }
@@ -1,4 +1,5 @@
 #include "drivers/SpiNorFlash.h"
+#include <algorithm>
 #include <hal/nrf_gpio.h>
 #include <libraries/delay/nrf_delay.h>
 #include <libraries/log/nrf_log.h>
@@ -10,6 +11,9 @@ SpiNorFlash::SpiNorFlash(Spi& spi) : spi {spi} {
 }
 
 void SpiNorFlash::Init() {
+  if (mutex == nullptr) {
+    mutex = xSemaphoreCreateMutex();
+  }
   device_id = ReadIdentificaion();
   NRF_LOG_INFO("[SpiNorFlash] Manufacturer : %d, Memory type : %d, memory density : %d",
                device_id.manufacturer,
@@ -22,7 +26,7 @@ void SpiNorFlash::Uninit() {
 
 void SpiNorFlash::Sleep() {
   auto cmd = static_cast<uint8_t>(Commands::DeepPowerDown);
-  spi.Write(&cmd, sizeof(uint8_t), nullptr);
+  spi.Write(&cmd, sizeof(uint8_t), nullptr, nullptr);
   NRF_LOG_INFO("[SpiNorFlash] Sleep")
 }
 
@@ -70,13 +74,29 @@ uint8_t SpiNorFlash::ReadConfigurationRegister() {
   return status;
 }
 
+void SpiNorFlash::SetReadMode(ReadModes mode) {
+  readMode = mode;
+}
+
 void SpiNorFlash::Read(uint32_t address, uint8_t* buffer, size_t size) {
-  static constexpr uint8_t cmdSize = 4;
-  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
-                          static_cast<uint8_t>(address >> 16U),
-                          static_cast<uint8_t>(address >> 8U),
-                          static_cast<uint8_t>(address)};
-  spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, size);
+  // The 5th byte is the dummy byte of Fast Read, it is not sent in Normal mode
+  uint8_t cmd[5] = {static_cast<uint8_t>(readMode == ReadModes::Fast ? Commands::FastRead : Commands::Read),
+                    static_cast<uint8_t>(address >> 16U),
+                    static_cast<uint8_t>(address >> 8U),
+                    static_cast<uint8_t>(address),
+                    0};
+  uint8_t cmdSize = (readMode == ReadModes::Fast) ? 5 : 4;
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (busyOperation == Operations::Erase) {
+    SuspendErase();
+    spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, size);
+    ResumeErase();
+  } else {
+    WaitForOtherOperation();
+    spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, size);
+  }
+  xSemaphoreGive(mutex);
 }
 
 void SpiNorFlash::WriteEnable() {
@@ -84,6 +104,41 @@ void SpiNorFlash::WriteEnable() {
   spi.Read(&cmd, sizeof(cmd), nullptr, 0);
 }
 
+void SpiNorFlash::SuspendErase() {
+  auto cmd = static_cast<uint8_t>(Commands::EraseSuspend);
+  spi.Read(&cmd, sizeof(cmd), nullptr, 0);
+  // The suspend latency is a few 10s of µs, WIP is cleared once the device accepts reads
+  while (WriteInProgress())
+    ;
+}
+
+void SpiNorFlash::ResumeErase() {
+  auto cmd = static_cast<uint8_t>(Commands::EraseResume);
+  spi.Read(&cmd, sizeof(cmd), nullptr, 0);
+}
+
+void SpiNorFlash::WaitWhileBusy(TickType_t initialDelay) {
+  // Sleep for the typical duration of the operation before the first poll, then poll with an
+  // increasing delay. The mutex is released while sleeping so that Read() can suspend an erase.
+  TickType_t delay = initialDelay;
+  while (true) {
+    xSemaphoreGive(mutex);
+    vTaskDelay(delay);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (!WriteInProgress()) {
+      return;
+    }
+    delay = std::min<TickType_t>(delay * 2, maxPollDelay);
+  }
+}
+
+void SpiNorFlash::WaitForOtherOperation() {
+  // Another task is waiting for the end of its program/erase operation, the device can't accept a new one
+  if (busyOperation != Operations::None && WriteInProgress()) {
+    WaitWhileBusy(1);
+  }
+}
+
 void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
   static constexpr uint8_t cmdSize = 4;
   uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::SectorErase),
@@ -91,14 +146,16 @@ void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
                           static_cast<uint8_t>(sectorAddress >> 8U),
                           static_cast<uint8_t>(sectorAddress)};
 
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  WaitForOtherOperation();
+  // WEL is set as soon as the Write Enable command is received, there is no need to poll it
   WriteEnable();
-  while (!WriteEnabled())
-    vTaskDelay(1);
-
   spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, nullptr, 0);
 
-  while (WriteInProgress())
-    vTaskDelay(1);
+  busyOperation = Operations::Erase;
+  WaitWhileBusy(sectorEraseDelay);
+  busyOperation = Operations::None;
+  xSemaphoreGive(mutex);
 }
 
 uint8_t SpiNorFlash::ReadSecurityRegister() {
@@ -122,6 +179,8 @@ void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
   size_t len = size;
   uint32_t addr = address;
   const uint8_t* b = buffer;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  WaitForOtherOperation();
   while (len > 0) {
     uint32_t pageLimit = (addr & ~(pageSize - 1u)) + pageSize;
     uint32_t toWrite = pageLimit - addr > len ? len : pageLimit - addr;
@@ -132,16 +191,14 @@ void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
                             static_cast<uint8_t>(addr)};
 
     WriteEnable();
-    while (!WriteEnabled())
-      vTaskDelay(1);
-
     spi.WriteCmdAndBuffer(cmd, cmdSize, b, toWrite);
-
-    while (WriteInProgress())
-      vTaskDelay(1);
+    busyOperation = Operations::Program;
+    WaitWhileBusy(pageProgramDelay);
+    busyOperation = Operations::None;
 
     addr += toWrite;
     b += toWrite;
     len -= toWrite;
   }
+  xSemaphoreGive(mutex);
 }
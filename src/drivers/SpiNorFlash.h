@@ -1,6 +1,8 @@
 #pragma once
 #include <cstddef>
 #include <cstdint>
+#include <FreeRTOS.h>
+#include <semphr.h>
 
 namespace Pinetime {
   namespace Drivers {
@@ -14,6 +16,10 @@ namespace Pinetime {
       SpiNorFlash(SpiNorFlash&&) = delete;
       SpiNorFlash& operator=(SpiNorFlash&&) = delete;
 
+      // Fast Read adds a dummy byte after the address, it is only useful above the 50MHz limit of Read.
+      // The SPIM peripheral of the nRF52832 has a single data line, dual output read is not available.
+      enum class ReadModes : uint8_t { Normal, Fast };
+
       struct __attribute__((packed)) Identification {
         uint8_t manufacturer = 0;
         uint8_t type = 0;
@@ -25,10 +31,13 @@ namespace Pinetime {
       bool WriteInProgress();
       bool WriteEnabled();
       uint8_t ReadConfigurationRegister();
+      // Read() can be called while another task erases a sector: the erase is suspended during the read.
       void Read(uint32_t address, uint8_t* buffer, size_t size);
+      // Programs any number of bytes, split on page boundaries.
       void Write(uint32_t address, const uint8_t* buffer, size_t size);
       void WriteEnable();
       void SectorErase(uint32_t sectorAddress);
+      void SetReadMode(ReadModes mode);
       uint8_t ReadSecurityRegister();
       bool ProgramFailed();
       bool EraseFailed();
@@ -45,17 +54,36 @@ namespace Pinetime {
         Read = 0x03,
         ReadStatusRegister = 0x05,
         WriteEnable = 0x06,
+        FastRead = 0x0B,
         ReadConfigurationRegister = 0x15,
         SectorErase = 0x20,
         ReadSecurityRegister = 0x2B,
+        EraseSuspend = 0x75,
+        EraseResume = 0x7A,
         ReadIdentification = 0x9F,
         ReleaseFromDeepPowerDown = 0xAB,
         DeepPowerDown = 0xB9
       };
       static constexpr uint16_t pageSize = 256;
 
+      // Typical durations from the datasheet, used to sleep before polling the status register
+      static constexpr TickType_t pageProgramDelay = 1;
+      static constexpr TickType_t sectorEraseDelay = pdMS_TO_TICKS(40);
+      static constexpr TickType_t maxPollDelay = 8;
+
+      enum class Operations : uint8_t { None, Program, Erase };
+
+      void WaitWhileBusy(TickType_t initialDelay);
+      void WaitForOtherOperation();
+      void SuspendErase();
+      void ResumeErase();
+
       Spi& spi;
       Identification device_id;
+      ReadModes readMode = ReadModes::Normal;
+      SemaphoreHandle_t mutex = nullptr;
+      // Operation started by a task that is currently sleeping in WaitWhileBusy()
+      Operations busyOperation = Operations::None;
     };
   }
 }
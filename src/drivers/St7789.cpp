@@ -34,9 +34,18 @@ void St7789::WriteData(uint8_t data) {
 }
 
 void St7789::WriteData(const uint8_t* data, size_t size) {
-  WriteSpi(data, size, [pinDataCommand = pinDataCommand]() {
-    nrf_gpio_pin_set(pinDataCommand);
-  });
+  frameStatistics.parameterBytes += size;
+  WriteData(data, size, nullptr);
+}
+
+void St7789::WriteData(const uint8_t* data, size_t size, const std::function<void()>& transferCompleteHook) {
+  WriteSpi(
+    data,
+    size,
+    [pinDataCommand = pinDataCommand]() {
+      nrf_gpio_pin_set(pinDataCommand);
+    },
+    transferCompleteHook);
 }
 
 void St7789::WriteCommand(uint8_t data) {
@@ -44,18 +53,27 @@ void St7789::WriteCommand(uint8_t data) {
 }
 
 void St7789::WriteCommand(const uint8_t* data, size_t size) {
-  WriteSpi(data, size, [pinDataCommand = pinDataCommand]() {
-    nrf_gpio_pin_clear(pinDataCommand);
-  });
+  frameStatistics.commands++;
+  WriteSpi(
+    data,
+    size,
+    [pinDataCommand = pinDataCommand]() {
+      nrf_gpio_pin_clear(pinDataCommand);
+    },
+    nullptr);
 }
 
-void St7789::WriteSpi(const uint8_t* data, size_t size, const std::function<void()>& preTransactionHook) {
-  spi.Write(data, size, preTransactionHook);
+void St7789::WriteSpi(const uint8_t* data,
+                      size_t size,
+                      const std::function<void()>& preTransactionHook,
+                      const std::function<void()>& postTransactionHook) {
+  spi.Write(data, size, preTransactionHook, postTransactionHook);
 }
 
 void St7789::SoftwareReset() {
   EnsureSleepOutPostDelay();
   WriteCommand(static_cast<uint8_t>(Commands::SoftwareReset));
+  InvalidateAddrWindow();
   // If sleep in: must wait 120ms before sleep out can sent (see driver datasheet)
   // Unconditionally wait as software reset doesn't need to be performant
   sleepIn = true;
@@ -132,29 +150,43 @@ void St7789::DisplayOn() {
 }
 
 void St7789::SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-  WriteCommand(static_cast<uint8_t>(Commands::ColumnAddressSet));
-  uint8_t colArgs[] = {
-    static_cast<uint8_t>(x0 >> 8), // x start MSB
-    static_cast<uint8_t>(x0),      // x start LSB
-    static_cast<uint8_t>(x1 >> 8), // x end MSB
-    static_cast<uint8_t>(x1)       // x end LSB
-  };
-  WriteData(colArgs, sizeof(colArgs));
-
-  WriteCommand(static_cast<uint8_t>(Commands::RowAddressSet));
-  uint8_t rowArgs[] = {
-    static_cast<uint8_t>(y0 >> 8), // y start MSB
-    static_cast<uint8_t>(y0),      // y start LSB
-    static_cast<uint8_t>(y1 >> 8), // y end MSB
-    static_cast<uint8_t>(y1)       // y end LSB
-  };
-  memcpy(addrWindowArgs, rowArgs, sizeof(rowArgs));
-  WriteData(addrWindowArgs, sizeof(addrWindowArgs));
+  if (windowValid && x0 == windowX0 && x1 == windowX1) {
+    frameStatistics.skippedWindowUpdates++;
+  } else {
+    WriteCommand(static_cast<uint8_t>(Commands::ColumnAddressSet));
+    columnArgs[0] = static_cast<uint8_t>(x0 >> 8); // x start MSB
+    columnArgs[1] = static_cast<uint8_t>(x0);      // x start LSB
+    columnArgs[2] = static_cast<uint8_t>(x1 >> 8); // x end MSB
+    columnArgs[3] = static_cast<uint8_t>(x1);      // x end LSB
+    WriteData(columnArgs, sizeof(columnArgs));
+  }
+
+  if (windowValid && y0 == windowY0 && y1 == windowY1) {
+    frameStatistics.skippedWindowUpdates++;
+  } else {
+    WriteCommand(static_cast<uint8_t>(Commands::RowAddressSet));
+    rowArgs[0] = static_cast<uint8_t>(y0 >> 8); // y start MSB
+    rowArgs[1] = static_cast<uint8_t>(y0);      // y start LSB
+    rowArgs[2] = static_cast<uint8_t>(y1 >> 8); // y end MSB
+    rowArgs[3] = static_cast<uint8_t>(y1);      // y end LSB
+    WriteData(rowArgs, sizeof(rowArgs));
+  }
+
+  windowX0 = x0;
+  windowX1 = x1;
+  windowY0 = y0;
+  windowY1 = y1;
+  windowValid = true;
 }
 
-void St7789::WriteToRam(const uint8_t* data, size_t size) {
+void St7789::InvalidateAddrWindow() {
+  windowValid = false;
+  writeCanContinue = false;
+}
+
+void St7789::WriteToRam(const uint8_t* data, size_t size, const std::function<void()>& transferCompleteHook) {
   WriteCommand(static_cast<uint8_t>(Commands::WriteToRam));
-  WriteData(data, size);
+  WriteData(data, size, transferCompleteHook);
 }
 
 void St7789::SetVdv() {
@@ -183,14 +215,46 @@ void St7789::Uninit() {
 }
 
 void St7789::DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size) {
-  SetAddrWindow(x, y, x + width - 1, y + height - 1);
-  WriteToRam(data, size);
+  DrawBuffer(x, y, width, height, data, size, nullptr);
+}
+
+void St7789::DrawBuffer(uint16_t x,
+                        uint16_t y,
+                        uint16_t width,
+                        uint16_t height,
+                        const uint8_t* data,
+                        size_t size,
+                        const std::function<void()>& transferCompleteHook) {
+  frameStatistics.drawCalls++;
+  frameStatistics.pixelBytes += size;
+
+  const uint16_t x1 = x + width - 1;
+  if (writeCanContinue && x == windowX0 && x1 == windowX1 && y == nextLine) {
+    // The memory pointer of the controller is already on the first pixel of this stripe
+    frameStatistics.skippedWindowUpdates += 2;
+    WriteCommand(static_cast<uint8_t>(Commands::WriteToRamContinue));
+    WriteData(data, size, transferCompleteHook);
+  } else {
+    // The window extends to the bottom of the frame memory so that the following stripes can continue it
+    SetAddrWindow(x, y, x1, Height - 1);
+    WriteToRam(data, size, transferCompleteHook);
+  }
+
+  nextLine = y + height;
+  // A partial line would leave the memory pointer in the middle of the next stripe
+  writeCanContinue = (size == static_cast<size_t>(width) * height * 2) && nextLine < Height;
+}
+
+void St7789::EndFrame() {
+  lastFrameStatistics = frameStatistics;
+  frameStatistics = {};
 }
 
 void St7789::HardwareReset() {
   nrf_gpio_pin_clear(pinReset);
   vTaskDelay(pdMS_TO_TICKS(1));
   nrf_gpio_pin_set(pinReset);
+  InvalidateAddrWindow();
   // If hardware reset started while sleep out, reset time may be up to 120ms
   // Unconditionally wait as hardware reset doesn't need to be performant
   sleepIn = true;
@@ -23,10 +23,34 @@ namespace Pinetime {
       void VerticalScrollStartAddress(uint16_t line);
 
       void DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size);
+      // Returns as soon as the pixel data transfer is started, transferCompleteHook is called from the SPI interrupt when it's done.
+      void DrawBuffer(uint16_t x,
+                      uint16_t y,
+                      uint16_t width,
+                      uint16_t height,
+                      const uint8_t* data,
+                      size_t size,
+                      const std::function<void()>& transferCompleteHook);
 
       void Sleep();
       void Wakeup();
 
+      // Number of transactions and bytes sent to the display controller. Everything that isn't pixel data is overhead.
+      struct FrameStatistics {
+        uint32_t commands = 0;
+        uint32_t parameterBytes = 0;
+        uint32_t pixelBytes = 0;
+        uint32_t drawCalls = 0;
+        uint32_t skippedWindowUpdates = 0;
+      };
+
+      // Marks the end of a frame: the statistics of the frame become available from LastFrameStatistics()
+      void EndFrame();
+
+      const FrameStatistics& LastFrameStatistics() const {
+        return lastFrameStatistics;
+      }
+
     private:
       Spi& spi;
       uint8_t pinDataCommand;
@@ -44,15 +68,19 @@ namespace Pinetime {
       void MemoryDataAccessControl();
       void DisplayInversionOn();
       void NormalModeOn();
-      void WriteToRam(const uint8_t* data, size_t size);
+      void WriteToRam(const uint8_t* data, size_t size, const std::function<void()>& transferCompleteHook);
       void DisplayOn();
       void DisplayOff();
 
       void SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+      void InvalidateAddrWindow();
       void SetVdv();
       void WriteCommand(uint8_t cmd);
       void WriteCommand(const uint8_t* data, size_t size);
-      void WriteSpi(const uint8_t* data, size_t size, const std::function<void()>& preTransactionHook);
+      void WriteSpi(const uint8_t* data,
+                    size_t size,
+                    const std::function<void()>& preTransactionHook,
+                    const std::function<void()>& postTransactionHook);
 
       enum class Commands : uint8_t {
         SoftwareReset = 0x01,
@@ -65,6 +93,7 @@ namespace Pinetime {
         ColumnAddressSet = 0x2a,
         RowAddressSet = 0x2b,
         WriteToRam = 0x2c,
+        WriteToRamContinue = 0x3c,
         MemoryDataAccessControl = 0x36,
         VerticalScrollDefinition = 0x33,
         VerticalScrollStartAddress = 0x37,
@@ -73,11 +102,26 @@ namespace Pinetime {
       };
       void WriteData(uint8_t data);
       void WriteData(const uint8_t* data, size_t size);
+      void WriteData(const uint8_t* data, size_t size, const std::function<void()>& transferCompleteHook);
 
       static constexpr uint16_t Width = 240;
       static constexpr uint16_t Height = 320;
 
-      uint8_t addrWindowArgs[4];
+      // Address window currently set in the controller. DrawBuffer() only sends the columns and rows
+      // that change, and continues the previous write when a stripe starts on the line following it.
+      uint16_t windowX0 = 0;
+      uint16_t windowX1 = 0;
+      uint16_t windowY0 = 0;
+      uint16_t windowY1 = 0;
+      uint16_t nextLine = 0;
+      bool windowValid = false;
+      bool writeCanContinue = false;
+
+      FrameStatistics frameStatistics;
+      FrameStatistics lastFrameStatistics;
+
+      uint8_t columnArgs[4];
+      uint8_t rowArgs[4];
       uint8_t verticalScrollArgs[2];
     };
   }
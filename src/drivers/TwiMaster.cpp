@@ -1,12 +1,19 @@
 #include "drivers/TwiMaster.h"
+#include <algorithm>
 #include <cstring>
 #include <hal/nrf_gpio.h>
 #include <nrfx_log.h>
+#include <task.h>
+#include "components/profiling/ProfilingClock.h"
 
 using namespace Pinetime::Drivers;
+using Pinetime::Controllers::ProfilingClock;
 
-// TODO use shortcut to automatically send STOP when receive LastTX, for example
-// TODO use DMA/IRQ
+namespace {
+  inline bool in_isr() {
+    return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
+  }
+}
 
 TwiMaster::TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl)
   : module {module}, frequency {frequency}, pinSda {pinSda}, pinScl {pinScl} {
@@ -23,10 +30,6 @@ void TwiMaster::ConfigurePins() const {
 }
 
 void TwiMaster::Init() {
-  if (mutex == nullptr) {
-    mutex = xSemaphoreCreateBinary();
-  }
-
   ConfigurePins();
 
   twiBaseAddress = module;
@@ -43,137 +46,215 @@ void TwiMaster::Init() {
   twiBaseAddress->EVENTS_SUSPENDED = 0;
   twiBaseAddress->EVENTS_TXSTARTED = 0;
 
-  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
+  twiBaseAddress->INTENCLR = 0xffffffff;
+  twiBaseAddress->INTENSET = TWIM_INTENSET_STOPPED_Msk | TWIM_INTENSET_ERROR_Msk;
+
+  NRFX_IRQ_PRIORITY_SET(nrfx_get_irq_number(twiBaseAddress), 2);
+  NRFX_IRQ_ENABLE(nrfx_get_irq_number(twiBaseAddress));
+
+  // The TWIM is only enabled while a transaction is running
+  Sleep();
+}
 
-  xSemaphoreGive(mutex);
+bool TwiMaster::Submit(Transaction& transaction) {
+  ASSERT(transaction.txSize <= maxTransferSize && transaction.rxSize <= maxTransferSize);
+  ASSERT(transaction.txSize > 0 || transaction.rxSize > 0);
+
+  transaction.result = ErrorCodes::NoError;
+  transaction.retries = 0;
+  transaction.submitTime = ProfilingClock::Ticks();
+
+  bool queued = true;
+  auto interruptState = taskENTER_CRITICAL_FROM_ISR();
+  if (current == nullptr) {
+    Start(transaction);
+  } else if (queueCount < queueSize) {
+    queue[(queueHead + queueCount) % queueSize] = &transaction;
+    queueCount++;
+  } else {
+    queued = false;
+  }
+  taskEXIT_CRITICAL_FROM_ISR(interruptState);
+  return queued;
 }
 
 TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* data, size_t size) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  auto ret = Write(deviceAddress, &registerAddress, 1, false);
-  ret = Read(deviceAddress, data, size, true);
-  Sleep();
-  xSemaphoreGive(mutex);
-  return ret;
+  Transaction transaction;
+  transaction.deviceAddress = deviceAddress;
+  transaction.txData = &registerAddress;
+  transaction.txSize = 1;
+  transaction.rxData = data;
+  transaction.rxSize = size;
+  return Transfer(transaction);
 }
 
 TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size) {
   ASSERT(size <= maxDataSize);
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  internalBuffer[0] = registerAddress;
-  std::memcpy(internalBuffer + 1, data, size);
-  auto ret = Write(deviceAddress, internalBuffer, size + 1, true);
-  Sleep();
-  xSemaphoreGive(mutex);
-  return ret;
+  uint8_t buffer[maxDataSize + registerSize];
+  buffer[0] = registerAddress;
+  std::memcpy(buffer + registerSize, data, size);
+
+  Transaction transaction;
+  transaction.deviceAddress = deviceAddress;
+  transaction.txData = buffer;
+  transaction.txSize = size + registerSize;
+  return Transfer(transaction);
 }
 
-TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->RXD.PTR = (uint32_t) buffer;
-  twiBaseAddress->RXD.MAXCNT = size;
-
-  twiBaseAddress->TASKS_STARTRX = 1;
-
-  while (!twiBaseAddress->EVENTS_RXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_RXSTARTED = 0x0UL;
-
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTRX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
+TwiMaster::ErrorCodes TwiMaster::Transfer(Transaction& transaction) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  transaction.onComplete = [task](ErrorCodes /*result*/) {
+    if (in_isr()) {
+      BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+      vTaskNotifyGiveFromISR(task, &xHigherPriorityTaskWoken);
+      portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+      xTaskNotifyGive(task);
     }
-  }
-  twiBaseAddress->EVENTS_LASTRX = 0x0UL;
+  };
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
-  } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+  if (!Submit(transaction)) {
+    return ErrorCodes::TransactionFailed;
   }
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
+  // The transaction (and the buffers on the stack) must not be released before it is completed: if the bus
+  // freezes, recover it and keep waiting, the frozen transaction (ours or the one before) is then completed with an error.
+  while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(freezeTimeoutMs)) == 0) {
+    RecoverFromFreeze();
   }
-  return ErrorCodes::NoError;
+  return transaction.result;
 }
 
-TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->TXD.PTR = (uint32_t) data;
-  twiBaseAddress->TXD.MAXCNT = size;
-
-  twiBaseAddress->TASKS_STARTTX = 1;
-
-  while (!twiBaseAddress->EVENTS_TXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_TXSTARTED = 0x0UL;
-
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTTX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
-    }
-  }
-  twiBaseAddress->EVENTS_LASTTX = 0x0UL;
+void TwiMaster::Start(Transaction& transaction) {
+  current = &transaction;
+  currentFailed = false;
+  currentStartTime = ProfilingClock::Ticks();
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
+  Wakeup();
+  twiBaseAddress->ADDRESS = transaction.deviceAddress;
+  twiBaseAddress->TXD.PTR = (uint32_t) transaction.txData;
+  twiBaseAddress->TXD.MAXCNT = transaction.txSize;
+  twiBaseAddress->RXD.PTR = (uint32_t) transaction.rxData;
+  twiBaseAddress->RXD.MAXCNT = transaction.rxSize;
+  twiBaseAddress->EVENTS_STOPPED = 0;
+  twiBaseAddress->EVENTS_ERROR = 0;
+
+  // The shortcuts chain the write, the repeated start, the read and the STOP condition without CPU intervention.
+  // The only interrupt is STOPPED (or ERROR) at the end of the transaction.
+  if (transaction.txSize > 0 && transaction.rxSize > 0) {
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STARTRX_Msk | TWIM_SHORTS_LASTRX_STOP_Msk;
+    twiBaseAddress->TASKS_STARTTX = 1;
+  } else if (transaction.txSize > 0) {
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
+    twiBaseAddress->TASKS_STARTTX = 1;
   } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTRX_STOP_Msk;
+    twiBaseAddress->TASKS_STARTRX = 1;
   }
+}
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
+void TwiMaster::OnInterrupt() {
+  if (twiBaseAddress->EVENTS_ERROR == 1) {
+    twiBaseAddress->EVENTS_ERROR = 0;
     uint32_t error = twiBaseAddress->ERRORSRC;
     twiBaseAddress->ERRORSRC = error;
+    currentFailed = true;
+    // The shortcuts don't apply on a NACK or an overrun: the STOP condition must be sent manually
+    twiBaseAddress->TASKS_RESUME = 1;
+    twiBaseAddress->TASKS_STOP = 1;
   }
 
-  return ErrorCodes::NoError;
-}
+  if (twiBaseAddress->EVENTS_STOPPED == 1) {
+    twiBaseAddress->EVENTS_STOPPED = 0;
+    Transaction* transaction = current;
+    if (transaction == nullptr) {
+      // The transaction has already been completed by RecoverFromFreeze()
+      return;
+    }
 
-void TwiMaster::Sleep() {
-  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Disabled << TWIM_ENABLE_ENABLE_Pos);
+    bool failed = currentFailed || twiBaseAddress->TXD.AMOUNT != transaction->txSize || twiBaseAddress->RXD.AMOUNT != transaction->rxSize;
+    if (failed && transaction->retries < maxRetries) {
+      transaction->retries++;
+      StatisticsOf(transaction->deviceAddress).retries++;
+      Start(*transaction);
+      return;
+    }
+    Complete(failed ? ErrorCodes::TransactionFailed : ErrorCodes::NoError);
+  }
 }
 
-void TwiMaster::Wakeup() {
-  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
+// Must be called with the TWIM interrupt masked (from the interrupt itself or in a critical section)
+void TwiMaster::Complete(ErrorCodes result) {
+  Transaction* transaction = current;
+  current = nullptr;
+  Sleep();
+
+  transaction->result = result;
+  auto& deviceStatistics = StatisticsOf(transaction->deviceAddress);
+  uint32_t latency = ProfilingClock::TicksBetween(transaction->submitTime, ProfilingClock::Ticks());
+  deviceStatistics.transactions++;
+  deviceStatistics.totalLatency += latency;
+  deviceStatistics.maxLatency = std::max(deviceStatistics.maxLatency, latency);
+  if (result == ErrorCodes::NoError) {
+    deviceStatistics.bytes += transaction->txSize + transaction->rxSize;
+  } else {
+    deviceStatistics.errors++;
+  }
+
+  if (queueCount > 0) {
+    Transaction* next = queue[queueHead];
+    queueHead = (queueHead + 1) % queueSize;
+    queueCount--;
+    Start(*next);
+  }
+
+  // Last access to the transaction: a blocking caller may release it as soon as it is notified
+  if (transaction->onComplete) {
+    transaction->onComplete(result);
+  }
 }
 
-/* Sometimes, the TWIM device just freeze and never set the event EVENTS_LASTTX.
- * This method disable and re-enable the peripheral so that it works again.
+/* Sometimes, the TWIM device just freeze and never set the event EVENTS_STOPPED.
+ * This method disable and re-enable the peripheral so that it works again, and fails the frozen transaction.
  * This is just a workaround, and it would be better if we could find a way to prevent
  * this issue from happening.
  * */
-void TwiMaster::FixHwFreezed() {
-  NRF_LOG_INFO("I2C device frozen, reinitializing it!");
+void TwiMaster::RecoverFromFreeze() {
+  uint8_t frozenDevice = 0;
+  taskENTER_CRITICAL();
+  if (current != nullptr &&
+      ProfilingClock::TicksToUs(ProfilingClock::TicksBetween(currentStartTime, ProfilingClock::Ticks())) >= freezeTimeoutMs * 1000) {
+    frozenDevice = current->deviceAddress;
+    StatisticsOf(frozenDevice).freezeRecoveries++;
+    // An event of the frozen transaction raised late would be taken for the end of the next one
+    twiBaseAddress->EVENTS_STOPPED = 0;
+    twiBaseAddress->EVENTS_ERROR = 0;
+    twiBaseAddress->ERRORSRC = twiBaseAddress->ERRORSRC;
+    NRFX_IRQ_PENDING_CLEAR(nrfx_get_irq_number(twiBaseAddress));
+    Complete(ErrorCodes::TransactionFailed);
+  }
+  taskEXIT_CRITICAL();
 
-  uint32_t twi_state = NRF_TWI1->ENABLE;
+  if (frozenDevice != 0) {
+    NRF_LOG_INFO("I2C device 0x%02x frozen, reinitializing the TWIM!", frozenDevice);
+  }
+}
 
-  Sleep();
+TwiMaster::DeviceStatistics& TwiMaster::StatisticsOf(uint8_t deviceAddress) {
+  for (auto& deviceStatistics : statistics) {
+    if (deviceStatistics.deviceAddress == deviceAddress || deviceStatistics.deviceAddress == 0) {
+      deviceStatistics.deviceAddress = deviceAddress;
+      return deviceStatistics;
+    }
+  }
+  // More devices than entries: the last one is shared
+  return statistics.back();
+}
 
-  twiBaseAddress->ENABLE = twi_state;
+void TwiMaster::Sleep() {
+  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Disabled << TWIM_ENABLE_ENABLE_Pos);
+}
+
+void TwiMaster::Wakeup() {
+  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
 }
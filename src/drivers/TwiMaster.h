@@ -1,8 +1,10 @@
 #pragma once
 #include <FreeRTOS.h>
-#include <semphr.h>
 #include <drivers/include/nrfx_twi.h> // NRF_TWIM_Type
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 
 namespace Pinetime {
   namespace Drivers {
@@ -10,32 +12,90 @@ namespace Pinetime {
     public:
       enum class ErrorCodes { NoError, TransactionFailed };
 
+      // Writes txSize bytes, then reads rxSize bytes after a repeated start (either size can be 0). The buffers
+      // must stay valid until onComplete is called. onComplete is called from the TWIM interrupt and must be ISR-safe.
+      struct Transaction {
+        uint8_t deviceAddress = 0;
+        const uint8_t* txData = nullptr;
+        size_t txSize = 0;
+        uint8_t* rxData = nullptr;
+        size_t rxSize = 0;
+        std::function<void(ErrorCodes)> onComplete;
+
+        // Set by the driver
+        ErrorCodes result = ErrorCodes::NoError;
+        uint8_t retries = 0;
+        uint32_t submitTime = 0;
+      };
+
+      // Latencies are measured from Submit() to the completion, in ProfilingClock ticks
+      struct DeviceStatistics {
+        uint8_t deviceAddress = 0;
+        uint32_t transactions = 0;
+        uint32_t bytes = 0;
+        uint32_t errors = 0;
+        uint32_t retries = 0;
+        uint32_t freezeRecoveries = 0;
+        uint32_t totalLatency = 0;
+        uint32_t maxLatency = 0;
+      };
+      static constexpr size_t maxDevices = 4;
+
       TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl);
 
       void Init();
+      // Queues the transaction, and starts it right away if the bus is idle. Returns false if the queue is full.
+      // Can be called from an ISR.
+      bool Submit(Transaction& transaction);
+
+      // Blocking register accesses: the calling task sleeps until the transaction is completed
       ErrorCodes Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* buffer, size_t size);
       ErrorCodes Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size);
 
+      void OnInterrupt();
+
+      const std::array<DeviceStatistics, maxDevices>& Statistics() const {
+        return statistics;
+      }
+
+      void ResetStatistics() {
+        statistics = {};
+      }
+
       void Sleep();
       void Wakeup();
 
     private:
-      ErrorCodes Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop);
-      ErrorCodes Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop);
-      void FixHwFreezed();
+      ErrorCodes Transfer(Transaction& transaction);
+      void Start(Transaction& transaction);
+      void Complete(ErrorCodes result);
+      void RecoverFromFreeze();
+      DeviceStatistics& StatisticsOf(uint8_t deviceAddress);
       void ConfigurePins() const;
 
       NRF_TWIM_Type* twiBaseAddress;
-      SemaphoreHandle_t mutex = nullptr;
       NRF_TWIM_Type* module;
       uint32_t frequency;
       uint8_t pinSda;
       uint8_t pinScl;
       static constexpr uint8_t maxDataSize {16};
       static constexpr uint8_t registerSize {1};
-      uint8_t internalBuffer[maxDataSize + registerSize];
-      uint32_t txStartedCycleCount = 0;
-      static constexpr uint32_t HwFreezedDelay {161000};
+      // Size of the EasyDMA MAXCNT registers on the nRF52832
+      static constexpr size_t maxTransferSize {255};
+      static constexpr uint8_t maxRetries {1};
+      // The TWIM sometimes freezes and never ends the transaction. The waiting task disables and re-enables it
+      // once the transaction has been running for this long.
+      static constexpr uint32_t freezeTimeoutMs {20};
+
+      static constexpr size_t queueSize = 8;
+      std::array<Transaction*, queueSize> queue;
+      size_t queueHead = 0;
+      size_t queueCount = 0;
+      Transaction* volatile current = nullptr;
+      uint32_t currentStartTime = 0;
+      volatile bool currentFailed = false;
+
+      std::array<DeviceStatistics, maxDevices> statistics;
     };
   }
 }
@@ -1,12 +1,31 @@
 #include "heartratetask/HeartRateTask.h"
 #include <drivers/Hrs3300.h>
 #include <components/heartrate/HeartRateController.h>
+#include <components/datetime/DateTimeController.h>
+#include <components/settings/Settings.h>
+#include <systemtask/SystemTask.h>
 #include <nrf_log.h>
 
 using namespace Pinetime::Applications;
 
-HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor, Controllers::HeartRateController& controller)
-  : heartRateSensor {heartRateSensor}, controller {controller} {
+namespace {
+  bool TimeReached(TickType_t time) {
+    return static_cast<int32_t>(xTaskGetTickCount() - time) >= 0;
+  }
+}
+
+HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor,
+                             Controllers::HeartRateController& controller,
+                             Controllers::DateTime& dateTimeController,
+                             Controllers::Settings& settingsController)
+  : heartRateSensor {heartRateSensor},
+    controller {controller},
+    dateTimeController {dateTimeController},
+    settingsController {settingsController} {
+}
+
+void HeartRateTask::Register(System::SystemTask* systemTask) {
+  this->systemTask = systemTask;
 }
 
 void HeartRateTask::Start() {
@@ -25,23 +44,27 @@ void HeartRateTask::Process(void* instance) {
 
 void HeartRateTask::Work() {
   int lastBpm = 0;
+  nextBackgroundMeasurementTime = xTaskGetTickCount() + settingsController.GetHeartRateBackgroundInterval() * 60 * configTICK_RATE_HZ;
   while (true) {
     Messages msg;
     uint32_t delay;
-    if (state == States::Running) {
-      if (measurementStarted) {
-        delay = ppg.deltaTms;
-      } else {
-        delay = 100;
-      }
-    } else {
+    // The background measurements also run while the system sleeps, manual measurements are paused
+    bool measuring = backgroundMeasurementStarted || (measurementStarted && state == States::Running);
+    if (measuring) {
+      delay = ppg.deltaTms;
+    } else if (measurementStarted) {
+      // Paused until the system wakes up
       delay = portMAX_DELAY;
+    } else {
+      delay = TicksToNextBackgroundMeasurement();
     }
 
     if (xQueueReceive(messageQueue, &msg, delay)) {
       switch (msg) {
         case Messages::GoToSleep:
-          StopMeasurement();
+          if (measurementStarted) {
+            StopMeasurement();
+          }
           state = States::Idle;
           break;
         case Messages::WakeUp:
@@ -55,7 +78,10 @@ void HeartRateTask::Work() {
           if (measurementStarted) {
             break;
           }
+          // The manual measurement takes over the sensor, the background measurement is cancelled
+          backgroundMeasurementStarted = false;
           lastBpm = 0;
+          measurementRecorded = false;
           StartMeasurement();
           measurementStarted = true;
           break;
@@ -69,7 +95,21 @@ void HeartRateTask::Work() {
       }
     }
 
-    if (measurementStarted) {
+    if (!measurementStarted) {
+      if (backgroundMeasurementStarted && TimeReached(backgroundMeasurementEndTime)) {
+        if (lastBpm > 0) {
+          AddToHistory(lastBpm, Controllers::HeartRateHistory::Sources::Background);
+        }
+        StopBackgroundMeasurement();
+      } else if (!backgroundMeasurementStarted && settingsController.GetHeartRateBackgroundInterval() > 0 &&
+                 TimeReached(nextBackgroundMeasurementTime)) {
+        lastBpm = 0;
+        StartBackgroundMeasurement();
+      }
+    }
+
+    measuring = backgroundMeasurementStarted || (measurementStarted && state == States::Running);
+    if (measuring) {
       int8_t ambient = ppg.Preprocess(heartRateSensor.ReadHrs(), heartRateSensor.ReadAls());
       int bpm = ppg.HeartRate();
 
@@ -85,16 +125,29 @@ void HeartRateTask::Work() {
         ppg.Reset(false);
         // Set HR to zero and update
         bpm = 0;
-        controller.Update(Controllers::HeartRateController::States::Running, bpm);
-      }
-
-      if (lastBpm == 0 && bpm == 0) {
-        controller.Update(Controllers::HeartRateController::States::NotEnoughData, bpm);
+        if (measurementStarted) {
+          controller.Update(Controllers::HeartRateController::States::Running, bpm);
+        }
       }
 
       if (bpm != 0) {
         lastBpm = bpm;
-        controller.Update(Controllers::HeartRateController::States::Running, lastBpm);
+      }
+
+      // Background measurements are only recorded in the history, at the end of the measurement
+      if (measurementStarted) {
+        if (lastBpm == 0 && bpm == 0) {
+          controller.Update(Controllers::HeartRateController::States::NotEnoughData, bpm);
+        }
+
+        if (bpm != 0) {
+          controller.Update(Controllers::HeartRateController::States::Running, lastBpm);
+          if (!measurementRecorded || TimeReached(lastMeasurementRecordTime + measurementRecordPeriod)) {
+            AddToHistory(lastBpm, Controllers::HeartRateHistory::Sources::Measurement);
+            lastMeasurementRecordTime = xTaskGetTickCount();
+            measurementRecorded = true;
+          }
+        }
       }
     }
   }
@@ -117,3 +170,38 @@ void HeartRateTask::StopMeasurement() {
   ppg.Reset(true);
   vTaskDelay(100);
 }
+
+void HeartRateTask::StartBackgroundMeasurement() {
+  backgroundMeasurementStarted = true;
+  backgroundMeasurementEndTime = xTaskGetTickCount() + backgroundMeasurementDuration;
+  // The period is measured between the starts of the measurements
+  nextBackgroundMeasurementTime += settingsController.GetHeartRateBackgroundInterval() * 60 * configTICK_RATE_HZ;
+  if (TimeReached(nextBackgroundMeasurementTime)) {
+    // The system was busy with a manual measurement, or the interval was changed
+    nextBackgroundMeasurementTime = xTaskGetTickCount() + settingsController.GetHeartRateBackgroundInterval() * 60 * configTICK_RATE_HZ;
+  }
+  StartMeasurement();
+}
+
+void HeartRateTask::StopBackgroundMeasurement() {
+  backgroundMeasurementStarted = false;
+  StopMeasurement();
+}
+
+TickType_t HeartRateTask::TicksToNextBackgroundMeasurement() const {
+  // Background measurements disabled: the interval is checked again on the next message (the system going to sleep or waking up)
+  if (settingsController.GetHeartRateBackgroundInterval() == 0) {
+    return portMAX_DELAY;
+  }
+  auto remaining = static_cast<int32_t>(nextBackgroundMeasurementTime - xTaskGetTickCount());
+  return remaining > 0 ? static_cast<TickType_t>(remaining) : 0;
+}
+
+// The record is kept in RAM until SystemTask writes it: the SPI flash may be sleeping
+void HeartRateTask::AddToHistory(uint8_t bpm, Controllers::HeartRateHistory::Sources source) {
+  auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(dateTimeController.UTCDateTime().time_since_epoch()).count();
+  controller.History().Add({static_cast<uint32_t>(timestamp), bpm, source});
+  if (systemTask != nullptr) {
+    systemTask->PushMessage(System::Messages::SaveHeartRateHistory);
+  }
+}
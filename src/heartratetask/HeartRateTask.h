@@ -2,6 +2,7 @@
 #include <FreeRTOS.h>
 #include <task.h>
 #include <queue.h>
+#include <components/heartrate/HeartRateHistory.h>
 #include <components/heartrate/Ppg.h>
 
 namespace Pinetime {
@@ -11,6 +12,12 @@ namespace Pinetime {
 
   namespace Controllers {
     class HeartRateController;
+    class DateTime;
+    class Settings;
+  }
+
+  namespace System {
+    class SystemTask;
   }
 
   namespace Applications {
@@ -19,7 +26,11 @@ namespace Pinetime {
       enum class Messages : uint8_t { GoToSleep, WakeUp, StartMeasurement, StopMeasurement };
       enum class States { Idle, Running };
 
-      explicit HeartRateTask(Drivers::Hrs3300& heartRateSensor, Controllers::HeartRateController& controller);
+      HeartRateTask(Drivers::Hrs3300& heartRateSensor,
+                    Controllers::HeartRateController& controller,
+                    Controllers::DateTime& dateTimeController,
+                    Controllers::Settings& settingsController);
+      void Register(System::SystemTask* systemTask);
       void Start();
       void Work();
       void PushMessage(Messages msg);
@@ -28,14 +39,30 @@ namespace Pinetime {
       static void Process(void* instance);
       void StartMeasurement();
       void StopMeasurement();
+      void StartBackgroundMeasurement();
+      void StopBackgroundMeasurement();
+      TickType_t TicksToNextBackgroundMeasurement() const;
+      void AddToHistory(uint8_t bpm, Controllers::HeartRateHistory::Sources source);
+
+      // Duration of a background measurement, and minimum time between two records of a manual measurement
+      static constexpr TickType_t backgroundMeasurementDuration = 30 * configTICK_RATE_HZ;
+      static constexpr TickType_t measurementRecordPeriod = 60 * configTICK_RATE_HZ;
 
       TaskHandle_t taskHandle;
       QueueHandle_t messageQueue;
       States state = States::Running;
       Drivers::Hrs3300& heartRateSensor;
       Controllers::HeartRateController& controller;
+      Controllers::DateTime& dateTimeController;
+      Controllers::Settings& settingsController;
+      System::SystemTask* systemTask = nullptr;
       Controllers::Ppg ppg;
       bool measurementStarted = false;
+      bool backgroundMeasurementStarted = false;
+      TickType_t nextBackgroundMeasurementTime = 0;
+      TickType_t backgroundMeasurementEndTime = 0;
+      TickType_t lastMeasurementRecordTime = 0;
+      bool measurementRecorded = false;
     };
 
   }
@@ -86,9 +86,10 @@ typedef int16_t lv_coord_t;
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #define LV_MEM_AUTO_DEFRAG  1
 #else       /*LV_MEM_CUSTOM*/
-#define LV_MEM_CUSTOM_INCLUDE <FreeRTOS.h>   /*Header for the dynamic memory function*/
-#define LV_MEM_CUSTOM_ALLOC   pvPortMalloc       /*Wrapper to malloc*/
-#define LV_MEM_CUSTOM_FREE    vPortFree         /*Wrapper to free*/
+/* The objects of the displayed screen are allocated in the screen arena, the other ones in the FreeRTOS heap */
+#define LV_MEM_CUSTOM_INCLUDE "displayapp/ScreenArenaHooks.h"   /*Header for the dynamic memory function*/
+#define LV_MEM_CUSTOM_ALLOC   ScreenArenaMalloc       /*Wrapper to malloc*/
+#define LV_MEM_CUSTOM_FREE    ScreenArenaFree         /*Wrapper to free*/
 #endif     /*LV_MEM_CUSTOM*/
 
 /* Use the standard memcpy and memset instead of LVGL's own functions.
@@ -0,0 +1,52 @@
+#include <cstddef>
+#include <new>
+#include <FreeRTOS.h>
+#include <libraries/util/app_error.h>
+#include "FreeRTOS/heap_4_infinitime.h"
+
+// Replaces the operators of libstdc++ (which call malloc()) so that the allocations are profiled by call site:
+// the call site of the operator is its caller.
+// The firmware is built without exceptions and the callers of new don't check the result: as the operators of
+// libstdc++, they don't return when the heap is exhausted. Only the nothrow versions return nullptr.
+
+namespace {
+  void* Allocate(size_t size, void* callSite) {
+    void* ptr = pvPortMallocFrom(size, callSite);
+    if (ptr == nullptr) {
+      APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+    return ptr;
+  }
+}
+
+void* operator new(size_t size) {
+  return Allocate(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size) {
+  return Allocate(size, __builtin_return_address(0));
+}
+
+void* operator new(size_t size, const std::nothrow_t& /*tag*/) noexcept {
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size, const std::nothrow_t& /*tag*/) noexcept {
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+}
+
+void operator delete(void* ptr) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+  vPortFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+  vPortFree(ptr);
+}
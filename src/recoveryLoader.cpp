@@ -18,6 +18,7 @@
 
 #include "displayapp/icons/infinitime/infinitime-nb.c"
 #include "components/rle/RleDecoder.h"
+#include "components/lz/LzDecoder.h"
 
 #if NRF_LOG_ENABLED
   #include "logging/NrfLogger.h"
@@ -33,6 +34,7 @@ static constexpr uint8_t bytesPerPixel = 2;
 
 static constexpr uint16_t colorWhite = 0xFFFF;
 static constexpr uint16_t colorGreen = 0xE007;
+static constexpr uint16_t colorRed = 0x00F8;
 
 Pinetime::Drivers::SpiMaster spi {Pinetime::Drivers::SpiMaster::SpiModule::SPI0,
                                   {Pinetime::Drivers::SpiMaster::BitOrder::Msb_Lsb,
@@ -49,6 +51,9 @@ Pinetime::Drivers::St7789 lcd {lcdSpi, Pinetime::PinMap::LcdDataCommand, Pinetim
 
 Pinetime::Controllers::BrightnessController brightnessController;
 
+// The recovery image is compressed by the build (tools/dfu_compress.py)
+Pinetime::Tools::LzDecoder lzDecoder;
+
 void DisplayProgressBar(uint8_t percent, uint16_t color);
 
 void DisplayLogo();
@@ -72,6 +77,13 @@ void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) {
     NRF_SPIM0->EVENTS_STOPPED = 0;
   }
 }
+
+void TIMER3_IRQHandler(void) {
+  if (NRF_TIMER3->EVENTS_COMPARE[1] == 1) {
+    NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+    spi.OnListEndEvent();
+  }
+}
 }
 
 void RefreshWatchdog() {
@@ -94,8 +106,12 @@ void Process(void* /*instance*/) {
   NRF_LOG_INFO("Display logo")
   DisplayLogo();
 
+  const auto* image = reinterpret_cast<const uint8_t*>(recoveryImage);
+  uint32_t imageSize = sizeof(recoveryImage);
+  bool compressed = Pinetime::Tools::LzDecoder::ReadHeader(image, sizeof(recoveryImage), imageSize);
+
   NRF_LOG_INFO("Erasing...");
-  for (uint32_t erased = 0; erased < sizeof(recoveryImage); erased += 0x1000) {
+  for (uint32_t erased = 0; erased < imageSize; erased += 0x1000) {
     spiNorFlash.SectorErase(erased);
     RefreshWatchdog();
   }
@@ -103,11 +119,33 @@ void Process(void* /*instance*/) {
   NRF_LOG_INFO("Writing factory image...");
   static constexpr uint32_t memoryChunkSize = 200;
   uint8_t writeBuffer[memoryChunkSize];
-  for (size_t offset = 0; offset < sizeof(recoveryImage); offset += memoryChunkSize) {
-    std::memcpy(writeBuffer, &recoveryImage[offset], memoryChunkSize);
-    spiNorFlash.Write(offset, writeBuffer, memoryChunkSize);
-    DisplayProgressBar((static_cast<float>(offset) / static_cast<float>(sizeof(recoveryImage))) * 100.0f, colorWhite);
-    RefreshWatchdog();
+  if (compressed) {
+    size_t inputOffset = Pinetime::Tools::LzDecoder::headerSize;
+    lzDecoder.Reset();
+    for (size_t offset = 0; offset < imageSize;) {
+      size_t consumed;
+      size_t chunkSize = std::min<size_t>(memoryChunkSize, imageSize - offset);
+      size_t decodedSize = lzDecoder.Decode(image + inputOffset, sizeof(recoveryImage) - inputOffset, consumed, writeBuffer, chunkSize);
+      inputOffset += consumed;
+      if (decodedSize == 0 || lzDecoder.HasError()) {
+        NRF_LOG_INFO("Invalid compressed image");
+        DisplayProgressBar(100.0f, colorRed);
+        while (1) {
+          asm("nop");
+        }
+      }
+      spiNorFlash.Write(offset, writeBuffer, decodedSize);
+      offset += decodedSize;
+      DisplayProgressBar((static_cast<float>(offset) / static_cast<float>(imageSize)) * 100.0f, colorWhite);
+      RefreshWatchdog();
+    }
+  } else {
+    for (size_t offset = 0; offset < sizeof(recoveryImage); offset += memoryChunkSize) {
+      std::memcpy(writeBuffer, &recoveryImage[offset], memoryChunkSize);
+      spiNorFlash.Write(offset, writeBuffer, memoryChunkSize);
+      DisplayProgressBar((static_cast<float>(offset) / static_cast<float>(sizeof(recoveryImage))) * 100.0f, colorWhite);
+      RefreshWatchdog();
+    }
   }
   NRF_LOG_INFO("Writing factory image done!");
   DisplayProgressBar(100.0f, colorGreen);
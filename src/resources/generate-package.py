@@ -6,15 +6,52 @@ import json
 import shutil
 import typing
 import os.path
+import struct
 import argparse
 import subprocess
 from zipfile import ZipFile
 
+PACK_PATH = '/resources.pack'
+PACK_MAGIC = b'ITRP'
+PACK_VERSION = 1
+PACK_ALIGNMENT = 4096
+PACK_HEADER = struct.Struct('<4sHH8x')
+PACK_ENTRY = struct.Struct('<40sII')
+
+def align(value):
+    return (value + PACK_ALIGNMENT - 1) // PACK_ALIGNMENT * PACK_ALIGNMENT
+
+def write_pack(output, resources):
+    """Write the resources in a single file read by FS::FindResource(): a header, the index sorted by path
+    and the payloads aligned on 4 KiB. resources is a list of (path on the watch, local file) tuples."""
+    resources = sorted(resources, key=lambda r: r[0].encode())
+    offset = align(PACK_HEADER.size + len(resources) * PACK_ENTRY.size)
+    index = []
+    payloads = []
+    for target_path, path in resources:
+        name = target_path.encode()
+        if len(name) >= 40:
+            sys.exit(f'Error: the resource path {target_path} is too long for the resource pack.')
+        with open(path, 'rb') as fd:
+            payload = fd.read()
+        index.append(PACK_ENTRY.pack(name, offset, len(payload)))
+        payloads.append((offset, payload))
+        offset = align(offset + len(payload))
+
+    with open(output, 'wb') as fd:
+        fd.write(PACK_HEADER.pack(PACK_MAGIC, PACK_VERSION, len(resources)))
+        fd.write(b''.join(index))
+        for offset, payload in payloads:
+            fd.write(b'\xff' * (offset - fd.tell()))
+            fd.write(payload)
+
 def main():
     ap = argparse.ArgumentParser(description='auto generate LVGL font files from fonts')
     ap.add_argument('--config', '-c', type=str, action='append', help='config file to use')
     ap.add_argument('--obsolete', type=str, help='List of obsolete files')
     ap.add_argument('--output', type=str, help='output file name')
+    ap.add_argument('--pack', type=str, help='package the resources in a single resource pack with this name')
+    ap.add_argument('--version', type=str, help='version of InfiniTime, used to mark the unpacked files as obsolete')
     args = ap.parse_args()
 
     for config_file in args.config:
@@ -32,6 +69,7 @@ def main():
 
     zf = ZipFile(args.output, mode='w')
     resource_files = []
+    packed_resources = []
 
     for config_file in args.config:
         with open(config_file, 'r') as fd:
@@ -40,22 +78,42 @@ def main():
         resource_names = set(data.keys())
         for name in resource_names:
             resource = data[name]
+            path = name + '.bin'
+            if not os.path.exists(path):
+                path = os.path.join(os.path.dirname(sys.argv[0]), path)
+
+            if args.pack:
+                packed_resources.append((resource['target_path'] + name + '.bin', path))
+                continue
+
             resource_files.append({
                 "filename": name+'.bin',
                 "path": resource['target_path'] + name+'.bin'
             })
-
-            path = name + '.bin'
-            if not os.path.exists(path):
-                path = os.path.join(os.path.dirname(sys.argv[0]), path)
             zf.write(path)
 
+    if args.pack:
+        write_pack(args.pack, packed_resources)
+        zf.write(args.pack)
+        resource_files.append({
+            "filename": args.pack,
+            "path": PACK_PATH
+        })
+
     if args.obsolete:
         obsolete_file_path = os.path.join(os.path.dirname(sys.argv[0]), args.obsolete)
         with open(obsolete_file_path, 'r') as fd:
             obsolete_data = json.load(fd)
     else:
-        obsolete_data = {}
+        obsolete_data = []
+
+    if args.pack:
+        # The files uploaded by the previous versions are now read from the pack
+        for target_path, path in packed_resources:
+            obsolete_data.append({
+                "path": target_path,
+                "since": args.version
+            })
     output = {
         'resources': resource_files,
         'obsolete_files': obsolete_data
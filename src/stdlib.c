@@ -1,13 +1,15 @@
 #include <stdlib.h>
 #include <FreeRTOS.h>
+#include "FreeRTOS/heap_4_infinitime.h"
 
 // Override malloc() and free() to use the memory manager from FreeRTOS.
 // According to the documentation of libc, we also need to override
 // calloc and realloc.
 // See https://www.gnu.org/software/libc/manual/html_node/Replacing-malloc.html
 
+// The allocations are profiled by call site: the call site of malloc() is its caller
 void* malloc(size_t size) {
-  return pvPortMalloc(size);
+  return pvPortMallocFrom(size, __builtin_return_address(0));
 }
 
 void free(void* ptr) {
@@ -14,6 +14,7 @@ namespace Pinetime {
       BleFirmwareUpdateStarted,
       BleFirmwareUpdateFinished,
       OnTouchEvent,
+      OnMotionEvent,
       HandleButtonEvent,
       HandleButtonTimerEvent,
       OnDisplayTaskSleeping,
@@ -29,7 +30,8 @@ namespace Pinetime {
       BatteryPercentageUpdated,
       StartFileTransfer,
       StopFileTransfer,
-      BleRadioEnableToggle
+      BleRadioEnableToggle,
+      SaveHeartRateHistory
     };
   }
 }
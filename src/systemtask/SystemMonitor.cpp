@@ -1,15 +1,29 @@
 #include "systemtask/SystemTask.h"
-#if configUSE_TRACE_FACILITY == 1
+#if configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1
   // FreeRtosMonitor
+  #include <algorithm>
+  #include <cstring>
   #include <FreeRTOS.h>
   #include <task.h>
   #include <nrf_log.h>
+  #include "components/profiling/ProfilingClock.h"
+  #include "FreeRTOS/heap_4_infinitime.h"
 
-void Pinetime::System::SystemMonitor::Process() {
-  if (xTaskGetTickCount() - lastTick > 10000) {
-    NRF_LOG_INFO("---------------------------------------\nFree heap : %d", xPortGetFreeHeapSize());
-    TaskStatus_t tasksStatus[10];
-    auto nb = uxTaskGetSystemState(tasksStatus, 10, nullptr);
+using namespace Pinetime::System;
+using Pinetime::Controllers::ProfilingClock;
+
+void SystemMonitor::Process() {
+  if (xTaskGetTickCount() - lastTick > samplePeriod) {
+    HeapStats_t heapStats;
+    vPortGetHeapStats(&heapStats);
+    NRF_LOG_INFO("---------------------------------------\nFree heap : %d (min %d), largest block %d, %d free blocks",
+                 heapStats.xAvailableHeapSpaceInBytes,
+                 heapStats.xMinimumEverFreeBytesRemaining,
+                 heapStats.xSizeOfLargestFreeBlockInBytes,
+                 heapStats.xNumberOfFreeBlocks);
+    TaskStatus_t tasksStatus[maxTasks];
+    uint32_t totalRunTime = 0;
+    auto nb = uxTaskGetSystemState(tasksStatus, maxTasks, &totalRunTime);
     for (uint32_t i = 0; i < nb; i++) {
       NRF_LOG_INFO("Task [%s] - %d", tasksStatus[i].pcTaskName, tasksStatus[i].usStackHighWaterMark);
       if (tasksStatus[i].usStackHighWaterMark < 20)
@@ -17,11 +31,106 @@ void Pinetime::System::SystemMonitor::Process() {
                      tasksStatus[i].pcTaskName,
                      tasksStatus[i].usStackHighWaterMark * 4);
     }
+    Account(tasksStatus, nb, totalRunTime);
     lastTick = xTaskGetTickCount();
   }
 }
+
+void SystemMonitor::Account(const TaskStatus_t* tasksStatus, size_t nb, uint32_t totalRunTime) {
+  uint32_t sleepTime = ProfilingClock::SleepTime();
+  uint32_t elapsed = totalRunTime - lastTotalRunTime;
+  uint32_t slept = std::min(sleepTime - lastSleepTime, elapsed);
+  lastTotalRunTime = totalRunTime;
+  lastSleepTime = sleepTime;
+  if (elapsed == 0) {
+    return;
+  }
+
+  auto toLoad = [elapsed](uint32_t time) {
+    return static_cast<uint16_t>((static_cast<uint64_t>(time) * 1000) / elapsed);
+  };
+
+  Sample sample;
+  sample.duration = static_cast<uint16_t>(std::min<uint32_t>(elapsed / ProfilingClock::ticksPerSecond, UINT16_MAX));
+  sample.sleep = toLoad(slept);
+
+  TaskHandle_t idleTask = xTaskGetIdleTaskHandle();
+  taskENTER_CRITICAL();
+  for (size_t i = 0; i < nb; i++) {
+    const auto& status = tasksStatus[i];
+    size_t index = FindTask(status);
+    if (index == maxTasks) {
+      continue;
+    }
+    uint32_t runTime = status.ulRunTimeCounter - lastRunTimes[index];
+    lastRunTimes[index] = status.ulRunTimeCounter;
+    if (status.xHandle == idleTask) {
+      // The idle task is the one running during the tickless sleep
+      runTime -= std::min(runTime, slept);
+    }
+    sample.loads[index] = toLoad(std::min(runTime, elapsed));
+    tasks[index].stackHighWaterMark = status.usStackHighWaterMark;
+  }
+
+  historyHead = (historyHead + 1) % historySize;
+  history[historyHead] = sample;
+  nbSamples = std::min(nbSamples + 1, historySize);
+  taskEXIT_CRITICAL();
+
+  NRF_LOG_INFO("Sleep %d.%d%%", sample.sleep / 10, sample.sleep % 10);
+  for (size_t i = 0; i < nbTasks; i++) {
+    NRF_LOG_INFO("Load [%s] - %d.%d%%", tasks[i].name, sample.loads[i] / 10, sample.loads[i] % 10);
+  }
+}
+
+size_t SystemMonitor::FindTask(const TaskStatus_t& status) {
+  // A task keeps its index for the whole run of the firmware, so that the samples of the history can be compared
+  for (size_t i = 0; i < nbTasks; i++) {
+    if (strncmp(tasks[i].name, status.pcTaskName, configMAX_TASK_NAME_LEN) == 0) {
+      if (taskNumbers[i] != status.xTaskNumber) {
+        // The task was deleted and created again
+        taskNumbers[i] = status.xTaskNumber;
+        lastRunTimes[i] = 0;
+      }
+      return i;
+    }
+  }
+  if (nbTasks == maxTasks) {
+    return maxTasks;
+  }
+  strncpy(tasks[nbTasks].name, status.pcTaskName, configMAX_TASK_NAME_LEN - 1);
+  taskNumbers[nbTasks] = status.xTaskNumber;
+  lastRunTimes[nbTasks] = 0;
+  return nbTasks++;
+}
+
+size_t SystemMonitor::GetTasks(std::array<Task, maxTasks>& tasks) const {
+  taskENTER_CRITICAL();
+  std::copy(this->tasks.begin(), this->tasks.begin() + nbTasks, tasks.begin());
+  size_t count = nbTasks;
+  taskEXIT_CRITICAL();
+  return count;
+}
+
+size_t SystemMonitor::GetHistory(std::array<Sample, historySize>& samples) const {
+  taskENTER_CRITICAL();
+  for (size_t i = 0; i < nbSamples; i++) {
+    samples[i] = history[(historyHead + historySize - i) % historySize];
+  }
+  size_t count = nbSamples;
+  taskEXIT_CRITICAL();
+  return count;
+}
 #else
 // DummyMonitor
 void Pinetime::System::SystemMonitor::Process() {
 }
+
+size_t Pinetime::System::SystemMonitor::GetTasks(std::array<Task, maxTasks>& /*tasks*/) const {
+  return 0;
+}
+
+size_t Pinetime::System::SystemMonitor::GetHistory(std::array<Sample, historySize>& /*samples*/) const {
+  return 0;
+}
 #endif
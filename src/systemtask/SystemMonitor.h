@@ -1,15 +1,62 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <FreeRTOS.h> // declares configUSE_TRACE_FACILITY
 #include <task.h>
 
 namespace Pinetime {
   namespace System {
+    // Logs the free heap and the stack usage of the tasks, and accounts the CPU time used by each task with the run time
+    // statistics of FreeRTOS. The time spent in the tickless sleep is accounted separately from the idle task, so that
+    // the loads show which tasks keep the MCU awake.
     class SystemMonitor {
     public:
+      static constexpr size_t maxTasks = 10;
+      static constexpr size_t historySize = 12;
+
+      struct Task {
+        char name[configMAX_TASK_NAME_LEN] = {};
+        // Free stack, in words
+        uint16_t stackHighWaterMark = 0;
+      };
+
+      // The loads are in tenths of percents of the duration of the sample
+      struct Sample {
+        // In seconds
+        uint16_t duration = 0;
+        uint16_t sleep = 0;
+        // Indexed like the tasks returned by GetTasks(). The load of the idle task doesn't include the sleep.
+        std::array<uint16_t, maxTasks> loads = {};
+      };
+
       void Process();
-#if configUSE_TRACE_FACILITY == 1
+
+      // Returns the number of tasks copied
+      size_t GetTasks(std::array<Task, maxTasks>& tasks) const;
+      // Most recent first. Returns the number of samples copied
+      size_t GetHistory(std::array<Sample, historySize>& samples) const;
+
+#if configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1
     private:
+      static constexpr TickType_t samplePeriod = pdMS_TO_TICKS(10000);
+
+      void Account(const TaskStatus_t* tasksStatus, size_t nb, uint32_t totalRunTime);
+      size_t FindTask(const TaskStatus_t& status);
+
       mutable TickType_t lastTick = 0;
+
+      std::array<Task, maxTasks> tasks;
+      std::array<UBaseType_t, maxTasks> taskNumbers;
+      std::array<uint32_t, maxTasks> lastRunTimes;
+      size_t nbTasks = 0;
+      uint32_t lastTotalRunTime = 0;
+      uint32_t lastSleepTime = 0;
+
+      // history[historyHead] is the most recent sample
+      std::array<Sample, historySize> history;
+      size_t historyHead = 0;
+      size_t nbSamples = 0;
 #endif
     };
   }
@@ -1,4 +1,5 @@
 #include "systemtask/SystemTask.h"
+#include <algorithm>
 #include <hal/nrf_rtc.h>
 #include <libraries/gpiote/app_gpiote.h>
 #include <libraries/log/nrf_log.h>
@@ -51,7 +52,9 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                        Pinetime::Applications::HeartRateTask& heartRateApp,
                        Pinetime::Controllers::FS& fs,
                        Pinetime::Controllers::TouchHandler& touchHandler,
-                       Pinetime::Controllers::ButtonHandler& buttonHandler)
+                       Pinetime::Controllers::ButtonHandler& buttonHandler,
+                       Pinetime::Controllers::FrameProfiler& frameProfiler,
+                       Pinetime::Controllers::ChangeNotifier& changeNotifier)
   : spi {spi},
     spiNorFlash {spiNorFlash},
     twiMaster {twiMaster},
@@ -80,12 +83,16 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                      spiNorFlash,
                      heartRateController,
                      motionController,
-                     fs) {
+                     fs,
+                     frameProfiler,
+                     monitor,
+                     twiMaster,
+                     changeNotifier) {
 }
 
 void SystemTask::Start() {
   systemTasksMsgQueue = xQueueCreate(10, 1);
-  if (pdPASS != xTaskCreate(SystemTask::Process, "MAIN", 350, this, 1, &taskHandle)) {
+  if (pdPASS != xTaskCreate(SystemTask::Process, "MAIN", 400, this, 1, &taskHandle)) {
     APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
   }
 }
@@ -109,6 +116,9 @@ void SystemTask::Work() {
   spiNorFlash.Wakeup();
 
   fs.Init();
+  notificationManager.Init();
+  heartRateController.History().Init();
+  motionController.History().Init();
 
   nimbleController.Init();
 
@@ -143,6 +153,7 @@ void SystemTask::Work() {
 
   heartRateSensor.Init();
   heartRateSensor.Disable();
+  heartRateApp.Register(this);
   heartRateApp.Start();
 
   buttonHandler.Init(this);
@@ -173,6 +184,12 @@ void SystemTask::Work() {
   nrfx_gpiote_in_init(PinMap::PowerPresent, &pinConfig, nrfx_gpiote_evt_handler);
   nrfx_gpiote_in_event_enable(PinMap::PowerPresent, true);
 
+  // Motion sensor (latched, active high)
+  pinConfig.sense = NRF_GPIOTE_POLARITY_LOTOHI;
+  pinConfig.pull = NRF_GPIO_PIN_NOPULL;
+  nrfx_gpiote_in_init(PinMap::Bma421Irq, &pinConfig, nrfx_gpiote_evt_handler);
+  nrfx_gpiote_in_event_enable(PinMap::Bma421Irq, true);
+
   batteryController.MeasureVoltage();
 
   measureBatteryTimer = xTimerCreate("measureBattery", batteryMeasurementPeriod, pdTRUE, this, MeasureBatteryTimerCallback);
@@ -180,11 +197,10 @@ void SystemTask::Work() {
 
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "EndlessLoop"
+  UpdateMotion();
   while (true) {
-    UpdateMotion();
-
     Messages msg;
-    if (xQueueReceive(systemTasksMsgQueue, &msg, 100) == pdTRUE) {
+    if (xQueueReceive(systemTasksMsgQueue, &msg, LoopTimeout()) == pdTRUE) {
       switch (msg) {
         case Messages::EnableSleeping:
           // Make sure that exiting an app doesn't enable sleeping,
@@ -206,6 +222,7 @@ void SystemTask::Work() {
           }
 
           spiNorFlash.Wakeup();
+          dateTimeController.OnSystemSleep(false);
 
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::GoToRunning);
           heartRateApp.PushMessage(Pinetime::Applications::HeartRateTask::Messages::WakeUp);
@@ -215,6 +232,7 @@ void SystemTask::Work() {
           }
 
           state = SystemTaskState::Running;
+          UpdateMotion();
           break;
         case Messages::TouchWakeUp: {
           if (touchHandler.ProcessTouchInfo(touchPanel.GetTouchInfo())) {
@@ -231,7 +249,7 @@ void SystemTask::Work() {
           break;
         }
         case Messages::GoToSleep:
-          if (doNotGoToSleep) {
+          if (IsSleepDisabled()) {
             break;
           }
           state = SystemTaskState::GoingToSleep; // Already set in PushMessage()
@@ -246,7 +264,12 @@ void SystemTask::Work() {
             alarmController.ScheduleAlarm();
           }
           break;
-        case Messages::OnNewNotification:
+        case Messages::OnNewNotification: {
+          bool flashWokenUp = WakeUpSleepingFlash();
+          notificationManager.Flush();
+          if (flashWokenUp) {
+            SleepFlash();
+          }
           if (settingsController.GetNotificationStatus() == Pinetime::Controllers::Settings::Notification::On) {
             if (state == SystemTaskState::Sleeping) {
               GoToRunning();
@@ -255,7 +278,7 @@ void SystemTask::Work() {
             }
             displayApp.PushMessage(Pinetime::Applications::Display::Messages::NewNotification);
           }
-          break;
+        } break;
         case Messages::SetOffAlarm:
           if (state == SystemTaskState::Sleeping) {
             GoToRunning();
@@ -265,7 +288,7 @@ void SystemTask::Work() {
         case Messages::BleConnected:
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
           isBleDiscoveryTimerRunning = true;
-          bleDiscoveryTimer = 5;
+          bleDiscoveryTime = xTaskGetTickCount() + bleDiscoveryDelay;
           break;
         case Messages::BleFirmwareUpdateStarted:
           doNotGoToSleep = true;
@@ -282,7 +305,7 @@ void SystemTask::Work() {
           break;
         case Messages::StartFileTransfer:
           NRF_LOG_INFO("[systemtask] FS Started");
-          doNotGoToSleep = true;
+          fileTransfers++;
           if (state == SystemTaskState::Sleeping) {
             GoToRunning();
           }
@@ -290,7 +313,9 @@ void SystemTask::Work() {
           break;
         case Messages::StopFileTransfer:
           NRF_LOG_INFO("[systemtask] FS Stopped");
-          doNotGoToSleep = false;
+          if (fileTransfers > 0) {
+            fileTransfers--;
+          }
           // TODO add intent of fs access icon or something
           break;
         case Messages::OnTouchEvent:
@@ -298,6 +323,9 @@ void SystemTask::Work() {
             displayApp.PushMessage(Pinetime::Applications::Display::Messages::TouchEvent);
           }
           break;
+        case Messages::OnMotionEvent:
+          UpdateMotion();
+          break;
         case Messages::HandleButtonEvent: {
           Controllers::ButtonActions action = Controllers::ButtonActions::None;
           if (nrf_gpio_pin_read(Pinetime::PinMap::Button) == 0) {
@@ -318,12 +346,7 @@ void SystemTask::Work() {
           HandleButtonAction(action);
         } break;
         case Messages::OnDisplayTaskSleeping:
-          if (BootloaderVersion::IsValid()) {
-            // First versions of the bootloader do not expose their version and cannot initialize the SPI NOR FLASH
-            // if it's in sleep mode. Avoid bricked device by disabling sleep mode on these versions.
-            spiNorFlash.Sleep();
-          }
-          spi.Sleep();
+          SleepFlash();
 
           // Double Tap needs the touch screen to be in normal mode
           if (!settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::DoubleTap)) {
@@ -331,6 +354,8 @@ void SystemTask::Work() {
           }
 
           state = SystemTaskState::Sleeping;
+          dateTimeController.OnSystemSleep(true);
+          UpdateMotion();
           break;
         case Messages::OnNewDay:
           // We might be sleeping (with TWI device disabled.
@@ -386,6 +411,13 @@ void SystemTask::Work() {
           }
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::ShowPairingKey);
           break;
+        case Messages::SaveHeartRateHistory: {
+          bool flashWokenUp = WakeUpSleepingFlash();
+          heartRateController.History().Flush();
+          if (flashWokenUp) {
+            SleepFlash();
+          }
+        } break;
         case Messages::BleRadioEnableToggle:
           if (settingsController.GetBleRadioEnabled()) {
             nimbleController.EnableRadio();
@@ -396,16 +428,17 @@ void SystemTask::Work() {
         default:
           break;
       }
+    } else {
+      // Periodic update of the step count, and of the motion data in case an interrupt was missed
+      UpdateMotion();
     }
 
     if (isBleDiscoveryTimerRunning) {
-      if (bleDiscoveryTimer == 0) {
+      if (static_cast<int32_t>(xTaskGetTickCount() - bleDiscoveryTime) >= 0) {
         isBleDiscoveryTimerRunning = false;
-        // Services discovery is deferred from 3 seconds to avoid the conflicts between the host communicating with the
+        // Services discovery is deferred to avoid the conflicts between the host communicating with the
         // target and vice-versa. I'm not sure if this is the right way to handle this...
         nimbleController.StartDiscovery();
-      } else {
-        bleDiscoveryTimer--;
       }
     }
 
@@ -423,33 +456,102 @@ void SystemTask::UpdateMotion() {
     return;
   }
 
-  if (state == SystemTaskState::Sleeping && !(settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
-                                              settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) ||
-                                              motionController.GetService()->IsMotionNotificationSubscribed())) {
+  using Pinetime::Drivers::Bma421;
+  bool wakeUpOnMotion = settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
+                        settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake);
+  bool motionSubscribed = motionController.GetService()->IsMotionNotificationSubscribed();
+
+  // Also releases the interrupt line
+  auto interrupts = motionSensor.ReadInterrupts();
+  if ((interrupts & (Bma421::Interrupts::AnyMotion | Bma421::Interrupts::WristTilt)) != 0) {
+    isMotionDetected = true;
+    motionDetectedTime = xTaskGetTickCount();
+  } else if (isMotionDetected && xTaskGetTickCount() - motionDetectedTime > motionWindow) {
+    isMotionDetected = false;
+  }
+
+  if (state == SystemTaskState::Sleeping && !(wakeUpOnMotion || motionSubscribed)) {
+    motionSensor.SetMotionInterrupts(false);
+    motionSensor.SetFifoStreaming(false);
+    // The step counter is still read once per interval of the activity history
+    if (motionController.History().IntervalEnded(UtcTimestamp())) {
+      UpdateActivityHistory(motionSensor.ReadSteps(), 0, 0);
+    }
     return;
   }
 
+  // While sleeping, the samples are only streamed for a few seconds after the motion sensor detected a motion
+  motionSensor.SetMotionInterrupts(state == SystemTaskState::Sleeping && wakeUpOnMotion);
+  motionSensor.SetFifoStreaming(state == SystemTaskState::Running || motionSubscribed || isMotionDetected);
+
   if (stepCounterMustBeReset) {
     motionSensor.ResetStepCounter();
     stepCounterMustBeReset = false;
   }
 
-  auto motionValues = motionSensor.Process();
-
-  motionController.Update(motionValues.x, motionValues.y, motionValues.z, motionValues.steps);
+  uint32_t steps = motionSensor.ReadSteps();
+  size_t nbSamples;
+  do {
+    nbSamples = motionSensor.ReadFifo(motionSamples.data(), motionSamples.size());
+    motionController.Update(motionSamples.data(), nbSamples, xTaskGetTickCount(), steps);
+    UpdateActivityHistory(steps, motionController.Activity(), nbSamples);
+
+    if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
+      if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
+           motionController.ShouldRaiseWake()) ||
+          (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) &&
+           motionController.ShouldShakeWake(settingsController.GetShakeThreshold()))) {
+        GoToRunning();
+      }
+    }
+    if (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::LowerWrist) &&
+        state == SystemTaskState::Running && motionController.ShouldLowerSleep()) {
+      PushMessage(Messages::GoToSleep);
+    }
+  } while (nbSamples == motionSamples.size());
+}
 
-  if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
-    if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
-         motionController.ShouldRaiseWake()) ||
-        (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) &&
-         motionController.ShouldShakeWake(settingsController.GetShakeThreshold()))) {
-      GoToRunning();
+void SystemTask::UpdateActivityHistory(uint32_t nbSteps, uint32_t activity, size_t nbSamples) {
+  auto& history = motionController.History();
+  history.Update(UtcTimestamp(), nbSteps, activity, nbSamples);
+  if (history.MustFlush(state == SystemTaskState::Sleeping)) {
+    bool flashWokenUp = WakeUpSleepingFlash();
+    history.Flush();
+    if (flashWokenUp) {
+      SleepFlash();
     }
   }
-  if (settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::LowerWrist) && state == SystemTaskState::Running &&
-      motionController.ShouldLowerSleep()) {
-    PushMessage(Messages::GoToSleep);
+}
+
+uint32_t SystemTask::UtcTimestamp() {
+  return std::chrono::duration_cast<std::chrono::seconds>(dateTimeController.UTCDateTime().time_since_epoch()).count();
+}
+
+bool SystemTask::WakeUpSleepingFlash() {
+  if (state != SystemTaskState::Sleeping) {
+    return false;
   }
+  spi.Wakeup();
+  spiNorFlash.Wakeup();
+  return true;
+}
+
+void SystemTask::SleepFlash() {
+  if (BootloaderVersion::IsValid()) {
+    // First versions of the bootloader do not expose their version and cannot initialize the SPI NOR FLASH
+    // if it's in sleep mode. Avoid bricked device by disabling sleep mode on these versions.
+    spiNorFlash.Sleep();
+  }
+  spi.Sleep();
+}
+
+TickType_t SystemTask::LoopTimeout() const {
+  TickType_t timeout = IsSleeping() ? sleepingLoopPeriod : runningLoopPeriod;
+  if (isBleDiscoveryTimerRunning) {
+    auto remaining = static_cast<int32_t>(bleDiscoveryTime - xTaskGetTickCount());
+    timeout = std::min<TickType_t>(timeout, std::max<int32_t>(remaining, 0));
+  }
+  return timeout;
 }
 
 void SystemTask::HandleButtonAction(Controllers::ButtonActions action) {
@@ -502,8 +604,12 @@ void SystemTask::OnTouchEvent() {
   }
 }
 
+void SystemTask::OnMotionEvent() {
+  PushMessage(Messages::OnMotionEvent);
+}
+
 void SystemTask::PushMessage(System::Messages msg) {
-  if (msg == Messages::GoToSleep && !doNotGoToSleep) {
+  if (msg == Messages::GoToSleep && !IsSleepDisabled()) {
     state = SystemTaskState::GoingToSleep;
   }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 
 #include <FreeRTOS.h>
@@ -47,6 +48,8 @@ namespace Pinetime {
     class Battery;
     class TouchHandler;
     class ButtonHandler;
+    class FrameProfiler;
+    class ChangeNotifier;
   }
 
   namespace System {
@@ -72,24 +75,31 @@ namespace Pinetime {
                  Pinetime::Applications::HeartRateTask& heartRateApp,
                  Pinetime::Controllers::FS& fs,
                  Pinetime::Controllers::TouchHandler& touchHandler,
-                 Pinetime::Controllers::ButtonHandler& buttonHandler);
+                 Pinetime::Controllers::ButtonHandler& buttonHandler,
+                 Pinetime::Controllers::FrameProfiler& frameProfiler,
+                 Pinetime::Controllers::ChangeNotifier& changeNotifier);
 
       void Start();
       void PushMessage(Messages msg);
 
       void OnTouchEvent();
+      void OnMotionEvent();
 
       void OnIdle();
       void OnDim();
 
       bool IsSleepDisabled() {
-        return doNotGoToSleep;
+        return doNotGoToSleep || fileTransfers > 0;
       }
 
       Pinetime::Controllers::NimbleController& nimble() {
         return nimbleController;
       };
 
+      const SystemMonitor& systemMonitor() const {
+        return monitor;
+      }
+
       bool IsSleeping() const {
         return state == SystemTaskState::Sleeping || state == SystemTaskState::WakingUp;
       }
@@ -120,14 +130,19 @@ namespace Pinetime {
       Pinetime::Controllers::FS& fs;
       Pinetime::Controllers::TouchHandler& touchHandler;
       Pinetime::Controllers::ButtonHandler& buttonHandler;
+      SystemMonitor monitor;
       Pinetime::Controllers::NimbleController nimbleController;
 
       static void Process(void* instance);
       void Work();
       bool isBleDiscoveryTimerRunning = false;
-      uint8_t bleDiscoveryTimer = 0;
+      TickType_t bleDiscoveryTime = 0;
+      static constexpr TickType_t bleDiscoveryDelay = pdMS_TO_TICKS(500);
       TimerHandle_t measureBatteryTimer;
       bool doNotGoToSleep = false;
+      // Transfers in progress (StartFileTransfer not followed by StopFileTransfer yet): the BLE services can hold
+      // several of them at the same time, the system doesn't sleep until they're all stopped
+      uint8_t fileTransfers = 0;
       SystemTaskState state = SystemTaskState::Running;
 
       void HandleButtonAction(Controllers::ButtonActions action);
@@ -135,10 +150,23 @@ namespace Pinetime {
 
       void GoToRunning();
       void UpdateMotion();
+      void UpdateActivityHistory(uint32_t nbSteps, uint32_t activity, size_t nbSamples);
+      uint32_t UtcTimestamp();
+      // The SPI flash is powered down while sleeping: these wake it up for the time of a write
+      bool WakeUpSleepingFlash();
+      void SleepFlash();
+      TickType_t LoopTimeout() const;
       bool stepCounterMustBeReset = false;
+      std::array<Drivers::Bma421::Sample, Drivers::Bma421::maxFifoRead> motionSamples;
+      // The FIFO of the motion sensor is streamed while sleeping during this time after a motion interrupt
+      static constexpr TickType_t motionWindow = pdMS_TO_TICKS(3000);
+      TickType_t motionDetectedTime = 0;
+      bool isMotionDetected = false;
+      // The motion data is pushed by the interrupts of the motion sensor. The loop also wakes up periodically to
+      // update the step count and the backup time, and to reload the watchdog (7s timeout).
+      static constexpr TickType_t runningLoopPeriod = pdMS_TO_TICKS(1000);
+      static constexpr TickType_t sleepingLoopPeriod = pdMS_TO_TICKS(5000);
       static constexpr TickType_t batteryMeasurementPeriod = pdMS_TO_TICKS(10 * 60 * 1000);
-
-      SystemMonitor monitor;
     };
   }
 }
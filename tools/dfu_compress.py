@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+    dfu_compress
+    ~~~~~~~~~~~~
+
+    Compresses a firmware image for the DFU service of InfiniTime and for the recovery loader.
+
+    The input is either a DFU package (.zip generated by adafruit-nrfutil) or a binary image. The application image of
+    a package is replaced by the compressed image, the init packet (.dat) is kept: its CRC is the CRC of the
+    uncompressed image, which is what InfiniTime checks once the image is decompressed in the SPI flash.
+
+    Format (decoded by Pinetime::Tools::LzDecoder, src/components/lz):
+      - header: the magic "ITLZ" and the size of the decoded image (uint32, little endian)
+      - groups of 8 tokens, each group starting with a control byte. The bit i (LSB first) of the control byte is the
+        type of the token i: 1 for a literal (1 byte), 0 for a match (uint16, little endian). A match copies
+        (value >> 11) + 3 bytes from (value & 0x7ff) + 1 bytes before, in the decoded data (window of 2 KiB).
+"""
+
+import argparse
+import json
+import struct
+import zipfile
+
+MAGIC = b'ITLZ'
+WINDOW_SIZE = 1 << 11
+MIN_MATCH = 3
+MAX_MATCH = (1 << 5) + MIN_MATCH - 1
+MAX_CHAIN = 128
+
+
+def compress(data):
+    """ Compresses data with LZSS (hash chains, lazy matching) and returns the compressed image """
+    size = len(data)
+    heads = {}
+    previous = [-1] * size
+
+    def insert(position):
+        if position + MIN_MATCH <= size:
+            key = data[position:position + MIN_MATCH]
+            previous[position] = heads.get(key, -1)
+            heads[key] = position
+
+    def longest_match(position):
+        best_length = 0
+        best_distance = 0
+        if position + MIN_MATCH > size:
+            return best_length, best_distance
+        limit = min(MAX_MATCH, size - position)
+        candidate = heads.get(data[position:position + MIN_MATCH], -1)
+        chain = 0
+        while candidate >= 0 and position - candidate <= WINDOW_SIZE and chain < MAX_CHAIN:
+            # Only the candidates that can be longer than the best match are compared
+            if data[candidate + best_length] == data[position + best_length]:
+                length = MIN_MATCH
+                while length < limit and data[candidate + length] == data[position + length]:
+                    length += 1
+                if length > best_length:
+                    best_length = length
+                    best_distance = position - candidate
+                    if length == limit:
+                        break
+            candidate = previous[candidate]
+            chain += 1
+        return best_length, best_distance
+
+    out = bytearray(MAGIC + struct.pack('<I', size))
+    tokens = bytearray()
+    control = 0
+    count = 0
+
+    def emit(literal, token):
+        nonlocal control, count, tokens
+        if literal:
+            control |= 1 << count
+        tokens += token
+        count += 1
+        if count == 8:
+            out.append(control)
+            out.extend(tokens)
+            control = 0
+            count = 0
+            tokens = bytearray()
+
+    position = 0
+    while position < size:
+        length, distance = longest_match(position)
+        insert(position)
+        if length >= MIN_MATCH:
+            # Lazy matching: a literal followed by a longer match is better
+            next_length, _ = longest_match(position + 1)
+            if next_length > length + 1:
+                emit(True, data[position:position + 1])
+                position += 1
+                continue
+            emit(False, struct.pack('<H', ((length - MIN_MATCH) << 11) | (distance - 1)))
+            for i in range(1, length):
+                insert(position + i)
+            position += length
+        else:
+            emit(True, data[position:position + 1])
+            position += 1
+
+    if count > 0:
+        out.append(control)
+        out.extend(tokens)
+    return bytes(out)
+
+
+def decompress(image):
+    """ Reference decoder, used to check the compressed image """
+    if image[:4] != MAGIC:
+        raise ValueError('not a compressed image')
+    size, = struct.unpack_from('<I', image, 4)
+    out = bytearray()
+    index = 8
+    while len(out) < size:
+        control = image[index]
+        index += 1
+        for bit in range(8):
+            if len(out) >= size:
+                break
+            if control & (1 << bit):
+                out.append(image[index])
+                index += 1
+            else:
+                value, = struct.unpack_from('<H', image, index)
+                index += 2
+                distance = (value & 0x7ff) + 1
+                if distance > len(out):
+                    raise ValueError('invalid distance')
+                for _ in range((value >> 11) + MIN_MATCH):
+                    out.append(out[-distance])
+    return bytes(out)
+
+
+def compress_checked(data):
+    image = compress(data)
+    if decompress(image) != data:
+        raise RuntimeError('the compressed image is corrupted')
+    return image
+
+
+def compress_package(source, destination):
+    """ Replaces the application image of a DFU package by the compressed image """
+    with zipfile.ZipFile(source) as package:
+        manifest = json.loads(package.read('manifest.json'))
+        binary = manifest['manifest']['application']['bin_file']
+        files = {name: package.read(name) for name in package.namelist()}
+
+    original_size = len(files[binary])
+    files[binary] = compress_checked(files[binary])
+    with zipfile.ZipFile(destination, 'w', zipfile.ZIP_DEFLATED) as package:
+        for name, content in files.items():
+            package.writestr(name, content)
+    return original_size, len(files[binary])
+
+
+def main():
+    """ Main func """
+    parser = argparse.ArgumentParser(description='Compresses a firmware image for the DFU and the recovery loader.')
+    parser.add_argument('input', help='DFU package (.zip) or binary image')
+    parser.add_argument('output', help='compressed DFU package or binary image')
+    args = parser.parse_args()
+
+    if zipfile.is_zipfile(args.input):
+        original_size, compressed_size = compress_package(args.input, args.output)
+    else:
+        with open(args.input, 'rb') as in_file:
+            data = in_file.read()
+        image = compress_checked(data)
+        with open(args.output, 'wb') as out_file:
+            out_file.write(image)
+        original_size, compressed_size = len(data), len(image)
+
+    print('%s: %d -> %d bytes (%.1f%%)' % (args.output, original_size, compressed_size,
+                                           100.0 * compressed_size / max(original_size, 1)))
+
+
+if __name__ == '__main__':
+    main()
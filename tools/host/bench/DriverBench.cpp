@@ -0,0 +1,315 @@
+// Driver level benchmarks run against the simulated SPI/TWI buses.
+// Usage: driver-bench [--trace <file.csv>]
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "components/profiling/FrameProfiler.h"
+#include "drivers/Cst816s.h"
+#include "drivers/PinMap.h"
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/SpiNorFlash.h"
+#include "drivers/St7789.h"
+#include "drivers/TwiMaster.h"
+#include "SimBus.h"
+#include "SimClock.h"
+#include "devices/SpiNorFlashModel.h"
+#include "devices/St7789Model.h"
+#include "devices/TwiRegisterDevice.h"
+
+using namespace Pinetime;
+
+namespace {
+  constexpr uint8_t touchPanelTwiAddress = 0x15;
+
+  Drivers::SpiMaster spi {Drivers::SpiMaster::SpiModule::SPI0,
+                          {Drivers::SpiMaster::BitOrder::Msb_Lsb,
+                           Drivers::SpiMaster::Modes::Mode3,
+                           Drivers::SpiMaster::Frequencies::Freq8Mhz,
+                           PinMap::SpiSck,
+                           PinMap::SpiMosi,
+                           PinMap::SpiMiso}};
+  Drivers::Spi lcdSpi {spi, PinMap::SpiLcdCsn};
+  Drivers::Spi flashSpi {spi, PinMap::SpiFlashCsn};
+  Drivers::St7789 lcd {lcdSpi, PinMap::LcdDataCommand, PinMap::LcdReset};
+  Drivers::SpiNorFlash spiNorFlash {flashSpi};
+  Drivers::TwiMaster twiMaster {NRF_TWIM1, TWIM_FREQUENCY_FREQUENCY_K400, PinMap::TwiSda, PinMap::TwiScl};
+  Drivers::Cst816S touchPanel {twiMaster, touchPanelTwiAddress};
+
+  Controllers::FrameProfiler frameProfiler;
+
+  Sim::St7789Model lcdModel {PinMap::LcdDataCommand};
+  Sim::SpiNorFlashModel flashModel;
+  Sim::TwiRegisterDevice touchPanelModel;
+
+  struct Measure {
+    uint64_t start;
+    size_t firstTransaction;
+
+    Measure() : start {Sim::Clock::Now()}, firstTransaction {Sim::Bus::Instance().Transactions().size()} {
+      spi.ResetStatistics();
+    }
+
+    uint64_t ElapsedUs() const {
+      return (Sim::Clock::Now() - start) / 1000;
+    }
+
+    size_t Transactions() const {
+      return Sim::Bus::Instance().Transactions().size() - firstTransaction;
+    }
+  };
+
+  // Pixel value written at (x, y) by the benchmarks, to check where the pixels end up in the frame memory
+  uint16_t PatternPixel(uint16_t x, uint16_t y, uint16_t frame) {
+    return static_cast<uint16_t>((y * 251) ^ (x * 7) ^ frame);
+  }
+
+  void DrawArea(uint16_t x,
+                uint16_t y,
+                uint16_t width,
+                uint16_t height,
+                uint16_t frame,
+                uint8_t* buffer,
+                const std::function<void()>& transferCompleteHook) {
+    size_t i = 0;
+    for (uint16_t line = y; line < y + height; line++) {
+      for (uint16_t column = x; column < x + width; column++) {
+        uint16_t pixel = PatternPixel(column, line, frame);
+        buffer[i++] = pixel >> 8;
+        buffer[i++] = pixel & 0xff;
+      }
+    }
+    lcd.DrawBuffer(x, y, width, height, buffer, width * height * 2, transferCompleteHook);
+  }
+
+  bool CheckArea(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t frame) {
+    for (uint16_t line = y; line < y + height; line++) {
+      for (uint16_t column = x; column < x + width; column++) {
+        if (lcdModel.Pixel(column, line) != PatternPixel(column, line, frame)) {
+          printf("  mismatch at (%u, %u)\n", column, line);
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void FullScreenRedraw(uint16_t nbLines) {
+    static uint8_t buffer[240 * 240 * 2];
+    lcdModel.ResetStats();
+    Measure measure;
+
+    for (uint16_t y = 0; y < 240; y += nbLines) {
+      DrawArea(0, y, 240, nbLines, nbLines, buffer, nullptr);
+    }
+    lcd.EndFrame();
+
+    const auto& lcdStats = lcdModel.Stats();
+    const auto& spiStats = spi.Statistics();
+    printf("full-screen redraw (%3u lines/stripe): %6" PRIu64 " us  %4zu transactions  %3" PRIu32 " commands  %5" PRIu32
+           " overhead bytes  %6" PRIu32 " pixel bytes  %4" PRIu32 " interrupts  %3" PRIu32 " window updates skipped%s\n",
+           nbLines,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           lcdStats.commands,
+           lcdStats.parameterBytes + lcdStats.commands,
+           lcdStats.pixelBytes,
+           spiStats.interrupts,
+           lcd.LastFrameStatistics().skippedWindowUpdates,
+           CheckArea(0, 0, 240, 240, nbLines) ? "" : "  FRAME MEMORY MISMATCH");
+  }
+
+  // A small label redrawn every second, in stripes of the size of a 4-line draw buffer
+  void SmallUpdates(uint16_t nbFrames) {
+    static uint8_t buffer[240 * 4 * 2];
+    constexpr uint16_t x = 100;
+    constexpr uint16_t y = 180;
+    constexpr uint16_t width = 60;
+    constexpr uint16_t height = 20;
+    constexpr uint16_t linesPerStripe = sizeof(buffer) / 2 / width;
+    lcdModel.ResetStats();
+    Measure measure;
+
+    bool ok = true;
+    for (uint16_t frame = 0; frame < nbFrames; frame++) {
+      for (uint16_t line = y; line < y + height; line += linesPerStripe) {
+        DrawArea(x, line, width, std::min<uint16_t>(linesPerStripe, y + height - line), frame, buffer, nullptr);
+      }
+      lcd.EndFrame();
+      ok = ok && CheckArea(x, y, width, height, frame);
+    }
+
+    const auto& lcdStats = lcdModel.Stats();
+    printf("small update %ux%u (%3u frames):    %6" PRIu64 " us  %4zu transactions  %3" PRIu32 " commands  %5" PRIu32
+           " overhead bytes  %6" PRIu32 " pixel bytes%s\n",
+           width,
+           height,
+           nbFrames,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           lcdStats.commands,
+           lcdStats.parameterBytes + lcdStats.commands,
+           lcdStats.pixelBytes,
+           ok ? "" : "  FRAME MEMORY MISMATCH");
+  }
+
+  // Frames flushed like LittleVgl does, one per simulated second, measured by the FrameProfiler
+  void ProfiledFrames(uint16_t nbFrames, uint16_t nbLines) {
+    static uint8_t buffer[240 * 240 * 2];
+    frameProfiler.SetScreen(static_cast<uint8_t>(nbLines));
+    for (uint16_t frame = 0; frame < nbFrames; frame++) {
+      uint64_t start = Sim::Clock::Now();
+      frameProfiler.StartRefresh();
+      for (uint16_t y = 0; y < 240; y += nbLines) {
+        bool last = (y + nbLines >= 240);
+        frameProfiler.OnFlush(240 * nbLines * 2, last);
+        DrawArea(0, y, 240, nbLines, frame, buffer, []() {
+          frameProfiler.OnFlushComplete();
+        });
+      }
+      frameProfiler.EndRefresh();
+      lcd.EndFrame();
+      frameProfiler.OnFrameCommands(lcd.LastFrameStatistics().commands);
+      Sim::Clock::Advance(1000000000ULL - (Sim::Clock::Now() - start));
+    }
+    // Takes the measurement of the flush of the last frame into account
+    frameProfiler.StartRefresh();
+
+    std::array<Controllers::FrameProfiler::Summary, Controllers::FrameProfiler::nbScreens> summaries;
+    frameProfiler.GetSummaries(summaries);
+    const auto& summary = summaries[0];
+    printf("profiled frames (%3u lines/stripe):  %3" PRIu32 " frames  %u.%u fps  render %6" PRIu32 " us (max %6" PRIu32
+           ")  flush %6" PRIu32 " us (max %6" PRIu32 ")  %6" PRIu32 " bytes  %3u areas  %3u commands\n",
+           nbLines,
+           summary.frames,
+           summary.frameRate / 10,
+           summary.frameRate % 10,
+           summary.averageRenderUs,
+           summary.maxRenderUs,
+           summary.averageFlushUs,
+           summary.maxFlushUs,
+           summary.averageBytes,
+           summary.averageAreas,
+           summary.averageCommands);
+  }
+
+  void FlashRead(size_t total, size_t readSize) {
+    static uint8_t buffer[4096];
+    flashModel.ResetStats();
+    Measure measure;
+
+    for (size_t offset = 0; offset < total; offset += readSize) {
+      spiNorFlash.Read(0x100000 + offset, buffer, readSize);
+    }
+
+    printf("flash read %zu B in %4zu B reads:             %6" PRIu64 " us  %4zu transactions  %6" PRIu32 " bytes read\n",
+           total,
+           readSize,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           flashModel.Stats().bytesRead);
+  }
+
+  void FlashEraseAndProgram(size_t total) {
+    static uint8_t buffer[4096];
+    std::memset(buffer, 0x5a, sizeof(buffer));
+    flashModel.ResetStats();
+    Measure measure;
+
+    spiNorFlash.SectorErase(0x200000);
+    spiNorFlash.Write(0x200000, buffer, total);
+
+    printf("flash erase + program %zu B:                  %6" PRIu64 " us  %4zu transactions  %4" PRIu32 " status polls\n",
+           total,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           flashModel.Stats().statusPolls);
+  }
+
+  void FlashMultiPageProgram(uint32_t address, size_t total) {
+    static uint8_t buffer[4096];
+    std::memset(buffer, 0xa5, sizeof(buffer));
+    flashModel.ResetStats();
+    Measure measure;
+
+    spiNorFlash.Write(address, buffer, total);
+
+    printf("flash program %zu B at 0x%06" PRIx32 ":               %6" PRIu64 " us  %4zu transactions  %4" PRIu32
+           " page programs  %4" PRIu32 " status polls\n",
+           total,
+           address,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           flashModel.Stats().pagePrograms,
+           flashModel.Stats().statusPolls);
+  }
+
+  void TouchRead(size_t count) {
+    twiMaster.ResetStatistics();
+    Measure measure;
+    for (size_t i = 0; i < count; i++) {
+      touchPanel.GetTouchInfo();
+    }
+    const auto& twiStatistics = twiMaster.Statistics().front();
+    printf("touch panel read x%zu:                        %6" PRIu64 " us  %4zu bus transfers  %4" PRIu32 " TWI transactions  %4" PRIu32
+           " bytes  %4" PRIu32 " errors\n",
+           count,
+           measure.ElapsedUs(),
+           measure.Transactions(),
+           twiStatistics.transactions,
+           twiStatistics.bytes,
+           twiStatistics.errors);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* traceFile = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      traceFile = argv[++i];
+    }
+  }
+
+  auto& bus = Sim::Bus::Instance();
+  bus.AttachSpi(PinMap::SpiLcdCsn, lcdModel);
+  bus.AttachSpi(PinMap::SpiFlashCsn, flashModel);
+  bus.AttachTwi(touchPanelTwiAddress, touchPanelModel);
+
+  spi.Init();
+  twiMaster.Init();
+  lcd.Init();
+  spiNorFlash.Init();
+  touchPanel.Init();
+  bus.ClearTransactions();
+
+  for (uint16_t nbLines : {4, 8, 16, 24, 40}) {
+    FullScreenRedraw(nbLines);
+  }
+  SmallUpdates(10);
+  ProfiledFrames(5, 4);
+  ProfiledFrames(5, 24);
+  // littlefs reads through its cache, in chunks of cache_size bytes
+  for (size_t readSize : {16, 64, 256, 4096}) {
+    FlashRead(4096, readSize);
+  }
+  FlashEraseAndProgram(4096);
+  // Unaligned start: the write is split on the page boundaries
+  FlashMultiPageProgram(0x300080, 2048);
+  spiNorFlash.SetReadMode(Drivers::SpiNorFlash::ReadModes::Fast);
+  FlashRead(4096, 256);
+  spiNorFlash.SetReadMode(Drivers::SpiNorFlash::ReadModes::Normal);
+  TouchRead(100);
+
+  if (traceFile != nullptr) {
+    FILE* output = fopen(traceFile, "w");
+    if (output == nullptr) {
+      perror(traceFile);
+      return 1;
+    }
+    bus.DumpCsv(output);
+    fclose(output);
+  }
+  return 0;
+}
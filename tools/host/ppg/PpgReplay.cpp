@@ -0,0 +1,298 @@
+// Replays HRS3300 recordings through Controllers::Ppg the same way HeartRateTask does, and compares the heart rate
+// estimations with the reference values of the recordings.
+// Usage: ppg-replay [--csv <results.csv>] [recording.csv...]
+// Without recording, a set of synthetic signals is replayed.
+//
+// Recording format: one sample per line, taken every Ppg::deltaTms milliseconds: "hrs,als[,reference bpm]".
+// A missing or 0 reference means it's unknown for this sample. Empty lines, comments (#) and headers are ignored.
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "components/heartrate/Ppg.h"
+
+using namespace Pinetime;
+
+namespace {
+  struct Sample {
+    uint32_t hrs;
+    uint32_t als;
+    int referenceBpm;
+  };
+
+  struct Recording {
+    std::string name;
+    std::vector<Sample> samples;
+  };
+
+  // Counts the CPU cycles spent in user space by this process. These are cycles of the host CPU: use them to compare
+  // versions of the algorithm, not as an estimation of the cost on the Cortex-M4 of the watch.
+  class CycleCounter {
+  public:
+    CycleCounter() {
+      perf_event_attr attributes {};
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.size = sizeof(attributes);
+      attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      fd = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+
+    ~CycleCounter() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+
+    bool Available() const {
+      return fd >= 0;
+    }
+
+    uint64_t Read() const {
+      uint64_t value = 0;
+      if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+      }
+      return value;
+    }
+
+  private:
+    int fd = -1;
+  };
+
+  struct ReplayStatistics {
+    size_t samples = 0;
+    size_t referenceSamples = 0;
+    size_t estimatedSamples = 0;
+    size_t within5Bpm = 0;
+    double absoluteErrorSum = 0;
+    double squaredErrorSum = 0;
+    int firstEstimateSample = -1;
+    size_t resets = 0;
+
+    size_t calls = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t totalCycles = 0;
+    uint64_t maxCycles = 0;
+
+    void Add(const ReplayStatistics& other) {
+      samples += other.samples;
+      referenceSamples += other.referenceSamples;
+      estimatedSamples += other.estimatedSamples;
+      within5Bpm += other.within5Bpm;
+      absoluteErrorSum += other.absoluteErrorSum;
+      squaredErrorSum += other.squaredErrorSum;
+      resets += other.resets;
+      calls += other.calls;
+      totalNs += other.totalNs;
+      maxNs = std::max(maxNs, other.maxNs);
+      totalCycles += other.totalCycles;
+      maxCycles = std::max(maxCycles, other.maxCycles);
+    }
+  };
+
+  bool LoadRecording(const char* path, Recording& recording) {
+    FILE* input = fopen(path, "r");
+    if (input == nullptr) {
+      perror(path);
+      return false;
+    }
+    recording.name = path;
+    char line[128];
+    while (fgets(line, sizeof(line), input) != nullptr) {
+      Sample sample {};
+      if (sscanf(line, "%" SCNu32 " , %" SCNu32 " , %d", &sample.hrs, &sample.als, &sample.referenceBpm) >= 2) {
+        recording.samples.push_back(sample);
+      }
+    }
+    fclose(input);
+    return true;
+  }
+
+  // PPG-like signal: pulse (fundamental and first harmonic), respiration, slow drift of the DC level and sensor noise
+  Recording SyntheticRecording(const char* name, float startBpm, float endBpm, float noise, uint32_t als) {
+    constexpr float pi = 3.14159265f;
+    constexpr float duration = 120.0f;
+    constexpr float deltaT = Controllers::Ppg::deltaTms / 1000.0f;
+    std::mt19937 generator {42};
+    std::normal_distribution<float> sensorNoise {0.0f, noise};
+
+    Recording recording {name, {}};
+    float phase = 0.0f;
+    for (float t = 0.0f; t < duration; t += deltaT) {
+      float bpm = startBpm + (endBpm - startBpm) * t / duration;
+      phase += 2.0f * pi * (bpm / 60.0f) * deltaT;
+      float value = 8000.0f + 30.0f * std::sin(phase) + 8.0f * std::sin(2.0f * phase + 0.8f) + 12.0f * std::sin(2.0f * pi * 0.25f * t) +
+                    1.0f * t + sensorNoise(generator);
+      recording.samples.push_back({static_cast<uint32_t>(std::max(value, 0.0f)), als, static_cast<int>(bpm + 0.5f)});
+    }
+    return recording;
+  }
+
+  std::vector<Recording> SyntheticRecordings() {
+    return {SyntheticRecording("synthetic rest 60", 60, 60, 3, 20),
+            SyntheticRecording("synthetic 75", 75, 75, 3, 20),
+            SyntheticRecording("synthetic 100 noisy", 100, 100, 15, 20),
+            SyntheticRecording("synthetic 140", 140, 140, 3, 20),
+            SyntheticRecording("synthetic 180", 180, 180, 3, 20),
+            SyntheticRecording("synthetic ramp 70-130", 70, 130, 3, 20)};
+  }
+
+  // Same processing as HeartRateTask::Work(), one sample per iteration
+  ReplayStatistics Replay(const Recording& recording, const CycleCounter& cycleCounter, FILE* csv) {
+    Controllers::Ppg ppg;
+    ReplayStatistics statistics;
+    int displayedBpm = 0;
+    uint64_t readOverhead = cycleCounter.Read();
+    readOverhead = cycleCounter.Read() - readOverhead;
+
+    for (size_t i = 0; i < recording.samples.size(); i++) {
+      const auto& sample = recording.samples[i];
+      int8_t ambient = ppg.Preprocess(sample.hrs, sample.als);
+
+      auto startTime = std::chrono::steady_clock::now();
+      uint64_t startCycles = cycleCounter.Read();
+      int bpm = ppg.HeartRate();
+      uint64_t cycles = cycleCounter.Read() - startCycles;
+      auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+      cycles = cycles > readOverhead ? cycles - readOverhead : 0;
+
+      statistics.calls++;
+      statistics.totalNs += ns;
+      statistics.maxNs = std::max(statistics.maxNs, ns);
+      statistics.totalCycles += cycles;
+      statistics.maxCycles = std::max(statistics.maxCycles, cycles);
+
+      if (ambient > 0) {
+        ppg.Reset(true);
+        displayedBpm = 0;
+        statistics.resets++;
+      } else if (bpm < 0) {
+        ppg.Reset(false);
+        displayedBpm = 0;
+        statistics.resets++;
+      } else if (bpm > 0) {
+        displayedBpm = bpm;
+      }
+
+      statistics.samples++;
+      if (displayedBpm > 0 && statistics.firstEstimateSample < 0) {
+        statistics.firstEstimateSample = static_cast<int>(i);
+      }
+      if (sample.referenceBpm > 0) {
+        statistics.referenceSamples++;
+        if (displayedBpm > 0) {
+          int error = std::abs(displayedBpm - sample.referenceBpm);
+          statistics.estimatedSamples++;
+          statistics.absoluteErrorSum += error;
+          statistics.squaredErrorSum += static_cast<double>(error) * error;
+          if (error <= 5) {
+            statistics.within5Bpm++;
+          }
+        }
+      }
+
+      if (csv != nullptr) {
+        fprintf(csv,
+                "%s,%.1f,%" PRIu32 ",%" PRIu32 ",%d,%d,%" PRIu64 ",%" PRIu64 "\n",
+                recording.name.c_str(),
+                i * Controllers::Ppg::deltaTms / 1000.0,
+                sample.hrs,
+                sample.als,
+                sample.referenceBpm,
+                displayedBpm,
+                ns,
+                cycles);
+      }
+    }
+    return statistics;
+  }
+
+  void Print(const char* name, const ReplayStatistics& statistics, bool cyclesAvailable) {
+    double estimated = statistics.estimatedSamples > 0 ? static_cast<double>(statistics.estimatedSamples) : 1.0;
+    double calls = statistics.calls > 0 ? static_cast<double>(statistics.calls) : 1.0;
+    char firstEstimate[16] = "-";
+    if (statistics.firstEstimateSample >= 0) {
+      snprintf(firstEstimate, sizeof(firstEstimate), "%.1f s", statistics.firstEstimateSample * Controllers::Ppg::deltaTms / 1000.0);
+    }
+    printf("%-24s %6zu samples  first %7s  coverage %5.1f%%  MAE %5.1f  RMSE %5.1f  within 5 BPM %5.1f%%  %3zu resets  "
+           "HeartRate() %6.0f ns (max %6" PRIu64 ")",
+           name,
+           statistics.samples,
+           firstEstimate,
+           statistics.referenceSamples > 0 ? 100.0 * statistics.estimatedSamples / statistics.referenceSamples : 0.0,
+           statistics.absoluteErrorSum / estimated,
+           std::sqrt(statistics.squaredErrorSum / estimated),
+           100.0 * statistics.within5Bpm / estimated,
+           statistics.resets,
+           statistics.totalNs / calls,
+           statistics.maxNs);
+    if (cyclesAvailable) {
+      printf("  %7.0f cycles (max %7" PRIu64 ")", statistics.totalCycles / calls, statistics.maxCycles);
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* csvFile = nullptr;
+  std::vector<Recording> recordings;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+      csvFile = argv[++i];
+    } else {
+      Recording recording;
+      if (!LoadRecording(argv[i], recording)) {
+        return 1;
+      }
+      recordings.push_back(std::move(recording));
+    }
+  }
+  if (recordings.empty()) {
+    recordings = SyntheticRecordings();
+  }
+
+  FILE* csv = nullptr;
+  if (csvFile != nullptr) {
+    csv = fopen(csvFile, "w");
+    if (csv == nullptr) {
+      perror(csvFile);
+      return 1;
+    }
+    fprintf(csv, "recording,time_s,hrs,als,reference_bpm,estimated_bpm,heartrate_ns,heartrate_cycles\n");
+  }
+
+  CycleCounter cycleCounter;
+  if (!cycleCounter.Available()) {
+    printf("CPU cycle counter not available (perf_event_open), only reporting durations\n");
+  }
+
+  ReplayStatistics total;
+  for (const auto& recording : recordings) {
+    auto statistics = Replay(recording, cycleCounter, csv);
+    Print(recording.name.c_str(), statistics, cycleCounter.Available());
+    total.Add(statistics);
+  }
+  if (recordings.size() > 1) {
+    Print("total", total, cycleCounter.Available());
+  }
+
+  if (csv != nullptr) {
+    fclose(csv);
+  }
+  return 0;
+}
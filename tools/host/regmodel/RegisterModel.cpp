@@ -0,0 +1,283 @@
+#include "RegisterModel.h"
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using namespace Pinetime::Sim::Registers;
+
+NRF_SPIM_Type simSpim0;
+NRF_SPIM_Type simSpim1;
+NRF_TIMER_Type simTimer3;
+
+namespace {
+  // Registers are global objects: the registries are function-local statics so that they are constructed first
+  std::map<Address, Task*>& Tasks() {
+    static std::map<Address, Task*> tasks;
+    return tasks;
+  }
+
+  std::map<Address, std::pair<uint8_t*, size_t>>& Buffers() {
+    static std::map<Address, std::pair<uint8_t*, size_t>> buffers;
+    return buffers;
+  }
+
+  struct Irq {
+    Peripheral* peripheral;
+    Hardware::Handler handler = nullptr;
+    bool enabled = false;
+  };
+
+  std::map<int, Irq>& Irqs() {
+    static std::map<int, Irq> irqs {{SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, {&simSpim0}}, {TIMER3_IRQn, {&simTimer3}}};
+    return irqs;
+  }
+
+  void TriggerTask(Address address) {
+    if (address == 0) {
+      return;
+    }
+    auto it = Tasks().find(address);
+    if (it != Tasks().end()) {
+      it->second->Trigger();
+    }
+  }
+
+  // Interrupt enable bits of the events, they are the event register offset / 4
+  constexpr uint32_t spimStoppedMask = 1 << 1;
+  constexpr uint32_t spimEndRxMask = 1 << 4;
+  constexpr uint32_t spimEndMask = 1 << 6;
+  constexpr uint32_t spimEndTxMask = 1 << 8;
+  constexpr uint32_t spimStartedMask = 1 << 19;
+  constexpr uint32_t timerCompare0Mask = 1 << 16;
+}
+
+Task::Task() {
+  Tasks()[AddressOf(*this)] = this;
+}
+
+void Event::Generate() {
+  value = 1;
+  Ppi::Instance().OnEvent(AddressOf(*this));
+}
+
+Event::operator uint32_t() const {
+  if (value == 0 && !Hardware::InInterrupt()) {
+    Hardware::Step();
+  }
+  return value;
+}
+
+void Memory::Map(const void* buffer, size_t size) {
+  // Two buffers whose addresses only differ in the upper 32 bits can't be told apart
+  auto address = static_cast<Address>(reinterpret_cast<uintptr_t>(buffer));
+  auto next = Buffers().lower_bound(address);
+  if ((next != Buffers().end() && next->first < address + size) || Resolve(address, 1) != nullptr) {
+    std::fprintf(stderr, "EasyDMA buffer at 0x%08x overlaps a mapped buffer\n", address);
+    std::abort();
+  }
+  Buffers()[address] = {const_cast<uint8_t*>(static_cast<const uint8_t*>(buffer)), size};
+}
+
+void Memory::Unmap(const void* buffer) {
+  Buffers().erase(static_cast<Address>(reinterpret_cast<uintptr_t>(buffer)));
+}
+
+uint8_t* Memory::Resolve(Address address, size_t size) {
+  auto it = Buffers().upper_bound(address);
+  if (it == Buffers().begin()) {
+    return nullptr;
+  }
+  --it;
+  auto offset = address - it->first;
+  if (offset + size > it->second.second) {
+    return nullptr;
+  }
+  return it->second.first + offset;
+}
+
+Ppi& Ppi::Instance() {
+  static Ppi ppi;
+  return ppi;
+}
+
+Ppi::Ppi() {
+  for (size_t group = 0; group < nbGroups; group++) {
+    groupEnable[group].Bind([this, group]() {
+      GroupEnable(group);
+    });
+    groupDisable[group].Bind([this, group]() {
+      GroupDisable(group);
+    });
+  }
+}
+
+void Ppi::OnEvent(Address eep) {
+  std::vector<Address> tasks;
+  for (const auto& channel : channels) {
+    if (channel.enabled && channel.eep == eep) {
+      tasks.push_back(channel.tep);
+      tasks.push_back(channel.forkTep);
+    }
+  }
+  for (auto task : tasks) {
+    TriggerTask(task);
+  }
+}
+
+void Ppi::GroupEnable(size_t group) {
+  for (size_t channel = 0; channel < nbChannels; channel++) {
+    if ((groups[group] & (1U << channel)) != 0) {
+      channels[channel].enabled = true;
+    }
+  }
+}
+
+void Ppi::GroupDisable(size_t group) {
+  for (size_t channel = 0; channel < nbChannels; channel++) {
+    if ((groups[group] & (1U << channel)) != 0) {
+      channels[channel].enabled = false;
+    }
+  }
+}
+
+void Hardware::SetHandler(int irq, Handler handler) {
+  Irqs()[irq].handler = handler;
+}
+
+void Hardware::EnableIrq(int irq) {
+  Irqs()[irq].enabled = true;
+}
+
+bool Hardware::DispatchInterrupts() {
+  bool dispatched = false;
+  // A handler that doesn't clear its event would be called forever, as on the target
+  for (int i = 0; i < 1000; i++) {
+    bool pending = false;
+    for (auto& [number, irq] : Irqs()) {
+      if (irq.enabled && irq.handler != nullptr && irq.peripheral->InterruptPending()) {
+        pending = true;
+        inInterrupt = true;
+        irq.handler();
+        inInterrupt = false;
+      }
+    }
+    if (!pending) {
+      return dispatched;
+    }
+    dispatched = true;
+  }
+  std::fprintf(stderr, "interrupt storm: an interrupt handler does not clear its event\n");
+  return dispatched;
+}
+
+bool Hardware::Step() {
+  if (DispatchInterrupts()) {
+    return true;
+  }
+  for (auto& [number, irq] : Irqs()) {
+    if (irq.peripheral->Advance()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Hardware::RunUntilIdle() {
+  while (Step()) {
+  }
+}
+
+NRF_SPIM_Type::NRF_SPIM_Type() {
+  TASKS_START.Bind([this]() {
+    if (ENABLE != SPIM_ENABLE_ENABLE_Enabled || busy) {
+      errors++;
+      return;
+    }
+    busy = true;
+    EVENTS_STARTED.Generate();
+  });
+  TASKS_STOP.Bind([this]() {
+    if (busy) {
+      busy = false;
+      EVENTS_STOPPED.Generate();
+    }
+  });
+}
+
+bool NRF_SPIM_Type::InterruptPending() const {
+  return ((intEnable & spimStoppedMask) != 0 && EVENTS_STOPPED.IsSet()) || ((intEnable & spimEndRxMask) != 0 && EVENTS_ENDRX.IsSet()) ||
+         ((intEnable & spimEndMask) != 0 && EVENTS_END.IsSet()) || ((intEnable & spimEndTxMask) != 0 && EVENTS_ENDTX.IsSet()) ||
+         ((intEnable & spimStartedMask) != 0 && EVENTS_STARTED.IsSet());
+}
+
+bool NRF_SPIM_Type::Advance() {
+  if (!busy) {
+    return false;
+  }
+  busy = false;
+
+  uint8_t* tx = (TXD.MAXCNT > 0) ? Memory::Resolve(TXD.PTR, TXD.MAXCNT) : nullptr;
+  uint8_t* rx = (RXD.MAXCNT > 0) ? Memory::Resolve(RXD.PTR, RXD.MAXCNT) : nullptr;
+  if ((TXD.MAXCNT > 0 && tx == nullptr) || (RXD.MAXCNT > 0 && rx == nullptr)) {
+    errors++;
+  } else if (device != nullptr) {
+    device(tx, TXD.MAXCNT, rx, RXD.MAXCNT);
+  }
+
+  TXD.AMOUNT = TXD.MAXCNT;
+  RXD.AMOUNT = RXD.MAXCNT;
+  // Array list: the pointer moves to the next item for the next transfer
+  if (TXD.LIST == SPIM_TXD_LIST_LIST_ArrayList) {
+    TXD.PTR += TXD.MAXCNT;
+  }
+  if (RXD.LIST == SPIM_TXD_LIST_LIST_ArrayList) {
+    RXD.PTR += RXD.MAXCNT;
+  }
+
+  EVENTS_ENDTX.Generate();
+  EVENTS_ENDRX.Generate();
+  EVENTS_END.Generate();
+  return true;
+}
+
+NRF_TIMER_Type::NRF_TIMER_Type() {
+  TASKS_START.Bind([this]() {
+    running = true;
+  });
+  TASKS_STOP.Bind([this]() {
+    running = false;
+  });
+  TASKS_SHUTDOWN.Bind([this]() {
+    running = false;
+    counter = 0;
+  });
+  TASKS_CLEAR.Bind([this]() {
+    counter = 0;
+  });
+  TASKS_COUNT.Bind([this]() {
+    Count();
+  });
+}
+
+void NRF_TIMER_Type::Count() {
+  if (!running || MODE == TIMER_MODE_MODE_Timer) {
+    return;
+  }
+  static constexpr uint32_t masks[] = {0xffff, 0xff, 0xffffff, 0xffffffff};
+  counter = (counter + 1) & masks[BITMODE & 3];
+  for (size_t i = 0; i < 6; i++) {
+    if (CC[i] == counter) {
+      EVENTS_COMPARE[i].Generate();
+    }
+  }
+}
+
+bool NRF_TIMER_Type::InterruptPending() const {
+  for (size_t i = 0; i < 6; i++) {
+    if ((intEnable & (timerCompare0Mask << i)) != 0 && EVENTS_COMPARE[i].IsSet()) {
+      return true;
+    }
+  }
+  return false;
+}
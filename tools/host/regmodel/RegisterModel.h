@@ -0,0 +1,294 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Register level model of the nRF52 peripherals used by the real SpiMaster driver: SPIM0, TIMER3, PPI and the NVIC.
+// Task registers run the task when they are written, events run the PPI channels they are the endpoint of and raise
+// the interrupt of their peripheral. Unlike sim/, which replaces the bus drivers, this model lets the driver sources
+// from src/drivers run unmodified, including their EasyDMA, PPI and interrupt state machines.
+//
+// The driver casts register and buffer addresses to uint32_t, as on the target. The model identifies registers and
+// DMA buffers by these truncated addresses: buffers given to EasyDMA must be mapped with Memory::Map().
+namespace Pinetime {
+  namespace Sim {
+    namespace Registers {
+      using Address = uint32_t;
+
+      template <typename T>
+      Address AddressOf(const T& reg) {
+        return static_cast<Address>(reinterpret_cast<uintptr_t>(&reg));
+      }
+
+      class Task {
+      public:
+        Task();
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        void Bind(std::function<void()> action) {
+          this->action = std::move(action);
+        }
+
+        void Trigger() {
+          if (action != nullptr) {
+            action();
+          }
+        }
+
+        Task& operator=(uint32_t value) {
+          if (value != 0) {
+            Trigger();
+          }
+          return *this;
+        }
+
+        // Task registers are write-only
+        operator uint32_t() const {
+          return 0;
+        }
+
+      private:
+        std::function<void()> action;
+      };
+
+      class Event {
+      public:
+        Event() = default;
+        Event(const Event&) = delete;
+
+        // Sets the event and runs the PPI channels that have it as endpoint
+        void Generate();
+
+        Event& operator=(uint32_t value) {
+          this->value = value;
+          return *this;
+        }
+
+        // Outside of an interrupt handler, reading an event that is not set lets the hardware progress: this is what
+        // makes the busy waits of the driver complete.
+        operator uint32_t() const;
+
+        bool IsSet() const {
+          return value != 0;
+        }
+
+      private:
+        uint32_t value = 0;
+      };
+
+      // INTENSET and INTENCLR: writing sets or clears bits of the interrupt mask, reading returns the mask
+      class InterruptEnable {
+      public:
+        InterruptEnable(uint32_t& mask, bool set) : mask {mask}, set {set} {
+        }
+
+        InterruptEnable& operator=(uint32_t bits) {
+          if (set) {
+            mask |= bits;
+          } else {
+            mask &= ~bits;
+          }
+          return *this;
+        }
+
+        operator uint32_t() const {
+          return mask;
+        }
+
+      private:
+        uint32_t& mask;
+        bool set;
+      };
+
+      class Peripheral {
+      public:
+        virtual ~Peripheral() = default;
+        virtual bool InterruptPending() const = 0;
+
+        // Completes the operation in progress, if any. Returns false if the peripheral is idle.
+        virtual bool Advance() {
+          return false;
+        }
+      };
+
+      // EasyDMA buffers, identified by the 32 bits addresses the driver writes in the PTR registers
+      class Memory {
+      public:
+        static void Map(const void* buffer, size_t size);
+        static void Unmap(const void* buffer);
+        // Returns nullptr if [address, address + size) is not inside a mapped buffer
+        static uint8_t* Resolve(Address address, size_t size);
+      };
+
+      // Programmable PPI channels and channel groups. All the channels that have an event as endpoint are run
+      // together: a task triggered by one of them (CHG[n].DIS for example) only affects the next events.
+      class Ppi {
+      public:
+        static constexpr size_t nbChannels = 20;
+        static constexpr size_t nbGroups = 6;
+
+        struct Channel {
+          Address eep = 0;
+          Address tep = 0;
+          Address forkTep = 0;
+          bool enabled = false;
+        };
+
+        static Ppi& Instance();
+
+        void OnEvent(Address eep);
+        void GroupEnable(size_t group);
+        void GroupDisable(size_t group);
+
+        std::array<Channel, nbChannels> channels;
+        std::array<uint32_t, nbGroups> groups {};
+        Task groupEnable[nbGroups];
+        Task groupDisable[nbGroups];
+
+      private:
+        Ppi();
+      };
+
+      class Hardware {
+      public:
+        using Handler = void (*)();
+
+        static void SetHandler(int irq, Handler handler);
+        static void EnableIrq(int irq);
+
+        // Runs the pending interrupt handlers, or completes the operation in progress of a peripheral.
+        // Returns false if there was nothing to do.
+        static bool Step();
+        static void RunUntilIdle();
+
+        static bool InInterrupt() {
+          return inInterrupt;
+        }
+
+      private:
+        static bool DispatchInterrupts();
+        static inline bool inInterrupt = false;
+      };
+    }
+  }
+}
+
+enum IRQn_Type { SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn = 3, TIMER3_IRQn = 26 };
+
+#define NRFX_IRQ_PRIORITY_SET(irq, priority) (void) (priority)
+#define NRFX_IRQ_ENABLE(irq)                 Pinetime::Sim::Registers::Hardware::EnableIrq(irq)
+
+#define SPIM_ENABLE_ENABLE_Pos        (0UL)
+#define SPIM_ENABLE_ENABLE_Disabled   (0UL)
+#define SPIM_ENABLE_ENABLE_Enabled    (7UL)
+#define SPIM_TXD_LIST_LIST_Pos        (0UL)
+#define SPIM_TXD_LIST_LIST_ArrayList  (1UL)
+#define TIMER_MODE_MODE_Pos           (0UL)
+#define TIMER_MODE_MODE_Timer         (0UL)
+#define TIMER_MODE_MODE_Counter       (1UL)
+#define TIMER_BITMODE_BITMODE_Pos     (0UL)
+#define TIMER_BITMODE_BITMODE_16Bit   (0UL)
+#define TIMER_BITMODE_BITMODE_08Bit   (1UL)
+#define TIMER_BITMODE_BITMODE_24Bit   (2UL)
+#define TIMER_BITMODE_BITMODE_32Bit   (3UL)
+#define TIMER_INTENSET_COMPARE0_Msk   (1UL << 16)
+#define TIMER_INTENSET_COMPARE1_Msk   (1UL << 17)
+
+struct NRF_SPIM_Type : Pinetime::Sim::Registers::Peripheral {
+  using Task = Pinetime::Sim::Registers::Task;
+  using Event = Pinetime::Sim::Registers::Event;
+  using InterruptEnable = Pinetime::Sim::Registers::InterruptEnable;
+
+  struct Dma {
+    uint32_t PTR = 0;
+    uint32_t MAXCNT = 0;
+    uint32_t AMOUNT = 0;
+    uint32_t LIST = 0;
+  };
+
+  // Called for each transfer with the bytes sent, and the buffer to fill with the bytes received
+  using Device = std::function<void(const uint8_t* tx, size_t txSize, uint8_t* rx, size_t rxSize)>;
+
+  NRF_SPIM_Type();
+
+  bool InterruptPending() const override;
+  bool Advance() override;
+
+  Task TASKS_START;
+  Task TASKS_STOP;
+  Event EVENTS_STOPPED;
+  Event EVENTS_ENDRX;
+  Event EVENTS_END;
+  Event EVENTS_ENDTX;
+  Event EVENTS_STARTED;
+
+private:
+  uint32_t intEnable = 0;
+
+public:
+  InterruptEnable INTENSET {intEnable, true};
+  InterruptEnable INTENCLR {intEnable, false};
+  uint32_t ENABLE = 0;
+  struct {
+    uint32_t SCK = 0xffffffff;
+    uint32_t MOSI = 0xffffffff;
+    uint32_t MISO = 0xffffffff;
+  } PSEL;
+  uint32_t& PSELSCK = PSEL.SCK;
+  uint32_t& PSELMOSI = PSEL.MOSI;
+  uint32_t& PSELMISO = PSEL.MISO;
+  uint32_t FREQUENCY = 0;
+  Dma RXD;
+  Dma TXD;
+  uint32_t CONFIG = 0;
+
+  Device device;
+  // Transfers started while the peripheral was disabled or busy, or with a DMA pointer outside of the mapped buffers
+  uint32_t errors = 0;
+
+private:
+  bool busy = false;
+};
+
+struct NRF_TIMER_Type : Pinetime::Sim::Registers::Peripheral {
+  using Task = Pinetime::Sim::Registers::Task;
+  using Event = Pinetime::Sim::Registers::Event;
+  using InterruptEnable = Pinetime::Sim::Registers::InterruptEnable;
+
+  NRF_TIMER_Type();
+
+  bool InterruptPending() const override;
+
+  Task TASKS_START;
+  Task TASKS_STOP;
+  Task TASKS_COUNT;
+  Task TASKS_CLEAR;
+  Task TASKS_SHUTDOWN;
+  Event EVENTS_COMPARE[6];
+
+private:
+  uint32_t intEnable = 0;
+
+public:
+  InterruptEnable INTENSET {intEnable, true};
+  InterruptEnable INTENCLR {intEnable, false};
+  uint32_t MODE = 0;
+  uint32_t BITMODE = 0;
+  uint32_t CC[6] = {};
+
+private:
+  void Count();
+
+  bool running = false;
+  uint32_t counter = 0;
+};
+
+extern NRF_SPIM_Type simSpim0;
+extern NRF_SPIM_Type simSpim1;
+extern NRF_TIMER_Type simTimer3;
+
+#define NRF_SPIM0  (&simSpim0)
+#define NRF_SPIM1  (&simSpim1)
+#define NRF_TIMER3 (&simTimer3)
@@ -0,0 +1,60 @@
+#pragma once
+#include "RegisterModel.h"
+
+enum nrf_ppi_channel_t {
+  NRF_PPI_CHANNEL0,
+  NRF_PPI_CHANNEL1,
+  NRF_PPI_CHANNEL2,
+  NRF_PPI_CHANNEL3,
+  NRF_PPI_CHANNEL4,
+  NRF_PPI_CHANNEL5,
+  NRF_PPI_CHANNEL6,
+  NRF_PPI_CHANNEL7
+};
+enum nrf_ppi_channel_group_t { NRF_PPI_CHANNEL_GROUP0, NRF_PPI_CHANNEL_GROUP1, NRF_PPI_CHANNEL_GROUP2, NRF_PPI_CHANNEL_GROUP3 };
+enum nrf_ppi_task_t {
+  NRF_PPI_TASK_CHG0_EN,
+  NRF_PPI_TASK_CHG0_DIS,
+  NRF_PPI_TASK_CHG1_EN,
+  NRF_PPI_TASK_CHG1_DIS,
+  NRF_PPI_TASK_CHG2_EN,
+  NRF_PPI_TASK_CHG2_DIS,
+  NRF_PPI_TASK_CHG3_EN,
+  NRF_PPI_TASK_CHG3_DIS
+};
+
+inline void nrf_ppi_channel_endpoint_setup(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep) {
+  auto& ppiChannel = Pinetime::Sim::Registers::Ppi::Instance().channels[channel];
+  ppiChannel.eep = eep;
+  ppiChannel.tep = tep;
+}
+
+inline void nrf_ppi_fork_endpoint_setup(nrf_ppi_channel_t channel, uint32_t forkTep) {
+  Pinetime::Sim::Registers::Ppi::Instance().channels[channel].forkTep = forkTep;
+}
+
+inline void nrf_ppi_channel_enable(nrf_ppi_channel_t channel) {
+  Pinetime::Sim::Registers::Ppi::Instance().channels[channel].enabled = true;
+}
+
+inline void nrf_ppi_channel_disable(nrf_ppi_channel_t channel) {
+  Pinetime::Sim::Registers::Ppi::Instance().channels[channel].enabled = false;
+}
+
+inline void nrf_ppi_channel_include_in_group(nrf_ppi_channel_t channel, nrf_ppi_channel_group_t group) {
+  Pinetime::Sim::Registers::Ppi::Instance().groups[group] |= 1U << channel;
+}
+
+inline void nrf_ppi_group_enable(nrf_ppi_channel_group_t group) {
+  Pinetime::Sim::Registers::Ppi::Instance().GroupEnable(group);
+}
+
+inline void nrf_ppi_group_disable(nrf_ppi_channel_group_t group) {
+  Pinetime::Sim::Registers::Ppi::Instance().GroupDisable(group);
+}
+
+inline uint32_t nrf_ppi_task_address_get(nrf_ppi_task_t task) {
+  auto& ppi = Pinetime::Sim::Registers::Ppi::Instance();
+  auto group = task / 2;
+  return Pinetime::Sim::Registers::AddressOf((task % 2 == 0) ? ppi.groupEnable[group] : ppi.groupDisable[group]);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "hal/nrf_gpio.h"
+#include "RegisterModel.h"
+
+// GPIOTE is only used by the Erratum 58 workaround of SpiMaster. The model never generates its event: 1 byte
+// transfers end normally.
+using nrfx_gpiote_pin_t = uint32_t;
+using nrfx_err_t = uint32_t;
+
+#define NRFX_SUCCESS            0
+#define APP_ERROR_CHECK(err)    ASSERT((err) == NRFX_SUCCESS)
+
+enum nrf_gpiote_polarity_t { NRF_GPIOTE_POLARITY_LOTOHI = 1, NRF_GPIOTE_POLARITY_HITOLO, NRF_GPIOTE_POLARITY_TOGGLE };
+
+struct nrfx_gpiote_in_config_t {
+  nrf_gpiote_polarity_t sense;
+  nrf_gpio_pin_pull_t pull;
+  bool is_watcher;
+  bool hi_accuracy;
+  bool skip_gpio_setup;
+};
+
+using nrfx_gpiote_evt_handler_t = void (*)(nrfx_gpiote_pin_t, nrf_gpiote_polarity_t);
+
+inline nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t /*pin*/,
+                                      const nrfx_gpiote_in_config_t* /*config*/,
+                                      nrfx_gpiote_evt_handler_t /*handler*/) {
+  return NRFX_SUCCESS;
+}
+
+inline void nrfx_gpiote_in_uninit(nrfx_gpiote_pin_t /*pin*/) {
+}
+
+inline void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t /*pin*/, bool /*interruptEnable*/) {
+}
+
+inline uint32_t nrfx_gpiote_in_event_addr_get(nrfx_gpiote_pin_t /*pin*/) {
+  return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdio>
+#include "FreeRTOS.h"
+#include "RegisterModel.h"
+
+// Same counters as sim/semphr.h, but a take on an empty semaphore lets the hardware run, and the interrupt handlers
+// give the semaphore, as they would while the task is blocked on the target.
+struct SimSemaphore {
+  UBaseType_t count = 0;
+};
+
+using SemaphoreHandle_t = SimSemaphore*;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return new SimSemaphore {};
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new SimSemaphore {1};
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t /*ticksToWait*/) {
+  while (semaphore->count == 0) {
+    if (!Pinetime::Sim::Registers::Hardware::Step()) {
+      // The hardware is idle and no interrupt is pending: on the target, the task would block forever
+      std::fprintf(stderr, "deadlock: semaphore taken while the hardware is idle\n");
+      return pdFALSE;
+    }
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore->count > 0) {
+    return pdFALSE;
+  }
+  semaphore->count++;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreGive(semaphore);
+}
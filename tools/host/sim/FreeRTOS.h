@@ -0,0 +1,21 @@
+#pragma once
+// Host stand-in for FreeRTOS. The simulation is single threaded: delays advance the simulated clock
+// and semaphores are plain counters.
+#include <cstdint>
+#include <cassert>
+#include "SimClock.h"
+#include "nrf_assert.h"
+
+using TickType_t = uint32_t;
+using BaseType_t = long;
+using UBaseType_t = unsigned long;
+
+#define configTICK_RATE_HZ 1024
+#define pdFALSE            ((BaseType_t) 0)
+#define pdTRUE             ((BaseType_t) 1)
+#define pdPASS             (pdTRUE)
+#define pdFAIL             (pdFALSE)
+#define portMAX_DELAY      ((TickType_t) 0xffffffffUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t) (((TickType_t) (xTimeInMs) * (TickType_t) configTICK_RATE_HZ) / (TickType_t) 1000U))
+#define portYIELD_FROM_ISR(x) (void) (x)
+#define configASSERT(x)       assert(x)
@@ -0,0 +1,118 @@
+#include "SimBus.h"
+#include <cinttypes>
+#include "SimClock.h"
+#include "nrf_registers.h"
+
+using namespace Pinetime::Sim;
+
+NRF_SPIM_Type simSpim0;
+NRF_TWIM_Type simTwim1;
+NRF_TIMER_Type simTimer3;
+
+Bus& Bus::Instance() {
+  static Bus bus;
+  return bus;
+}
+
+void Bus::AttachSpi(uint8_t pinCsn, SpiDevice& device) {
+  spiDevices[pinCsn] = &device;
+}
+
+void Bus::AttachTwi(uint8_t address, TwiDevice& device) {
+  twiDevices[address] = &device;
+}
+
+void Bus::SpiSelect(uint8_t pinCsn) {
+  current = {};
+  current.bus = BusType::Spi;
+  current.device = pinCsn;
+  current.start = Clock::Now();
+  Clock::Advance(timings.spiTransactionOverhead);
+
+  auto it = spiDevices.find(pinCsn);
+  selected = (it != spiDevices.end()) ? it->second : nullptr;
+  if (selected != nullptr) {
+    selected->OnSelect();
+  }
+}
+
+void Bus::SpiWrite(const uint8_t* data, size_t size, uint32_t interrupts) {
+  if (current.txBytes == 0 && current.rxBytes == 0 && size > 0) {
+    current.opcode = data[0];
+  }
+  current.txBytes += size;
+  current.interrupts += interrupts;
+  Clock::Advance((size * timings.spiByte) + (interrupts * timings.spiInterrupt));
+  if (selected != nullptr) {
+    selected->OnWrite(data, size);
+  }
+}
+
+void Bus::SpiRead(uint8_t* data, size_t size) {
+  current.rxBytes += size;
+  Clock::Advance(size * timings.spiByte);
+  if (selected != nullptr) {
+    selected->OnRead(data, size);
+  }
+}
+
+void Bus::SpiDeselect() {
+  if (selected != nullptr) {
+    selected->OnDeselect();
+  }
+  selected = nullptr;
+  current.duration = Clock::Now() - current.start;
+  transactions.push_back(current);
+}
+
+void Bus::AdvanceTwi(uint8_t address, uint8_t opcode, size_t txBytes, size_t rxBytes, bool stop) {
+  Transaction transaction {};
+  transaction.bus = BusType::Twi;
+  transaction.device = address;
+  transaction.opcode = opcode;
+  transaction.txBytes = txBytes;
+  transaction.rxBytes = rxBytes;
+  transaction.start = Clock::Now();
+
+  // (Repeated) start condition, address byte and ACK, then 9 bits (8 data + ACK) per byte
+  uint64_t bits = 1 + 9 + ((txBytes + rxBytes) * 9) + (stop ? 1 : 0);
+  Clock::Advance((twiSuspended ? 0 : timings.twiTransactionOverhead) + (bits * timings.twiBit));
+  twiSuspended = !stop;
+
+  transaction.duration = Clock::Now() - transaction.start;
+  transactions.push_back(transaction);
+}
+
+bool Bus::TwiWrite(uint8_t address, const uint8_t* data, size_t size, bool stop) {
+  AdvanceTwi(address, size > 0 ? data[0] : 0, size, 0, stop);
+  auto it = twiDevices.find(address);
+  if (it == twiDevices.end()) {
+    return false;
+  }
+  return it->second->OnWrite(data, size);
+}
+
+bool Bus::TwiRead(uint8_t address, uint8_t* data, size_t size, bool stop) {
+  AdvanceTwi(address, 0, 0, size, stop);
+  auto it = twiDevices.find(address);
+  if (it == twiDevices.end()) {
+    return false;
+  }
+  return it->second->OnRead(data, size);
+}
+
+void Bus::DumpCsv(FILE* output) const {
+  fprintf(output, "bus,device,opcode,tx_bytes,rx_bytes,interrupts,start_ns,duration_ns\n");
+  for (const auto& t : transactions) {
+    fprintf(output,
+            "%s,%u,0x%02x,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu64 ",%" PRIu64 "\n",
+            t.bus == BusType::Spi ? "spi" : "twi",
+            t.device,
+            t.opcode,
+            t.txBytes,
+            t.rxBytes,
+            t.interrupts,
+            t.start,
+            t.duration);
+  }
+}
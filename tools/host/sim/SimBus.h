@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace Pinetime {
+  namespace Sim {
+    // Timing model of the buses, in nanoseconds. The transfer rates are the ones used by the firmware
+    // (SPI at 8 MHz, TWI at 400 kHz). The overheads are estimations of the CPU work the drivers
+    // do around a transfer on the nRF52832 at 64 MHz.
+    struct Timings {
+      uint64_t spiByte = 1000;
+      uint64_t spiTransactionOverhead = 2000; // mutex, CS, EasyDMA setup
+      uint64_t spiInterrupt = 3000;           // ISR entry, re-arm of the next chunk
+      uint64_t spiErratum58Setup = 6000;      // GPIOTE/PPI setup and busy wait of 1 byte transfers
+      uint64_t twiBit = 2500;
+      uint64_t twiTransactionOverhead = 5000; // start, address and stop conditions, driver setup
+    };
+
+    enum class BusType : uint8_t { Spi, Twi };
+
+    struct Transaction {
+      BusType bus;
+      uint8_t device; // CS pin for SPI, address for TWI
+      uint8_t opcode; // first byte written
+      uint32_t txBytes;
+      uint32_t rxBytes;
+      uint32_t interrupts;
+      uint64_t start;
+      uint64_t duration;
+    };
+
+    class SpiDevice {
+    public:
+      virtual ~SpiDevice() = default;
+      virtual void OnSelect() {
+      }
+      virtual void OnWrite(const uint8_t* data, size_t size) = 0;
+      virtual void OnRead(uint8_t* data, size_t size) = 0;
+      virtual void OnDeselect() {
+      }
+    };
+
+    class TwiDevice {
+    public:
+      virtual ~TwiDevice() = default;
+      virtual bool OnWrite(const uint8_t* data, size_t size) = 0;
+      virtual bool OnRead(uint8_t* data, size_t size) = 0;
+    };
+
+    // Records every transaction and dispatches it to the device model attached to the CS pin or TWI address.
+    class Bus {
+    public:
+      static Bus& Instance();
+
+      void AttachSpi(uint8_t pinCsn, SpiDevice& device);
+      void AttachTwi(uint8_t address, TwiDevice& device);
+
+      void SpiSelect(uint8_t pinCsn);
+      void SpiWrite(const uint8_t* data, size_t size, uint32_t interrupts);
+      void SpiRead(uint8_t* data, size_t size);
+      void SpiDeselect();
+
+      bool TwiWrite(uint8_t address, const uint8_t* data, size_t size, bool stop);
+      bool TwiRead(uint8_t address, uint8_t* data, size_t size, bool stop);
+
+      const std::vector<Transaction>& Transactions() const {
+        return transactions;
+      }
+
+      void ClearTransactions() {
+        transactions.clear();
+      }
+
+      void DumpCsv(FILE* output) const;
+
+      Timings timings;
+
+    private:
+      Bus() = default;
+      void AdvanceTwi(uint8_t address, uint8_t opcode, size_t txBytes, size_t rxBytes, bool stop);
+
+      std::map<uint8_t, SpiDevice*> spiDevices;
+      std::map<uint8_t, TwiDevice*> twiDevices;
+      std::vector<Transaction> transactions;
+      Transaction current {};
+      SpiDevice* selected = nullptr;
+      bool twiSuspended = false;
+    };
+  }
+}
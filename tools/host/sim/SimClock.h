@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Sim {
+    // Simulated time, in nanoseconds. Only bus transfers and task delays make it advance.
+    class Clock {
+    public:
+      static constexpr uint64_t nsPerTick = 1000000000ULL / 1024;
+
+      static uint64_t Now() {
+        return now;
+      }
+
+      static void Advance(uint64_t ns) {
+        now += ns;
+      }
+
+      static void Reset() {
+        now = 0;
+      }
+
+    private:
+      static inline uint64_t now = 0;
+    };
+  }
+}
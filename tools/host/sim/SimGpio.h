@@ -0,0 +1,21 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Sim {
+    class Gpio {
+    public:
+      static void Set(uint32_t pin, bool level) {
+        pins[pin] = level;
+      }
+
+      static bool Get(uint32_t pin) {
+        return pins[pin];
+      }
+
+    private:
+      static inline std::array<bool, 32> pins {};
+    };
+  }
+}
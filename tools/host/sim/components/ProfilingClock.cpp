@@ -0,0 +1,31 @@
+// Host implementation of components/profiling/ProfilingClock.h: both counters follow the simulated clock.
+#include "components/profiling/ProfilingClock.h"
+#include "SimClock.h"
+
+using namespace Pinetime::Controllers;
+
+void ProfilingClock::Init() {
+}
+
+uint32_t ProfilingClock::Cycles() {
+  return static_cast<uint32_t>(Sim::Clock::Now() * cyclesPerUs / 1000);
+}
+
+uint32_t ProfilingClock::Ticks() {
+  return static_cast<uint32_t>(Sim::Clock::Now() * ticksPerSecond / 1000000000ULL) & 0xffffff;
+}
+
+uint32_t ProfilingClock::RunTime() {
+  return static_cast<uint32_t>(Sim::Clock::Now() * ticksPerSecond / 1000000000ULL);
+}
+
+// The simulator never sleeps
+uint32_t ProfilingClock::SleepTime() {
+  return 0;
+}
+
+void ProfilingClock::EnterSleep() {
+}
+
+void ProfilingClock::ExitSleep() {
+}
@@ -0,0 +1,141 @@
+#include "devices/SpiNorFlashModel.h"
+#include <algorithm>
+#include "SimClock.h"
+
+using namespace Pinetime::Sim;
+
+namespace {
+  constexpr uint8_t PageProgram = 0x02;
+  constexpr uint8_t Read = 0x03;
+  constexpr uint8_t ReadStatusRegister = 0x05;
+  constexpr uint8_t WriteEnable = 0x06;
+  constexpr uint8_t FastRead = 0x0b;
+  constexpr uint8_t SectorErase = 0x20;
+  constexpr uint8_t DualOutputFastRead = 0x3b;
+  constexpr uint8_t EraseSuspend = 0x75;
+  constexpr uint8_t EraseResume = 0x7a;
+  constexpr uint8_t ReadIdentification = 0x9f;
+}
+
+SpiNorFlashModel::SpiNorFlashModel() : memory(size, 0xff) {
+}
+
+bool SpiNorFlashModel::Busy() const {
+  return Clock::Now() < busyUntil;
+}
+
+uint32_t SpiNorFlashModel::Address() const {
+  if (command.size() < 4) {
+    return 0;
+  }
+  return ((command[1] << 16) | (command[2] << 8) | command[3]) % size;
+}
+
+size_t SpiNorFlashModel::DataOffset() const {
+  // Opcode, 3 address bytes and the dummy byte of the fast read commands
+  return (command[0] == FastRead || command[0] == DualOutputFastRead) ? 5 : 4;
+}
+
+void SpiNorFlashModel::OnSelect() {
+  command.clear();
+  readOffset = 0;
+}
+
+void SpiNorFlashModel::OnWrite(const uint8_t* data, size_t size) {
+  command.insert(command.end(), data, data + size);
+}
+
+void SpiNorFlashModel::OnRead(uint8_t* data, size_t size) {
+  if (command.empty()) {
+    return;
+  }
+
+  switch (command[0]) {
+    case ReadStatusRegister:
+      statistics.statusPolls++;
+      for (size_t i = 0; i < size; i++) {
+        data[i] = (Busy() ? 0x01 : 0x00) | (writeEnabled ? 0x02 : 0x00);
+      }
+      break;
+    case ReadIdentification: {
+      static constexpr uint8_t id[] = {0x0b, 0x40, 0x16};
+      for (size_t i = 0; i < size; i++) {
+        data[i] = id[i % sizeof(id)];
+      }
+    } break;
+    case Read:
+    case FastRead:
+    case DualOutputFastRead: {
+      if (command.size() == 1) {
+        // Should not happen: the address is sent with the opcode
+        return;
+      }
+      if (readOffset == 0) {
+        statistics.readCommands++;
+      }
+      uint32_t address = Address() + readOffset;
+      for (size_t i = 0; i < size; i++) {
+        data[i] = Busy() ? 0xff : memory[(address + i) % memory.size()];
+      }
+      readOffset += size;
+      statistics.bytesRead += size;
+    } break;
+    default:
+      std::fill(data, data + size, 0);
+      break;
+  }
+}
+
+void SpiNorFlashModel::OnDeselect() {
+  if (command.empty()) {
+    return;
+  }
+
+  if (command[0] == EraseSuspend && Busy() && suspendedRemaining == 0) {
+    suspendedRemaining = busyUntil - Clock::Now();
+    busyUntil = Clock::Now() + suspendLatency;
+    statistics.eraseSuspends++;
+    return;
+  }
+  if (command[0] == EraseResume && suspendedRemaining > 0) {
+    busyUntil = Clock::Now() + suspendedRemaining;
+    suspendedRemaining = 0;
+    return;
+  }
+  if (Busy()) {
+    return;
+  }
+
+  switch (command[0]) {
+    case WriteEnable:
+      writeEnabled = true;
+      break;
+    case PageProgram:
+      if (writeEnabled && command.size() > 4) {
+        uint32_t address = Address();
+        uint32_t pageStart = address & ~(pageSize - 1);
+        size_t length = command.size() - 4;
+        // The address wraps at the end of the page, as on the real device
+        for (size_t i = 0; i < length; i++) {
+          uint32_t a = pageStart + ((address - pageStart + i) % pageSize);
+          memory[a] &= command[4 + i];
+        }
+        statistics.pagePrograms++;
+        statistics.bytesProgrammed += length;
+        busyUntil = Clock::Now() + pageProgramTime;
+        writeEnabled = false;
+      }
+      break;
+    case SectorErase:
+      if (writeEnabled) {
+        uint32_t sectorStart = Address() & ~(sectorSize - 1);
+        std::fill(memory.begin() + sectorStart, memory.begin() + sectorStart + sectorSize, 0xff);
+        statistics.sectorErases++;
+        busyUntil = Clock::Now() + sectorEraseTime;
+        writeEnabled = false;
+      }
+      break;
+    default:
+      break;
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "SimBus.h"
+
+namespace Pinetime {
+  namespace Sim {
+    // Behavioural model of the 4 MiB SPI NOR flash (XT25F32B): program and erase take time,
+    // during which the status register reports Write In Progress.
+    class SpiNorFlashModel : public SpiDevice {
+    public:
+      struct Statistics {
+        uint32_t readCommands = 0;
+        uint32_t statusPolls = 0;
+        uint32_t pagePrograms = 0;
+        uint32_t sectorErases = 0;
+        uint32_t eraseSuspends = 0;
+        uint32_t bytesRead = 0;
+        uint32_t bytesProgrammed = 0;
+      };
+
+      static constexpr size_t size = 4 * 1024 * 1024;
+      static constexpr size_t pageSize = 256;
+      static constexpr size_t sectorSize = 4096;
+      static constexpr uint64_t pageProgramTime = 500000;   // 0.5 ms typ.
+      static constexpr uint64_t sectorEraseTime = 45000000; // 45 ms typ.
+      static constexpr uint64_t suspendLatency = 20000;     // 20 µs max.
+
+      SpiNorFlashModel();
+
+      void OnSelect() override;
+      void OnWrite(const uint8_t* data, size_t size) override;
+      void OnRead(uint8_t* data, size_t size) override;
+      void OnDeselect() override;
+
+      std::vector<uint8_t>& Memory() {
+        return memory;
+      }
+
+      const Statistics& Stats() const {
+        return statistics;
+      }
+
+      void ResetStats() {
+        statistics = {};
+      }
+
+    private:
+      bool Busy() const;
+      uint32_t Address() const;
+      size_t DataOffset() const;
+
+      std::vector<uint8_t> memory;
+      std::vector<uint8_t> command;
+      size_t readOffset = 0;
+      bool writeEnabled = false;
+      uint64_t busyUntil = 0;
+      uint64_t suspendedRemaining = 0;
+      Statistics statistics;
+    };
+  }
+}
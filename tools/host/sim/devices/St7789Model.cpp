@@ -0,0 +1,101 @@
+#include "devices/St7789Model.h"
+#include "SimGpio.h"
+
+using namespace Pinetime::Sim;
+
+namespace {
+  constexpr uint8_t ColumnAddressSet = 0x2a;
+  constexpr uint8_t RowAddressSet = 0x2b;
+  constexpr uint8_t WriteToRam = 0x2c;
+  constexpr uint8_t WriteToRamContinue = 0x3c;
+}
+
+St7789Model::St7789Model(uint8_t pinDataCommand) : pinDataCommand {pinDataCommand} {
+}
+
+void St7789Model::OnSelect() {
+  if (Gpio::Get(pinDataCommand)) {
+    statistics.dataTransactions++;
+  } else {
+    statistics.commandTransactions++;
+  }
+}
+
+void St7789Model::OnWrite(const uint8_t* data, size_t size) {
+  if (Gpio::Get(pinDataCommand)) {
+    if (lastCommand == WriteToRam || lastCommand == WriteToRamContinue) {
+      statistics.pixelBytes += size;
+      for (size_t i = 0; i < size; i++) {
+        OnPixelByte(data[i]);
+      }
+    } else {
+      statistics.parameterBytes += size;
+      for (size_t i = 0; i < size; i++) {
+        OnParameter(data[i]);
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    lastCommand = data[i];
+    nbParameters = 0;
+    highByte = true;
+    statistics.commands++;
+    if (lastCommand == ColumnAddressSet || lastCommand == RowAddressSet) {
+      statistics.windowUpdates++;
+    } else if (lastCommand == WriteToRam) {
+      statistics.ramWrites++;
+      column = columnStart;
+      row = rowStart;
+    } else if (lastCommand == WriteToRamContinue) {
+      statistics.ramWrites++;
+    }
+  }
+}
+
+void St7789Model::OnParameter(uint8_t data) {
+  if (nbParameters >= parameters.size()) {
+    return;
+  }
+  parameters[nbParameters++] = data;
+  if (nbParameters != 4) {
+    return;
+  }
+  uint16_t start = (parameters[0] << 8) | parameters[1];
+  uint16_t end = (parameters[2] << 8) | parameters[3];
+  if (lastCommand == ColumnAddressSet) {
+    columnStart = start;
+    columnEnd = end;
+  } else if (lastCommand == RowAddressSet) {
+    rowStart = start;
+    rowEnd = end;
+  }
+}
+
+void St7789Model::OnPixelByte(uint8_t data) {
+  if (highByte) {
+    pixel = data << 8;
+    highByte = false;
+    return;
+  }
+  pixel |= data;
+  highByte = true;
+
+  if (column < width && row < height) {
+    frameMemory[row * width + column] = pixel;
+  }
+  // The pointer moves along the columns then the rows of the window, and wraps to its start
+  if (column >= columnEnd) {
+    column = columnStart;
+    row = (row >= rowEnd) ? rowStart : row + 1;
+  } else {
+    column++;
+  }
+}
+
+void St7789Model::OnRead(uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    data[i] = 0;
+  }
+}
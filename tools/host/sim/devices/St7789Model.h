@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "SimBus.h"
+
+namespace Pinetime {
+  namespace Sim {
+    // Decodes the command/data stream sent to the display (using the state of the D/C pin) and
+    // writes the pixels in a model of the frame memory.
+    class St7789Model : public SpiDevice {
+    public:
+      struct Statistics {
+        uint32_t commands = 0;
+        uint32_t commandTransactions = 0;
+        uint32_t dataTransactions = 0;
+        uint32_t windowUpdates = 0; // CASET + RASET
+        uint32_t ramWrites = 0; // RAMWR + RAMWRC
+        uint32_t parameterBytes = 0;
+        uint32_t pixelBytes = 0;
+      };
+
+      explicit St7789Model(uint8_t pinDataCommand);
+
+      void OnSelect() override;
+      void OnWrite(const uint8_t* data, size_t size) override;
+      void OnRead(uint8_t* data, size_t size) override;
+
+      const Statistics& Stats() const {
+        return statistics;
+      }
+
+      void ResetStats() {
+        statistics = {};
+      }
+
+      static constexpr uint16_t width = 240;
+      static constexpr uint16_t height = 320;
+
+      uint16_t Pixel(uint16_t x, uint16_t y) const {
+        return frameMemory[y * width + x];
+      }
+
+    private:
+      void OnParameter(uint8_t data);
+      void OnPixelByte(uint8_t data);
+
+      uint8_t pinDataCommand;
+      uint8_t lastCommand = 0;
+      Statistics statistics;
+
+      std::array<uint8_t, 4> parameters;
+      size_t nbParameters = 0;
+      uint16_t columnStart = 0;
+      uint16_t columnEnd = width - 1;
+      uint16_t rowStart = 0;
+      uint16_t rowEnd = height - 1;
+      uint16_t column = 0;
+      uint16_t row = 0;
+      bool highByte = true;
+      uint16_t pixel = 0;
+      std::vector<uint16_t> frameMemory = std::vector<uint16_t>(width * height);
+    };
+  }
+}
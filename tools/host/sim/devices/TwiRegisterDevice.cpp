@@ -0,0 +1,21 @@
+#include "devices/TwiRegisterDevice.h"
+
+using namespace Pinetime::Sim;
+
+bool TwiRegisterDevice::OnWrite(const uint8_t* data, size_t size) {
+  if (size == 0) {
+    return true;
+  }
+  pointer = data[0];
+  for (size_t i = 1; i < size; i++) {
+    registers[pointer++] = data[i];
+  }
+  return true;
+}
+
+bool TwiRegisterDevice::OnRead(uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    data[i] = registers[pointer++];
+  }
+  return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <array>
+#include "SimBus.h"
+
+namespace Pinetime {
+  namespace Sim {
+    // Generic TWI device exposing 256 8-bit registers with auto-increment, like the touch controller,
+    // the accelerometer and the heart rate sensor.
+    class TwiRegisterDevice : public TwiDevice {
+    public:
+      bool OnWrite(const uint8_t* data, size_t size) override;
+      bool OnRead(uint8_t* data, size_t size) override;
+
+      std::array<uint8_t, 256> registers {};
+
+    private:
+      uint8_t pointer = 0;
+    };
+  }
+}
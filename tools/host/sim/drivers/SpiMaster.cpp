@@ -0,0 +1,127 @@
+// Host implementation of drivers/SpiMaster.h: transfers go to the simulated bus and complete synchronously.
+// The number of interrupts charged for each write follows the chunking of the target driver.
+#include "drivers/SpiMaster.h"
+#include <hal/nrf_gpio.h>
+#include "SimBus.h"
+
+using namespace Pinetime::Drivers;
+
+SpiMaster::SpiMaster(const SpiMaster::SpiModule spi, const SpiMaster::Parameters& params) : spi {spi}, params {params} {
+}
+
+bool SpiMaster::Init() {
+  if (mutex == nullptr) {
+    mutex = xSemaphoreCreateBinary();
+  }
+  xSemaphoreGive(mutex);
+  return true;
+}
+
+size_t SpiMaster::ListChunkSize(size_t size) {
+  for (size_t chunkSize = maxChunkSize; chunkSize >= minListChunkSize; chunkSize--) {
+    if (size % chunkSize == 0) {
+      return chunkSize;
+    }
+  }
+  return maxChunkSize;
+}
+
+bool SpiMaster::Write(uint8_t pinCsn,
+                      const uint8_t* data,
+                      size_t size,
+                      const std::function<void()>& preTransactionHook,
+                      const std::function<void()>& postTransactionHook) {
+  if (data == nullptr) {
+    return false;
+  }
+  if (xSemaphoreTake(mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+  auto& bus = Sim::Bus::Instance();
+
+  this->pinCsn = pinCsn;
+  if (preTransactionHook != nullptr) {
+    preTransactionHook();
+  }
+  nrf_gpio_pin_clear(pinCsn);
+  bus.SpiSelect(pinCsn);
+
+  uint32_t interrupts;
+  if (size == 1) {
+    // Erratum 58 workaround: busy wait, no interrupt
+    Sim::Clock::Advance(bus.timings.spiErratum58Setup);
+    interrupts = 0;
+  } else if (size > maxChunkSize && (size / ListChunkSize(size)) >= 2) {
+    auto chunkSize = ListChunkSize(size);
+    interrupts = (size % chunkSize == 0) ? 1 : 2;
+    statistics.listTransfers++;
+  } else {
+    interrupts = (size + maxChunkSize - 1) / maxChunkSize;
+  }
+
+  statistics.transactions++;
+  statistics.bytes += size;
+  statistics.interrupts += interrupts;
+  bus.SpiWrite(data, size, interrupts);
+  bus.SpiDeselect();
+  nrf_gpio_pin_set(pinCsn);
+
+  if (postTransactionHook != nullptr) {
+    postTransactionHook();
+  }
+  xSemaphoreGive(mutex);
+  return true;
+}
+
+bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  auto& bus = Sim::Bus::Instance();
+  this->pinCsn = pinCsn;
+
+  nrf_gpio_pin_clear(pinCsn);
+  bus.SpiSelect(pinCsn);
+  bus.SpiWrite(cmd, cmdSize, 0);
+  if (dataSize > 0) {
+    bus.SpiRead(data, dataSize);
+  }
+  bus.SpiDeselect();
+  nrf_gpio_pin_set(pinCsn);
+
+  statistics.transactions++;
+  statistics.bytes += cmdSize + dataSize;
+  xSemaphoreGive(mutex);
+  return true;
+}
+
+bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  auto& bus = Sim::Bus::Instance();
+  this->pinCsn = pinCsn;
+
+  nrf_gpio_pin_clear(pinCsn);
+  bus.SpiSelect(pinCsn);
+  bus.SpiWrite(cmd, cmdSize, 0);
+  bus.SpiWrite(data, dataSize, 0);
+  bus.SpiDeselect();
+  nrf_gpio_pin_set(pinCsn);
+
+  statistics.transactions++;
+  statistics.bytes += cmdSize + dataSize;
+  xSemaphoreGive(mutex);
+  return true;
+}
+
+void SpiMaster::OnStartedEvent() {
+}
+
+void SpiMaster::OnEndEvent() {
+}
+
+void SpiMaster::OnListEndEvent() {
+}
+
+void SpiMaster::Sleep() {
+}
+
+void SpiMaster::Wakeup() {
+}
@@ -0,0 +1,115 @@
+// Host implementation of drivers/TwiMaster.h on top of the simulated bus. Transactions complete synchronously
+// in Submit(), the queue and the interrupt are not used.
+#include "drivers/TwiMaster.h"
+#include <algorithm>
+#include <cstring>
+#include <nrf_assert.h>
+#include "SimBus.h"
+#include "components/profiling/ProfilingClock.h"
+
+using namespace Pinetime::Drivers;
+using Pinetime::Controllers::ProfilingClock;
+
+TwiMaster::TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl)
+  : module {module}, frequency {frequency}, pinSda {pinSda}, pinScl {pinScl} {
+}
+
+void TwiMaster::Init() {
+  twiBaseAddress = module;
+}
+
+bool TwiMaster::Submit(Transaction& transaction) {
+  ASSERT(transaction.txSize <= maxTransferSize && transaction.rxSize <= maxTransferSize);
+  transaction.result = ErrorCodes::NoError;
+  transaction.retries = 0;
+  transaction.submitTime = ProfilingClock::Ticks();
+  current = &transaction;
+
+  auto& bus = Sim::Bus::Instance();
+  bool ok = true;
+  if (transaction.txSize > 0) {
+    ok = bus.TwiWrite(transaction.deviceAddress, transaction.txData, transaction.txSize, transaction.rxSize == 0);
+  }
+  if (ok && transaction.rxSize > 0) {
+    ok = bus.TwiRead(transaction.deviceAddress, transaction.rxData, transaction.rxSize, true);
+  }
+  Complete(ok ? ErrorCodes::NoError : ErrorCodes::TransactionFailed);
+  return true;
+}
+
+TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* data, size_t size) {
+  Transaction transaction;
+  transaction.deviceAddress = deviceAddress;
+  transaction.txData = &registerAddress;
+  transaction.txSize = 1;
+  transaction.rxData = data;
+  transaction.rxSize = size;
+  return Transfer(transaction);
+}
+
+TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size) {
+  ASSERT(size <= maxDataSize);
+  uint8_t buffer[maxDataSize + registerSize];
+  buffer[0] = registerAddress;
+  std::memcpy(buffer + registerSize, data, size);
+
+  Transaction transaction;
+  transaction.deviceAddress = deviceAddress;
+  transaction.txData = buffer;
+  transaction.txSize = size + registerSize;
+  return Transfer(transaction);
+}
+
+TwiMaster::ErrorCodes TwiMaster::Transfer(Transaction& transaction) {
+  Submit(transaction);
+  return transaction.result;
+}
+
+void TwiMaster::Start(Transaction& /*transaction*/) {
+}
+
+void TwiMaster::OnInterrupt() {
+}
+
+void TwiMaster::Complete(ErrorCodes result) {
+  Transaction* transaction = current;
+  current = nullptr;
+
+  transaction->result = result;
+  auto& deviceStatistics = StatisticsOf(transaction->deviceAddress);
+  uint32_t latency = ProfilingClock::TicksBetween(transaction->submitTime, ProfilingClock::Ticks());
+  deviceStatistics.transactions++;
+  deviceStatistics.totalLatency += latency;
+  deviceStatistics.maxLatency = std::max(deviceStatistics.maxLatency, latency);
+  if (result == ErrorCodes::NoError) {
+    deviceStatistics.bytes += transaction->txSize + transaction->rxSize;
+  } else {
+    deviceStatistics.errors++;
+  }
+
+  if (transaction->onComplete) {
+    transaction->onComplete(result);
+  }
+}
+
+void TwiMaster::RecoverFromFreeze() {
+}
+
+TwiMaster::DeviceStatistics& TwiMaster::StatisticsOf(uint8_t deviceAddress) {
+  for (auto& deviceStatistics : statistics) {
+    if (deviceStatistics.deviceAddress == deviceAddress || deviceStatistics.deviceAddress == 0) {
+      deviceStatistics.deviceAddress = deviceAddress;
+      return deviceStatistics;
+    }
+  }
+  return statistics.back();
+}
+
+void TwiMaster::ConfigurePins() const {
+}
+
+void TwiMaster::Sleep() {
+}
+
+void TwiMaster::Wakeup() {
+}
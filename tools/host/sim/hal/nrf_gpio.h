@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include "SimGpio.h"
+
+enum nrf_gpio_pin_pull_t { NRF_GPIO_PIN_NOPULL, NRF_GPIO_PIN_PULLDOWN, NRF_GPIO_PIN_PULLUP };
+
+inline void nrf_gpio_cfg_output(uint32_t /*pin*/) {
+}
+
+inline void nrf_gpio_cfg_input(uint32_t /*pin*/, nrf_gpio_pin_pull_t /*pull*/) {
+}
+
+inline void nrf_gpio_cfg_default(uint32_t /*pin*/) {
+}
+
+inline void nrf_gpio_pin_set(uint32_t pin) {
+  Pinetime::Sim::Gpio::Set(pin, true);
+}
+
+inline void nrf_gpio_pin_clear(uint32_t pin) {
+  Pinetime::Sim::Gpio::Set(pin, false);
+}
+
+inline uint32_t nrf_gpio_pin_read(uint32_t pin) {
+  return Pinetime::Sim::Gpio::Get(pin) ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+#include "SimClock.h"
+
+inline void nrf_delay_us(uint32_t us) {
+  Pinetime::Sim::Clock::Advance(static_cast<uint64_t>(us) * 1000);
+}
+
+inline void nrf_delay_ms(uint32_t ms) {
+  Pinetime::Sim::Clock::Advance(static_cast<uint64_t>(ms) * 1000000);
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include <cassert>
+
+#define ASSERT(expr) assert(expr)
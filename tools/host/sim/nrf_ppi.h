@@ -0,0 +1,4 @@
+#pragma once
+
+enum nrf_ppi_channel_t { NRF_PPI_CHANNEL0, NRF_PPI_CHANNEL1, NRF_PPI_CHANNEL2, NRF_PPI_CHANNEL3 };
+enum nrf_ppi_channel_group_t { NRF_PPI_CHANNEL_GROUP0, NRF_PPI_CHANNEL_GROUP1 };
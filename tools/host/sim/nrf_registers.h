@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Peripheral register blocks are only referenced by pointer in the driver headers. The host
+// implementations of the bus drivers never touch them, the simulated bus is used instead.
+struct NRF_SPIM_Type {
+  uint32_t unused;
+};
+
+struct NRF_TWIM_Type {
+  uint32_t unused;
+};
+
+struct NRF_TIMER_Type {
+  uint32_t unused;
+};
+
+extern NRF_SPIM_Type simSpim0;
+extern NRF_TWIM_Type simTwim1;
+extern NRF_TIMER_Type simTimer3;
+
+#define NRF_SPIM0  (&simSpim0)
+#define NRF_TWIM1  (&simTwim1)
+#define NRF_TIMER3 (&simTimer3)
+
+#define TWIM_FREQUENCY_FREQUENCY_K100 (0x01980000UL)
+#define TWIM_FREQUENCY_FREQUENCY_K250 (0x04000000UL)
+#define TWIM_FREQUENCY_FREQUENCY_K400 (0x06400000UL)
@@ -0,0 +1,3 @@
+#pragma once
+#include "hal/nrf_gpio.h"
+#include "nrf_registers.h"
@@ -0,0 +1,2 @@
+#pragma once
+#include "libraries/log/nrf_log.h"
@@ -0,0 +1,41 @@
+#pragma once
+#include "FreeRTOS.h"
+
+struct SimSemaphore {
+  UBaseType_t count = 0;
+};
+
+using SemaphoreHandle_t = SimSemaphore*;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return new SimSemaphore {};
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new SimSemaphore {1};
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t /*ticksToWait*/) {
+  // Nothing else can give the semaphore in a single threaded simulation, so a take on an empty
+  // semaphore means a transaction was left open: fail instead of blocking forever.
+  if (semaphore->count == 0) {
+    return pdFALSE;
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore->count > 0) {
+    return pdFALSE;
+  }
+  semaphore->count++;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreGive(semaphore);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "FreeRTOS.h"
+
+inline void vTaskDelay(TickType_t ticks) {
+  Pinetime::Sim::Clock::Advance(static_cast<uint64_t>(ticks) * Pinetime::Sim::Clock::nsPerTick);
+}
+
+inline TickType_t xTaskGetTickCount() {
+  return static_cast<TickType_t>(Pinetime::Sim::Clock::Now() / Pinetime::Sim::Clock::nsPerTick);
+}
@@ -0,0 +1,115 @@
+// Checks the Q15 FFT of the fixed point heart rate engine (FixedPointFft) against a DFT computed in double precision, on
+// the kind of signals Ppg gives it: sines on and between the bins, DC, several tones, Hann windowed noise and full scale
+// inputs. The magnitudes must match the reference within the rounding error of the 5 scaled butterfly stages.
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "components/heartrate/FixedPointFft.h"
+
+using Pinetime::Controllers::FixedPointFft;
+
+namespace {
+  constexpr double pi = 3.14159265358979323846;
+  // Largest error allowed on a magnitude (a sine of amplitude 0.5 on a bin has a magnitude of 0.5)
+  constexpr double tolerance = 5e-4;
+
+  int failures = 0;
+  double worstError = 0.0;
+
+  // Magnitudes of the DFT of the samples, divided by outputScale as the ones of FixedPointFft
+  std::array<double, FixedPointFft::spectrumLength> ReferenceMagnitudes(const std::vector<double>& signal) {
+    std::array<double, FixedPointFft::spectrumLength> magnitudes;
+    for (size_t k = 0; k < FixedPointFft::spectrumLength; k++) {
+      double real = 0.0;
+      double imag = 0.0;
+      for (size_t n = 0; n < FixedPointFft::length; n++) {
+        double angle = 2.0 * pi * static_cast<double>(k * n) / FixedPointFft::length;
+        real += signal[n] * std::cos(angle);
+        imag -= signal[n] * std::sin(angle);
+      }
+      magnitudes[k] = std::sqrt(real * real + imag * imag) / FixedPointFft::outputScale;
+    }
+    return magnitudes;
+  }
+
+  // signal must be in [-0.5, 0.5[
+  void Check(const char* name, const std::vector<double>& signal) {
+    std::array<int16_t, FixedPointFft::length> samples;
+    std::vector<double> quantized(FixedPointFft::length);
+    for (size_t n = 0; n < FixedPointFft::length; n++) {
+      samples[n] = static_cast<int16_t>(std::lround(signal[n] * 32768.0));
+      quantized[n] = samples[n] / 32768.0;
+    }
+    auto expected = ReferenceMagnitudes(quantized);
+    std::array<float, FixedPointFft::spectrumLength> magnitudes;
+    FixedPointFft::Magnitudes(samples, magnitudes.data());
+
+    for (size_t k = 0; k < FixedPointFft::spectrumLength; k++) {
+      double error = std::abs(magnitudes[k] - expected[k]);
+      worstError = std::max(worstError, error);
+      if (error > tolerance) {
+        std::printf("FAIL %s: bin %zu is %f, expected %f\n", name, k, magnitudes[k], expected[k]);
+        failures++;
+        return;
+      }
+    }
+  }
+
+  std::vector<double> Sine(double bin, double amplitude, double phase) {
+    std::vector<double> signal(FixedPointFft::length);
+    for (size_t n = 0; n < FixedPointFft::length; n++) {
+      signal[n] = amplitude * std::sin(2.0 * pi * bin * static_cast<double>(n) / FixedPointFft::length + phase);
+    }
+    return signal;
+  }
+}
+
+int main() {
+  for (int bin = 0; bin < static_cast<int>(FixedPointFft::spectrumLength); bin++) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "sine on bin %d", bin);
+    Check(name, Sine(bin, 0.49, 0.3));
+  }
+  // Heart rates between the bins (0.156 Hz at 10 Hz), with a small amplitude as after the filters of Ppg
+  for (double bin = 3.0; bin < 26.0; bin += 0.37) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "sine on bin %.2f", bin);
+    Check(name, Sine(bin, 0.01, 1.1));
+  }
+
+  Check("DC", std::vector<double>(FixedPointFft::length, 0.45));
+  Check("full scale negative DC", std::vector<double>(FixedPointFft::length, -0.5));
+  Check("zero", std::vector<double>(FixedPointFft::length, 0.0));
+
+  std::vector<double> alternating(FixedPointFft::length);
+  for (size_t n = 0; n < FixedPointFft::length; n++) {
+    alternating[n] = (n % 2 == 0) ? 0.49 : -0.5;
+  }
+  Check("alternating full scale", alternating);
+
+  // Pulse and respiration, as in the synthetic recordings of ppg-replay
+  auto pulse = Sine(8.5, 0.3, 0.0);
+  auto respiration = Sine(1.7, 0.15, 0.7);
+  for (size_t n = 0; n < FixedPointFft::length; n++) {
+    pulse[n] += respiration[n];
+  }
+  Check("pulse and respiration", pulse);
+
+  std::mt19937 random {42};
+  std::uniform_real_distribution<double> noise {-0.5, 0.5};
+  for (int i = 0; i < 20; i++) {
+    std::vector<double> signal(FixedPointFft::length);
+    for (size_t n = 0; n < FixedPointFft::length; n++) {
+      double hann = 0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(n) / (FixedPointFft::length - 1));
+      signal[n] = noise(random) * hann;
+    }
+    Check("Hann windowed noise", signal);
+  }
+
+  if (failures == 0) {
+    std::printf("All FixedPointFft tests passed (largest error %g)\n", worstError);
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// Runs the real SpiMaster driver against the register model (regmodel/): EasyDMA transfers, the list mode PPI/TIMER3
+// chain and the interrupt handlers of main.cpp. Every transaction must complete: all the bytes are sent with CS
+// asserted, the post transaction hook runs once, CS is released and the bus can be taken again.
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "drivers/PinMap.h"
+#include "drivers/SpiMaster.h"
+#include "RegisterModel.h"
+
+using namespace Pinetime;
+using namespace Pinetime::Sim::Registers;
+
+namespace {
+  Drivers::SpiMaster spi {Drivers::SpiMaster::SpiModule::SPI0,
+                          {Drivers::SpiMaster::BitOrder::Msb_Lsb,
+                           Drivers::SpiMaster::Modes::Mode3,
+                           Drivers::SpiMaster::Frequencies::Freq8Mhz,
+                           PinMap::SpiSck,
+                           PinMap::SpiMosi,
+                           PinMap::SpiMiso}};
+  constexpr uint8_t pinCsn = PinMap::SpiLcdCsn;
+
+  std::vector<uint8_t> sent;
+  int failures = 0;
+
+  // Same handlers as main.cpp
+  void SpimHandler() {
+    if (((NRF_SPIM0->INTENSET & (1 << 6)) != 0) && NRF_SPIM0->EVENTS_END == 1) {
+      NRF_SPIM0->EVENTS_END = 0;
+      spi.OnEndEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 19)) != 0) && NRF_SPIM0->EVENTS_STARTED == 1) {
+      NRF_SPIM0->EVENTS_STARTED = 0;
+      spi.OnStartedEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 1)) != 0) && NRF_SPIM0->EVENTS_STOPPED == 1) {
+      NRF_SPIM0->EVENTS_STOPPED = 0;
+    }
+  }
+
+  void Timer3Handler() {
+    if (NRF_TIMER3->EVENTS_COMPARE[1] == 1) {
+      NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+      spi.OnListEndEvent();
+    }
+  }
+
+  void Check(bool condition, const char* test, size_t size, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s (%zu bytes): %s\n", test, size, what);
+      failures++;
+    }
+  }
+
+  std::vector<uint8_t> Pattern(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = static_cast<uint8_t>(i * 7 + size);
+    }
+    return data;
+  }
+
+  void TestWrite(size_t size, bool listTransfer) {
+    auto data = Pattern(size);
+    Memory::Map(data.data(), data.size());
+    sent.clear();
+    spi.ResetStatistics();
+    int hookCalls = 0;
+
+    bool ok = spi.Write(pinCsn, data.data(), data.size(), nullptr, [&hookCalls]() {
+      hookCalls++;
+    });
+    Hardware::RunUntilIdle();
+
+    Check(ok, "Write", size, "Write() failed");
+    if (hookCalls != 1) {
+      // The bus mutex is still taken: the next transactions would block forever on the target
+      std::printf("FAIL Write (%zu bytes): the transaction did not complete\n", size);
+      std::exit(1);
+    }
+    Check(sent == data, "Write", size, "the bytes sent differ from the buffer");
+    Check(Sim::Gpio::Get(pinCsn), "Write", size, "CS was not released");
+    Check((spi.Statistics().listTransfers == 1) == listTransfer, "Write", size, "unexpected transfer mode");
+    Check(NRF_SPIM0->errors == 0, "Write", size, "invalid EasyDMA transfer");
+
+    // The mutex must have been released: a second transaction on the bus must go through
+    std::vector<uint8_t> cmd {0x2c, 0x00};
+    Memory::Map(cmd.data(), cmd.size());
+    sent.clear();
+    hookCalls = 0;
+    spi.Write(pinCsn, cmd.data(), cmd.size(), nullptr, [&hookCalls]() {
+      hookCalls++;
+    });
+    Hardware::RunUntilIdle();
+    Check(hookCalls == 1 && sent == cmd, "Write", size, "the bus is not available after the transaction");
+
+    Memory::Unmap(cmd.data());
+    Memory::Unmap(data.data());
+  }
+
+  void TestRead() {
+    std::vector<uint8_t> cmd {0x9f};
+    std::vector<uint8_t> data(3);
+    Memory::Map(cmd.data(), cmd.size());
+    Memory::Map(data.data(), data.size());
+    sent.clear();
+
+    spi.Read(pinCsn, cmd.data(), cmd.size(), data.data(), data.size());
+    Hardware::RunUntilIdle();
+
+    Check(sent == cmd, "Read", data.size(), "the command was not sent");
+    Check(data == std::vector<uint8_t> {0xa5, 0xa5, 0xa5}, "Read", data.size(), "the bytes received were not stored");
+    Check(Sim::Gpio::Get(pinCsn), "Read", data.size(), "CS was not released");
+    Memory::Unmap(data.data());
+    Memory::Unmap(cmd.data());
+  }
+
+  void TestWriteCmdAndBuffer() {
+    std::vector<uint8_t> cmd {0x02, 0x00, 0x10, 0x00};
+    auto data = Pattern(200);
+    Memory::Map(cmd.data(), cmd.size());
+    Memory::Map(data.data(), data.size());
+    sent.clear();
+
+    spi.WriteCmdAndBuffer(pinCsn, cmd.data(), cmd.size(), data.data(), data.size());
+    Hardware::RunUntilIdle();
+
+    auto expected = cmd;
+    expected.insert(expected.end(), data.begin(), data.end());
+    Check(sent == expected, "WriteCmdAndBuffer", data.size(), "the bytes sent differ from the buffers");
+    Check(Sim::Gpio::Get(pinCsn), "WriteCmdAndBuffer", data.size(), "CS was not released");
+    Memory::Unmap(data.data());
+    Memory::Unmap(cmd.data());
+  }
+}
+
+int main() {
+  Hardware::SetHandler(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, SpimHandler);
+  Hardware::SetHandler(TIMER3_IRQn, Timer3Handler);
+  NRF_SPIM0->device = [](const uint8_t* tx, size_t txSize, uint8_t* rx, size_t rxSize) {
+    if (Sim::Gpio::Get(pinCsn)) {
+      std::printf("FAIL transfer of %zu bytes with CS released\n", txSize + rxSize);
+      failures++;
+    }
+    sent.insert(sent.end(), tx, tx + txSize);
+    for (size_t i = 0; i < rxSize; i++) {
+      rx[i] = 0xa5;
+    }
+  };
+
+  Sim::Gpio::Set(pinCsn, true);
+  spi.Init();
+
+  // Regular transfers, one interrupt per chunk of at most 255 bytes
+  TestWrite(1, false);
+  TestWrite(2, false);
+  TestWrite(255, false);
+  // 257 has no divisor in [128, 255] and is less than 2 chunks of 255 bytes: it's sent chunk by chunk
+  TestWrite(257, false);
+  // List transfers: display lines and stripes (480 = 2 x 240, 7680 = 32 x 240), exact multiples of 255, and a size
+  // that needs a remainder after the list (511 = 2 x 255 + 1)
+  TestWrite(256, true);
+  TestWrite(480, true);
+  TestWrite(510, true);
+  TestWrite(511, true);
+  TestWrite(960, true);
+  TestWrite(7680, true);
+  TestWrite(1000, true);
+
+  TestRead();
+  TestWriteCmdAndBuffer();
+
+  if (failures == 0) {
+    std::printf("All SpiMaster tests passed\n");
+  }
+  return failures == 0 ? 0 : 1;
+}